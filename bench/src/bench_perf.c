@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#define _GNU_SOURCE
+
+#include "bench_perf.h"
+
+#include <errno.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define KEY(w, lit) ajson_writer_key((w), (lit), sizeof(lit) - 1)
+
+#ifdef __linux__
+
+#define CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} counter_defs[BENCH_PERF_COUNT] = {
+    [BENCH_PERF_CYCLES]        = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    [BENCH_PERF_INSTRUCTIONS]  = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    [BENCH_PERF_BRANCHES]      = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS },
+    [BENCH_PERF_BRANCH_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    [BENCH_PERF_L1D_MISSES]    = { PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D) },
+    [BENCH_PERF_LLC_MISSES]    = { PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL) },
+};
+
+int bench_perf_open(bench_perf_t *perf) {
+    int opened = 0;
+    perf->open_errno = 0;
+    for (int i = 0; i < BENCH_PERF_COUNT; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = counter_defs[i].type;
+        attr.config = counter_defs[i].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        perf->fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (perf->fd[i] < 0) {
+            if (!perf->open_errno) perf->open_errno = errno;
+            perf->fd[i] = -1;
+        } else {
+            opened++;
+        }
+    }
+    return opened;
+}
+
+void bench_perf_close(bench_perf_t *perf) {
+    for (int i = 0; i < BENCH_PERF_COUNT; i++) {
+        if (perf->fd[i] >= 0) close(perf->fd[i]);
+        perf->fd[i] = -1;
+    }
+}
+
+void bench_perf_start(bench_perf_t *perf) {
+    for (int i = 0; i < BENCH_PERF_COUNT; i++) {
+        if (perf->fd[i] < 0) continue;
+        ioctl(perf->fd[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(perf->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void bench_perf_stop(bench_perf_t *perf, bench_perf_counts_t *out) {
+    for (int i = 0; i < BENCH_PERF_COUNT; i++)
+        if (perf->fd[i] >= 0) ioctl(perf->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+
+    for (int i = 0; i < BENCH_PERF_COUNT; i++) {
+        uint64_t v[3]; /* value, time enabled, time running */
+        out->valid[i] = false;
+        out->value[i] = 0;
+        if (perf->fd[i] < 0 || read(perf->fd[i], v, sizeof(v)) != (ssize_t)sizeof(v)) continue;
+        if (!v[2]) continue; /* Never scheduled on the PMU */
+        out->valid[i] = true;
+        out->value[i] = (double)v[0] * ((double)v[1] / (double)v[2]);
+    }
+}
+
+const char *bench_perf_status(const bench_perf_t *perf) {
+    return perf->open_errno ? strerror(perf->open_errno) : "ok";
+}
+
+#else /* !__linux__ */
+
+int bench_perf_open(bench_perf_t *perf) {
+    for (int i = 0; i < BENCH_PERF_COUNT; i++) perf->fd[i] = -1;
+    perf->open_errno = ENOSYS;
+    return 0;
+}
+
+void bench_perf_close(bench_perf_t *perf) { (void)perf; }
+void bench_perf_start(bench_perf_t *perf) { (void)perf; }
+
+void bench_perf_stop(bench_perf_t *perf, bench_perf_counts_t *out) {
+    (void)perf;
+    memset(out, 0, sizeof(*out));
+}
+
+const char *bench_perf_status(const bench_perf_t *perf) {
+    (void)perf;
+    return "perf_event_open is Linux only";
+}
+
+#endif
+
+/* value[num] / value[den] * scale, or null if either is missing */
+static void write_ratio(ajson_writer_t *w, const bench_perf_counts_t *c,
+                        int num, int den, double scale) {
+    if (!c->valid[num] || !c->valid[den] || c->value[den] == 0) ajson_writer_null(w);
+    else ajson_writer_double(w, c->value[num] / c->value[den] * scale);
+}
+
+static void write_per_byte(ajson_writer_t *w, const bench_perf_counts_t *c,
+                           int num, size_t bytes, double scale) {
+    if (!c->valid[num] || !bytes) ajson_writer_null(w);
+    else ajson_writer_double(w, c->value[num] / (double)bytes * scale);
+}
+
+void bench_perf_write(ajson_writer_t *w, const char *key,
+                      const bench_perf_counts_t *c, size_t bytes) {
+    ajson_writer_key(w, key, strlen(key));
+    ajson_writer_start_object(w);
+    KEY(w, "cycles_per_byte");
+    write_per_byte(w, c, BENCH_PERF_CYCLES, bytes, 1);
+    KEY(w, "instructions_per_byte");
+    write_per_byte(w, c, BENCH_PERF_INSTRUCTIONS, bytes, 1);
+    KEY(w, "ipc");
+    write_ratio(w, c, BENCH_PERF_INSTRUCTIONS, BENCH_PERF_CYCLES, 1);
+    KEY(w, "branch_miss_rate");
+    write_ratio(w, c, BENCH_PERF_BRANCH_MISSES, BENCH_PERF_BRANCHES, 1);
+    KEY(w, "l1d_misses_per_kib");
+    write_per_byte(w, c, BENCH_PERF_L1D_MISSES, bytes, 1024);
+    KEY(w, "llc_misses_per_kib");
+    write_per_byte(w, c, BENCH_PERF_LLC_MISSES, bytes, 1024);
+    ajson_writer_end_object(w);
+}
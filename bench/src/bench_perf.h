@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _AJSON_BENCH_PERF_H
+#define _AJSON_BENCH_PERF_H
+
+#include "a-json-sax-library/ajson_writer.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Hardware counters read around a measured region (Linux perf_event_open).
+ * Each counter is opened on its own, so a host that lacks one of them
+ * (VMs, containers, perf_event_paranoid) still reports the rest, and a
+ * host with none reports them all as unavailable. */
+
+typedef enum {
+    BENCH_PERF_CYCLES,
+    BENCH_PERF_INSTRUCTIONS,
+    BENCH_PERF_BRANCHES,
+    BENCH_PERF_BRANCH_MISSES,
+    BENCH_PERF_L1D_MISSES,
+    BENCH_PERF_LLC_MISSES,
+    BENCH_PERF_COUNT
+} bench_perf_counter_t;
+
+typedef struct {
+    int fd[BENCH_PERF_COUNT];           /* -1 if unavailable */
+    int open_errno;                     /* errno of the first failed open */
+} bench_perf_t;
+
+typedef struct {
+    bool valid[BENCH_PERF_COUNT];
+    double value[BENCH_PERF_COUNT];     /* Scaled for multiplexing */
+} bench_perf_counts_t;
+
+/** Open the counters for the calling thread.  Returns the number opened. */
+int bench_perf_open(bench_perf_t *perf);
+
+void bench_perf_close(bench_perf_t *perf);
+
+/** Reset and enable every open counter. */
+void bench_perf_start(bench_perf_t *perf);
+
+/** Disable the counters and read them into 'out'. */
+void bench_perf_stop(bench_perf_t *perf, bench_perf_counts_t *out);
+
+/** Write the counters normalized by 'bytes' as the value of 'key':
+ * cycles/instructions per byte, branch-miss rate and cache misses per KiB.
+ * Unavailable figures are written as null. */
+void bench_perf_write(ajson_writer_t *w, const char *key,
+                      const bench_perf_counts_t *c, size_t bytes);
+
+/** Describe why counters are missing (or "ok"). */
+const char *bench_perf_status(const bench_perf_t *perf);
+
+#endif /* _AJSON_BENCH_PERF_H */
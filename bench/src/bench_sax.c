@@ -0,0 +1,303 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+/* Parser throughput over synthetic corpora.
+ *
+ *   bench_sax [--corpus NAME] [--size MiB] [--iters N] [--out FILE] [--perf]
+ *
+ * Each sample parses every document of a corpus once.  The buffer is
+ * refreshed from a pristine copy before each sample (untimed) so the
+ * destructive parser sees the same input as the regular one.  Results are
+ * written as JSON (stdout by default); a short table goes to stderr.
+ *
+ * --perf adds one more pass per case with hardware counters enabled and
+ * reports cycles/instructions per byte, branch-miss rate and cache misses.
+ */
+
+#include "bench_perf.h"
+#include "bench_util.h"
+#include "a-json-sax-library/ajson_sax.h"
+#include "a-json-sax-library/ajson_sax_impl.h"
+#include "a-json-sax-library/ajson_string_utils.h"
+#include "a-json-sax-library/ajson_validate.h"
+#include "a-memory-library/aml_alloc.h"
+#include "a-memory-library/aml_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define KEY(w, lit) ajson_writer_key((w), (lit), sizeof(lit) - 1)
+
+/* ---------- Handlers ---------- */
+
+/* What a typical consumer does: hash keys and strings (decoding the ones
+   with escapes), convert numbers and count structure. */
+typedef struct {
+    aml_pool_t *pool;
+    uint64_t hash;
+    uint64_t events;
+    double sum;
+} real_ctx_t;
+
+static inline uint64_t fnv1a(uint64_t h, const char *s, size_t len) {
+    for (size_t i = 0; i < len; i++) h = (h ^ (unsigned char)s[i]) * 0x100000001B3ull;
+    return h;
+}
+
+static int real_key(void *ctx, ajson_sax_t *sax, const char *key, size_t len) {
+    (void)sax;
+    real_ctx_t *c = (real_ctx_t *)ctx;
+    c->hash = fnv1a(c->hash, key, len);
+    c->events++;
+    return 0;
+}
+
+static int real_string(void *ctx, ajson_sax_t *sax, const char *val, size_t len) {
+    real_ctx_t *c = (real_ctx_t *)ctx;
+    if (sax->has_escapes) val = ajson_decode2(&len, c->pool, (char *)val, len);
+    c->hash = fnv1a(c->hash, val, len);
+    c->events++;
+    return 0;
+}
+
+static int real_number(void *ctx, ajson_sax_t *sax, const char *val, size_t len) {
+    (void)sax; (void)len;
+    real_ctx_t *c = (real_ctx_t *)ctx;
+    c->sum += strtod(val, NULL);
+    c->events++;
+    return 0;
+}
+
+static int real_bool(void *ctx, ajson_sax_t *sax, bool v) {
+    (void)sax;
+    ((real_ctx_t *)ctx)->events += 1 + v;
+    return 0;
+}
+
+static int real_event(void *ctx, ajson_sax_t *sax) {
+    (void)sax;
+    ((real_ctx_t *)ctx)->events++;
+    return 0;
+}
+
+static const ajson_sax_cb_t noop_handlers = {0};
+
+static const ajson_sax_cb_t real_handlers = {
+    .on_null = real_event, .on_bool = real_bool,
+    .on_number = real_number, .on_string = real_string, .on_key = real_key,
+    .on_start_object = real_event, .on_end_object = real_event,
+    .on_start_array = real_event, .on_end_array = real_event
+};
+
+/* ---------- Measurement ---------- */
+
+typedef int (*parse_fn)(char *p, char *ep, const ajson_sax_cb_t *cb,
+                        aml_pool_t *pool, void *ctx, char **error_at);
+
+/* The same handler sets compiled into the parser (ajson_sax_impl.h) */
+AJSON_SAX_DEFINE_PARSER(parse_noop_specialized, noop_handlers)
+AJSON_SAX_DEFINE_PARSER(parse_real_specialized, real_handlers)
+
+static int parse_specialized(char *p, char *ep, const ajson_sax_cb_t *cb,
+                             aml_pool_t *pool, void *ctx, char **error_at) {
+    if (cb == &noop_handlers) return parse_noop_specialized(p, ep, pool, ctx, error_at);
+    return parse_real_specialized(p, ep, pool, ctx, error_at);
+}
+
+/* ajson_validate has no handlers, so it only runs with the no-op set */
+static int parse_validate(char *p, char *ep, const ajson_sax_cb_t *cb,
+                          aml_pool_t *pool, void *ctx, char **error_at) {
+    (void)cb; (void)pool; (void)ctx;
+    size_t off;
+    if (ajson_validate(p, (size_t)(ep - p), &off)) return 0;
+    *error_at = p + off;
+    return -1;
+}
+
+/* ajson_minify into the pool, and over the input */
+static int parse_minify(char *p, char *ep, const ajson_sax_cb_t *cb,
+                        aml_pool_t *pool, void *ctx, char **error_at) {
+    (void)cb; (void)ctx;
+    size_t len = (size_t)(ep - p), off, n;
+    char *dst = (char *)aml_pool_ualloc(pool, len);
+    if (ajson_minify(dst, p, len, &n, &off)) return 0;
+    *error_at = p + off;
+    return -1;
+}
+
+static int parse_minify_in_place(char *p, char *ep, const ajson_sax_cb_t *cb,
+                                 aml_pool_t *pool, void *ctx, char **error_at) {
+    (void)cb; (void)pool; (void)ctx;
+    size_t off, n;
+    if (ajson_minify_in_place(p, (size_t)(ep - p), &n, &off)) return 0;
+    *error_at = p + off;
+    return -1;
+}
+
+static const struct {
+    const char *name;
+    parse_fn parse;
+    bool noop_only;     /* No handlers are called */
+} modes[] = {
+    { "parse",           ajson_sax_parse,             false },
+    { "destructive",     ajson_sax_parse_destructive, false },
+    { "specialized",     parse_specialized,           false },
+    { "validate",        parse_validate,              true },
+    { "minify",          parse_minify,                true },
+    { "minify_in_place", parse_minify_in_place,       true },
+};
+
+static const struct {
+    const char *name;
+    const ajson_sax_cb_t *cb;
+} handler_sets[] = {
+    { "noop",      &noop_handlers },
+    { "realistic", &real_handlers },
+};
+
+/* Parse every document once; returns elapsed seconds.  If 'perf' is set
+   the pass is also measured with hardware counters. */
+static double run_pass(const bench_corpus_t *c, char *work, parse_fn parse,
+                       const ajson_sax_cb_t *cb, real_ctx_t *ctx,
+                       bench_perf_t *perf, bench_perf_counts_t *counts) {
+    memcpy(work, c->data, c->len + 1);
+    if (perf) bench_perf_start(perf);
+    uint64_t t0 = bench_now_ns();
+    for (size_t d = 0; d < c->ndocs; d++) {
+        char *p = work + c->offsets[d];
+        char *err = NULL;
+        if (parse(p, p + c->lengths[d], cb, ctx->pool, ctx, &err)) {
+            fprintf(stderr, "bench_sax: %s document %zu failed at offset %zu\n",
+                    c->name, d, (size_t)(err ? err - p : 0));
+            exit(1);
+        }
+        aml_pool_clear(ctx->pool);
+    }
+    uint64_t t1 = bench_now_ns();
+    if (perf) bench_perf_stop(perf, counts);
+    bench_consume(ctx->hash ^ ctx->events ^ (uint64_t)ctx->sum);
+    return (double)(t1 - t0) / 1e9;
+}
+
+static void bench_corpus(ajson_writer_t *w, const bench_corpus_t *c, int iters,
+                         bench_perf_t *perf) {
+    char *work = (char *)aml_malloc(c->len + 1);
+    double *secs = (double *)aml_malloc(sizeof(double) * (size_t)iters);
+    real_ctx_t ctx = { aml_pool_init(1 << 16), 0, 0, 0 };
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        for (size_t h = 0; h < sizeof(handler_sets) / sizeof(handler_sets[0]); h++) {
+            parse_fn parse = modes[m].parse;
+            const ajson_sax_cb_t *cb = handler_sets[h].cb;
+            if (modes[m].noop_only && cb != &noop_handlers) continue;
+            run_pass(c, work, parse, cb, &ctx, NULL, NULL); /* warm up */
+            for (int i = 0; i < iters; i++)
+                secs[i] = run_pass(c, work, parse, cb, &ctx, NULL, NULL);
+
+            bench_perf_counts_t counts;
+            if (perf) run_pass(c, work, parse, cb, &ctx, perf, &counts);
+
+            bench_summary_t s;
+            bench_summarize(&s, secs, (size_t)iters);
+            double gbps = (double)c->len / s.p50 / 1e9;
+            double docs = (double)c->ndocs / s.p50;
+
+            ajson_writer_start_object(w);
+            KEY(w, "corpus");     ajson_writer_string(w, c->name, strlen(c->name));
+            KEY(w, "mode");       ajson_writer_string(w, modes[m].name, strlen(modes[m].name));
+            KEY(w, "handlers");
+            ajson_writer_string(w, handler_sets[h].name, strlen(handler_sets[h].name));
+            KEY(w, "bytes");      ajson_writer_uint(w, c->len);
+            KEY(w, "docs");       ajson_writer_uint(w, c->ndocs);
+            KEY(w, "gb_per_s");   ajson_writer_double(w, gbps);
+            KEY(w, "docs_per_s"); ajson_writer_double(w, docs);
+            KEY(w, "gb_per_s_p90");
+            ajson_writer_double(w, (double)c->len / s.p90 / 1e9);
+            bench_write_summary(w, "seconds", &s);
+            if (perf) bench_perf_write(w, "counters", &counts, c->len);
+            ajson_writer_end_object(w);
+
+            fprintf(stderr, "%-8s %-11s %-9s %8.3f GB/s %14.0f docs/s",
+                    c->name, modes[m].name, handler_sets[h].name, gbps, docs);
+            if (perf && counts.valid[BENCH_PERF_CYCLES])
+                fprintf(stderr, " %7.2f cycles/B", counts.value[BENCH_PERF_CYCLES] / (double)c->len);
+            fputc('\n', stderr);
+        }
+    }
+
+    aml_pool_destroy(ctx.pool);
+    aml_free(secs);
+    aml_free(work);
+}
+
+int main(int argc, char **argv) {
+    const char *only = NULL;
+    const char *out_path = NULL;
+    size_t size_mb = 16;
+    int iters = 15;
+    bool use_perf = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *v;
+        if ((v = bench_arg(argc, argv, &i, "--corpus"))) only = v;
+        else if ((v = bench_arg(argc, argv, &i, "--size"))) size_mb = strtoul(v, NULL, 10);
+        else if ((v = bench_arg(argc, argv, &i, "--iters"))) iters = atoi(v);
+        else if ((v = bench_arg(argc, argv, &i, "--out"))) out_path = v;
+        else if (!strcmp(argv[i], "--perf")) use_perf = true;
+        else {
+            fprintf(stderr, "usage: %s [--corpus NAME] [--size MiB] [--iters N] [--out FILE]"
+                            " [--perf]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (iters < 1) iters = 1;
+    if (size_mb < 1) size_mb = 1;
+
+    FILE *out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) {
+        perror(out_path);
+        return 1;
+    }
+
+    bench_perf_t perf;
+    if (use_perf && !bench_perf_open(&perf))
+        fprintf(stderr, "bench_sax: hardware counters unavailable (%s)\n", bench_perf_status(&perf));
+
+    ajson_writer_t *w = ajson_writer_init_cb(bench_file_flush, out, 0);
+    ajson_writer_start_object(w);
+    bench_write_header(w, "bench_sax");
+    if (use_perf) {
+        const char *status = bench_perf_status(&perf);
+        KEY(w, "perf_status"); ajson_writer_string(w, status, strlen(status));
+    }
+    KEY(w, "config");
+    ajson_writer_start_object(w);
+    KEY(w, "corpus_bytes"); ajson_writer_uint(w, size_mb << 20);
+    KEY(w, "iterations");   ajson_writer_int(w, iters);
+    ajson_writer_end_object(w);
+    KEY(w, "results");
+    ajson_writer_start_array(w);
+
+    bool found = false;
+    for (size_t k = 0; bench_corpus_names[k]; k++) {
+        if (only && strcmp(only, bench_corpus_names[k])) continue;
+        found = true;
+        bench_corpus_t c;
+        bench_corpus_make(&c, bench_corpus_names[k], size_mb << 20);
+        bench_corpus(w, &c, iters, use_perf ? &perf : NULL);
+        bench_corpus_free(&c);
+    }
+
+    ajson_writer_end_array(w);
+    ajson_writer_end_object(w);
+    int rc = ajson_writer_destroy(w);
+    fputc('\n', out);
+    if (out != stdout) fclose(out);
+    if (use_perf) bench_perf_close(&perf);
+
+    if (!found) {
+        fprintf(stderr, "bench_sax: unknown corpus '%s'\n", only);
+        return 2;
+    }
+    return rc ? 1 : 0;
+}
@@ -0,0 +1,262 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+/* Cost of the string utilities by input length and content profile.
+ *
+ *   bench_string_utils [--routine NAME] [--max-len BYTES] [--iters N] [--out FILE]
+ *
+ * Lengths sweep 8 B .. 16 MiB (x8 per step).  Each profile fixes the share
+ * of bytes that need escaping and of non-ASCII characters.  A sample
+ * repeats a call until ~4 MiB of input has been processed; ns/byte is
+ * reported per input byte along with pool bytes used by a single call.
+ * 'memcpy' is included as a baseline (decode_inplace includes restoring
+ * its input with a memcpy on every call).
+ */
+
+#include "bench_util.h"
+#include "a-json-sax-library/ajson_string_utils.h"
+#include "a-memory-library/aml_alloc.h"
+#include "a-memory-library/aml_buffer.h"
+#include "a-memory-library/aml_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define KEY(w, lit) ajson_writer_key((w), (lit), sizeof(lit) - 1)
+
+#define SAMPLE_BYTES (4u << 20)
+#define MAX_LENGTH   (16u << 20)
+
+/* ---------- Inputs ---------- */
+
+typedef struct {
+    const char *name;
+    int escape_permille;   /* bytes that ajson_encode must escape */
+    int unicode_permille;  /* multi-byte UTF-8 characters */
+} profile_t;
+
+static const profile_t profiles[] = {
+    { "ascii",      0,   0 },
+    { "escape_1",  10,   0 },
+    { "escape_10", 100,  0 },
+    { "utf8_10",    0, 100 },
+    { "mixed",     50, 100 },
+};
+
+typedef struct {
+    char *raw;        /* Decoded text */
+    size_t raw_len;
+    char *json;       /* Its JSON-escaped form */
+    size_t json_len;
+    char *work;       /* Scratch, large enough for either */
+    aml_buffer_t *bh;
+} input_t;
+
+static void make_text(char *out, size_t len, const profile_t *pr, uint64_t *rng) {
+    static const char escapes[] = { '"', '\\', '\n', '\t', 0x01 };
+    static const char *const seqs[] = { "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80" };
+    size_t i = 0;
+    while (i < len) {
+        int r = (int)(bench_rand(rng) % 1000);
+        if (r < pr->escape_permille) {
+            out[i++] = escapes[bench_rand(rng) % sizeof(escapes)];
+        } else if (r < pr->escape_permille + pr->unicode_permille) {
+            const char *s = seqs[bench_rand(rng) % 3];
+            size_t n = strlen(s);
+            if (n > len - i) n = 0;
+            memcpy(out + i, s, n);
+            i += n;
+            if (!n) out[i++] = 'x';
+        } else {
+            out[i++] = (r & 7) ? (char)('a' + r % 26) : ' ';
+        }
+    }
+}
+
+static void input_init(input_t *in, size_t len, const profile_t *pr, aml_pool_t *pool) {
+    uint64_t rng = 0x2545F4914F6CDD1Dull ^ len;
+    in->raw = (char *)aml_malloc(len + 1);
+    in->raw_len = len;
+    make_text(in->raw, len, pr, &rng);
+    in->raw[len] = 0;
+
+    char *enc = ajson_encode(pool, in->raw, len);
+    in->json_len = strlen(enc);
+    in->json = (char *)aml_malloc(in->json_len + 1);
+    memcpy(in->json, enc, in->json_len + 1);
+    aml_pool_clear(pool);
+
+    in->work = (char *)aml_malloc(in->json_len + in->raw_len + 1);
+    in->bh = aml_buffer_init(in->json_len + 16);
+}
+
+static void input_free(input_t *in) {
+    aml_free(in->raw);
+    aml_free(in->json);
+    aml_free(in->work);
+    aml_buffer_destroy(in->bh);
+}
+
+/* ---------- Routines ---------- */
+
+typedef uint64_t (*routine_fn)(input_t *in, aml_pool_t *pool);
+
+static uint64_t run_encode(input_t *in, aml_pool_t *pool) {
+    return (uint64_t)(uintptr_t)ajson_encode(pool, in->raw, in->raw_len);
+}
+
+static uint64_t run_buffer_append_encoded(input_t *in, aml_pool_t *pool) {
+    (void)pool;
+    aml_buffer_clear(in->bh);
+    ajson_buffer_append_encoded(in->bh, in->raw, in->raw_len);
+    return aml_buffer_length(in->bh);
+}
+
+static uint64_t run_decode(input_t *in, aml_pool_t *pool) {
+    size_t n;
+    ajson_decode2(&n, pool, in->json, in->json_len);
+    return n;
+}
+
+static uint64_t run_decode_inplace(input_t *in, aml_pool_t *pool) {
+    (void)pool;
+    memcpy(in->work, in->json, in->json_len);
+    return ajson_decode_inplace(in->work, in->json_len);
+}
+
+static uint64_t run_utf8_valid_prefix(input_t *in, aml_pool_t *pool) {
+    (void)pool;
+    return ajson_utf8_valid_prefix(in->raw, in->raw_len);
+}
+
+static uint64_t run_copy_valid_utf8(input_t *in, aml_pool_t *pool) {
+    (void)pool;
+    return (uint64_t)(ajson_copy_valid_utf8(in->work, in->raw, in->raw_len) - in->work);
+}
+
+static uint64_t run_memcpy(input_t *in, aml_pool_t *pool) {
+    (void)pool;
+    memcpy(in->work, in->raw, in->raw_len);
+    return (unsigned char)in->work[0];
+}
+
+static const struct {
+    const char *name;
+    routine_fn run;
+    bool json_input;  /* Consumes the escaped form rather than raw text */
+} routines[] = {
+    { "encode",                run_encode,                false },
+    { "buffer_append_encoded", run_buffer_append_encoded, false },
+    { "decode",                run_decode,                true  },
+    { "decode_inplace",        run_decode_inplace,        true  },
+    { "utf8_valid_prefix",     run_utf8_valid_prefix,     false },
+    { "copy_valid_utf8",       run_copy_valid_utf8,       false },
+    { "memcpy",                run_memcpy,                false },
+};
+
+/* ---------- Measurement ---------- */
+
+static void bench_one(ajson_writer_t *w, size_t r, const profile_t *pr, input_t *in,
+                      aml_pool_t *pool, int iters, double *samples) {
+    size_t bytes = routines[r].json_input ? in->json_len : in->raw_len;
+    size_t calls = SAMPLE_BYTES / (bytes ? bytes : 1);
+    if (!calls) calls = 1;
+
+    /* One untimed call to warm up and to measure pool growth */
+    aml_pool_clear(pool);
+    bench_consume(routines[r].run(in, pool));
+    size_t pool_bytes = aml_pool_used(pool);
+
+    for (int i = 0; i < iters; i++) {
+        uint64_t sink = 0;
+        uint64_t t0 = bench_now_ns();
+        for (size_t c = 0; c < calls; c++) {
+            sink += routines[r].run(in, pool);
+            aml_pool_clear(pool);
+        }
+        uint64_t t1 = bench_now_ns();
+        bench_consume(sink);
+        samples[i] = (double)(t1 - t0) / ((double)calls * (double)(bytes ? bytes : 1));
+    }
+
+    bench_summary_t s;
+    bench_summarize(&s, samples, (size_t)iters);
+
+    ajson_writer_start_object(w);
+    KEY(w, "routine");       ajson_writer_string(w, routines[r].name, strlen(routines[r].name));
+    KEY(w, "profile");       ajson_writer_string(w, pr->name, strlen(pr->name));
+    KEY(w, "length");        ajson_writer_uint(w, in->raw_len);
+    KEY(w, "input_bytes");   ajson_writer_uint(w, bytes);
+    KEY(w, "calls_per_sample"); ajson_writer_uint(w, calls);
+    KEY(w, "ns_per_call");   ajson_writer_double(w, s.p50 * (double)bytes);
+    KEY(w, "pool_bytes_per_call"); ajson_writer_uint(w, pool_bytes);
+    bench_write_summary(w, "ns_per_byte", &s);
+    ajson_writer_end_object(w);
+
+    fprintf(stderr, "%-22s %-9s %9zu B %8.3f ns/B %10zu pool B\n",
+            routines[r].name, pr->name, in->raw_len, s.p50, pool_bytes);
+}
+
+int main(int argc, char **argv) {
+    const char *only = NULL;
+    const char *out_path = NULL;
+    size_t max_len = MAX_LENGTH;
+    int iters = 7;
+
+    for (int i = 1; i < argc; i++) {
+        const char *v;
+        if ((v = bench_arg(argc, argv, &i, "--routine"))) only = v;
+        else if ((v = bench_arg(argc, argv, &i, "--max-len"))) max_len = strtoul(v, NULL, 10);
+        else if ((v = bench_arg(argc, argv, &i, "--iters"))) iters = atoi(v);
+        else if ((v = bench_arg(argc, argv, &i, "--out"))) out_path = v;
+        else {
+            fprintf(stderr,
+                    "usage: %s [--routine NAME] [--max-len BYTES] [--iters N] [--out FILE]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    if (iters < 1) iters = 1;
+
+    FILE *out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) {
+        perror(out_path);
+        return 1;
+    }
+
+    aml_pool_t *pool = aml_pool_init(1 << 16);
+    double *samples = (double *)aml_malloc(sizeof(double) * (size_t)iters);
+
+    ajson_writer_t *w = ajson_writer_init_cb(bench_file_flush, out, 0);
+    ajson_writer_start_object(w);
+    bench_write_header(w, "bench_string_utils");
+    KEY(w, "config");
+    ajson_writer_start_object(w);
+    KEY(w, "sample_bytes"); ajson_writer_uint(w, SAMPLE_BYTES);
+    KEY(w, "iterations");   ajson_writer_int(w, iters);
+    ajson_writer_end_object(w);
+    KEY(w, "results");
+    ajson_writer_start_array(w);
+
+    for (size_t len = 8; len <= max_len; len *= 8) {
+        for (size_t p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++) {
+            input_t in;
+            input_init(&in, len, &profiles[p], pool);
+            for (size_t r = 0; r < sizeof(routines) / sizeof(routines[0]); r++) {
+                if (only && strcmp(only, routines[r].name)) continue;
+                bench_one(w, r, &profiles[p], &in, pool, iters, samples);
+            }
+            input_free(&in);
+        }
+    }
+
+    ajson_writer_end_array(w);
+    ajson_writer_end_object(w);
+    int rc = ajson_writer_destroy(w);
+    fputc('\n', out);
+    if (out != stdout) fclose(out);
+
+    aml_free(samples);
+    aml_pool_destroy(pool);
+    return rc ? 1 : 0;
+}
@@ -0,0 +1,340 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench_util.h"
+#include "a-memory-library/aml_alloc.h"
+#include "a-memory-library/aml_buffer.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ========================================================================
+ * Timing and statistics
+ * ======================================================================== */
+
+uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of sorted samples */
+static double percentile(const double *s, size_t n, double pct) {
+    size_t rank = (size_t)(pct / 100.0 * (double)n + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return s[rank - 1];
+}
+
+void bench_summarize(bench_summary_t *s, double *samples, size_t n) {
+    memset(s, 0, sizeof(*s));
+    if (!n) return;
+    qsort(samples, n, sizeof(double), compare_doubles);
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) sum += samples[i];
+    s->min = samples[0];
+    s->max = samples[n - 1];
+    s->mean = sum / (double)n;
+    s->p50 = percentile(samples, n, 50);
+    s->p90 = percentile(samples, n, 90);
+    s->p99 = percentile(samples, n, 99);
+}
+
+#define KEY(w, lit) ajson_writer_key((w), (lit), sizeof(lit) - 1)
+
+void bench_write_summary(ajson_writer_t *w, const char *key, const bench_summary_t *s) {
+    ajson_writer_key(w, key, strlen(key));
+    ajson_writer_start_object(w);
+    KEY(w, "min");  ajson_writer_double(w, s->min);
+    KEY(w, "p50");  ajson_writer_double(w, s->p50);
+    KEY(w, "p90");  ajson_writer_double(w, s->p90);
+    KEY(w, "p99");  ajson_writer_double(w, s->p99);
+    KEY(w, "max");  ajson_writer_double(w, s->max);
+    KEY(w, "mean"); ajson_writer_double(w, s->mean);
+    ajson_writer_end_object(w);
+}
+
+/* ========================================================================
+ * Synthetic corpora
+ * ======================================================================== */
+
+static const char *const words[] = {
+    "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel",
+    "india", "juliet", "kilo", "lima", "mike", "november", "oscar", "papa",
+    "caf\xC3\xA9", "na\xC3\xAFve", "\xE2\x82\xAC" "42", "\xE6\x97\xA5\xE6\x9C\xAC",
+    "quote\"d", "back\\slash", "line\nbreak", "tab\tbed"
+};
+#define NWORDS (sizeof(words) / sizeof(words[0]))
+#define NPLAIN 16 /* words[0..NPLAIN) need neither escaping nor UTF-8 */
+
+/* Space separated words; 'fancy' allows escapes and non-ASCII */
+static void gen_text(ajson_writer_t *w, uint64_t *rng, int nwords, bool fancy) {
+    char tmp[512];
+    size_t len = 0;
+    for (int i = 0; i < nwords; i++) {
+        const char *word = words[bench_rand(rng) % (fancy ? NWORDS : NPLAIN)];
+        size_t wl = strlen(word);
+        if (len + wl + 1 > sizeof(tmp)) break;
+        if (i) tmp[len++] = ' ';
+        memcpy(tmp + len, word, wl);
+        len += wl;
+    }
+    ajson_writer_string(w, tmp, len);
+}
+
+static void gen_record(ajson_writer_t *w, uint64_t *rng, uint64_t id) {
+    ajson_writer_start_object(w);
+    KEY(w, "id");      ajson_writer_uint(w, id);
+    KEY(w, "name");    gen_text(w, rng, 2, false);
+    KEY(w, "active");  ajson_writer_bool(w, bench_rand(rng) & 1);
+    KEY(w, "score");   ajson_writer_double(w, (double)(bench_rand(rng) % 100000) / 1000.0);
+    KEY(w, "tags");
+    ajson_writer_start_array(w);
+    for (int i = (int)(bench_rand(rng) % 4); i >= 0; i--) gen_text(w, rng, 1, false);
+    ajson_writer_end_array(w);
+    KEY(w, "address");
+    ajson_writer_start_object(w);
+    KEY(w, "city");    gen_text(w, rng, 1, true);
+    KEY(w, "zip");     ajson_writer_int(w, (int64_t)(bench_rand(rng) % 100000));
+    ajson_writer_end_object(w);
+    KEY(w, "note");    ajson_writer_null(w);
+    ajson_writer_end_object(w);
+}
+
+/* Long human-ish strings with sparse escapes and non-ASCII */
+static void gen_strings(ajson_writer_t *w, uint64_t *rng, uint64_t id) {
+    ajson_writer_start_object(w);
+    KEY(w, "id"); ajson_writer_uint(w, id);
+    KEY(w, "items");
+    ajson_writer_start_array(w);
+    for (int i = 0; i < 200; i++) {
+        ajson_writer_start_object(w);
+        KEY(w, "title");  gen_text(w, rng, 6, false);
+        KEY(w, "body");   gen_text(w, rng, 40, true);
+        KEY(w, "author"); gen_text(w, rng, 2, true);
+        ajson_writer_end_object(w);
+    }
+    ajson_writer_end_array(w);
+    ajson_writer_end_object(w);
+}
+
+static void gen_numbers(ajson_writer_t *w, uint64_t *rng, uint64_t id) {
+    ajson_writer_start_object(w);
+    KEY(w, "id"); ajson_writer_uint(w, id);
+    KEY(w, "ints");
+    ajson_writer_start_array(w);
+    for (int i = 0; i < 3000; i++)
+        ajson_writer_int(w, (int64_t)(bench_rand(rng) % 2000001) - 1000000);
+    ajson_writer_end_array(w);
+    KEY(w, "floats");
+    ajson_writer_start_array(w);
+    for (int i = 0; i < 3000; i++) {
+        double v = (double)(int64_t)(bench_rand(rng) % 2000001 - 1000000) / 997.0;
+        if (i % 10 == 0) v *= 1e30;
+        ajson_writer_double(w, v);
+    }
+    ajson_writer_end_array(w);
+    ajson_writer_end_object(w);
+}
+
+static void gen_nest(ajson_writer_t *w, uint64_t *rng, int depth) {
+    if (!depth) {
+        ajson_writer_int(w, (int64_t)(bench_rand(rng) % 1000));
+        return;
+    }
+    if (depth & 1) {
+        ajson_writer_start_object(w);
+        KEY(w, "v");    gen_nest(w, rng, depth - 1);
+        KEY(w, "n");    ajson_writer_int(w, depth);
+        ajson_writer_end_object(w);
+    } else {
+        ajson_writer_start_array(w);
+        gen_nest(w, rng, depth - 1);
+        ajson_writer_bool(w, true);
+        ajson_writer_end_array(w);
+    }
+}
+
+static void gen_nested(ajson_writer_t *w, uint64_t *rng, uint64_t id) {
+    (void)id;
+    ajson_writer_start_array(w);
+    for (int i = 0; i < 16; i++) gen_nest(w, rng, 64 + (int)(bench_rand(rng) % 300));
+    ajson_writer_end_array(w);
+}
+
+static void gen_wide(ajson_writer_t *w, uint64_t *rng, uint64_t id) {
+    char key[32];
+    ajson_writer_start_object(w);
+    for (int i = 0; i < 2000; i++) {
+        int n = snprintf(key, sizeof(key), "field_%llu_%d", (unsigned long long)id, i);
+        ajson_writer_key(w, key, (size_t)n);
+        switch (bench_rand(rng) % 4) {
+        case 0: ajson_writer_int(w, (int64_t)(bench_rand(rng) % 100000)); break;
+        case 1: gen_text(w, rng, 1, false); break;
+        case 2: ajson_writer_bool(w, bench_rand(rng) & 1); break;
+        default: ajson_writer_null(w); break;
+        }
+    }
+    ajson_writer_end_object(w);
+}
+
+/* Re-indent compact JSON two spaces per level */
+static void pretty_print(aml_buffer_t *out, const char *p, size_t len) {
+    int indent = 0;
+    bool in_string = false;
+    for (size_t i = 0; i < len; i++) {
+        char c = p[i];
+        if (in_string) {
+            aml_buffer_appendc(out, c);
+            if (c == '\\') aml_buffer_appendc(out, p[++i]);
+            else if (c == '"') in_string = false;
+            continue;
+        }
+        switch (c) {
+        case '"':
+            in_string = true;
+            aml_buffer_appendc(out, c);
+            break;
+        case '{':
+        case '[':
+            aml_buffer_appendc(out, c);
+            aml_buffer_appendc(out, '\n');
+            aml_buffer_appendn(out, ' ', 2 * ++indent);
+            break;
+        case '}':
+        case ']':
+            aml_buffer_appendc(out, '\n');
+            aml_buffer_appendn(out, ' ', 2 * --indent);
+            aml_buffer_appendc(out, c);
+            break;
+        case ',':
+            aml_buffer_appends(out, ",\n");
+            aml_buffer_appendn(out, ' ', 2 * indent);
+            break;
+        case ':':
+            aml_buffer_appends(out, ": ");
+            break;
+        default:
+            aml_buffer_appendc(out, c);
+        }
+    }
+}
+
+typedef void (*gen_doc_fn)(ajson_writer_t *w, uint64_t *rng, uint64_t id);
+
+static void gen_records(ajson_writer_t *w, uint64_t *rng, uint64_t id) {
+    ajson_writer_start_array(w);
+    for (int i = 0; i < 20; i++) gen_record(w, rng, id * 20 + (uint64_t)i);
+    ajson_writer_end_array(w);
+}
+
+static const struct {
+    const char *name;
+    gen_doc_fn gen;
+    bool pretty;
+} corpora[] = {
+    { "strings", gen_strings, false },
+    { "numbers", gen_numbers, false },
+    { "nested",  gen_nested,  false },
+    { "wide",    gen_wide,    false },
+    { "pretty",  gen_records, true  },
+    { "ndjson",  gen_record,  false },
+};
+
+const char *const bench_corpus_names[] = {
+    "strings", "numbers", "nested", "wide", "pretty", "ndjson", NULL
+};
+
+bool bench_corpus_make(bench_corpus_t *c, const char *name, size_t target_bytes) {
+    size_t k = 0;
+    while (k < sizeof(corpora) / sizeof(corpora[0]) && strcmp(corpora[k].name, name)) k++;
+    if (k == sizeof(corpora) / sizeof(corpora[0])) return false;
+
+    memset(c, 0, sizeof(*c));
+    c->name = corpora[k].name;
+
+    uint64_t rng = 0x9E3779B97F4A7C15ull ^ (k + 1);
+    aml_buffer_t *bh = aml_buffer_init(target_bytes + 4096);
+    aml_buffer_t *tmp = corpora[k].pretty ? aml_buffer_init(4096) : NULL;
+    size_t cap = 0;
+
+    while (aml_buffer_length(bh) < target_bytes) {
+        if (c->ndocs == cap) {
+            cap = cap ? cap * 2 : 1024;
+            c->offsets = (size_t *)aml_realloc(c->offsets, cap * sizeof(size_t));
+            c->lengths = (size_t *)aml_realloc(c->lengths, cap * sizeof(size_t));
+        }
+        size_t start = aml_buffer_length(bh);
+        if (tmp) {
+            aml_buffer_clear(tmp);
+            ajson_writer_t *w = ajson_writer_init(tmp);
+            corpora[k].gen(w, &rng, c->ndocs);
+            ajson_writer_destroy(w);
+            pretty_print(bh, aml_buffer_data(tmp), aml_buffer_length(tmp));
+        } else {
+            ajson_writer_t *w = ajson_writer_init(bh);
+            corpora[k].gen(w, &rng, c->ndocs);
+            ajson_writer_destroy(w);
+        }
+        c->offsets[c->ndocs] = start;
+        c->lengths[c->ndocs] = aml_buffer_length(bh) - start;
+        c->ndocs++;
+        aml_buffer_appendc(bh, '\n');
+    }
+
+    c->len = aml_buffer_length(bh);
+    c->data = (char *)aml_malloc(c->len + 1);
+    memcpy(c->data, aml_buffer_data(bh), c->len);
+    c->data[c->len] = 0;
+
+    if (tmp) aml_buffer_destroy(tmp);
+    aml_buffer_destroy(bh);
+    return true;
+}
+
+void bench_corpus_free(bench_corpus_t *c) {
+    aml_free(c->data);
+    aml_free(c->offsets);
+    aml_free(c->lengths);
+    memset(c, 0, sizeof(*c));
+}
+
+/* ========================================================================
+ * Report output
+ * ======================================================================== */
+
+int bench_file_flush(void *arg, const char *data, size_t len) {
+    return fwrite(data, 1, len, (FILE *)arg) == len ? 0 : -1;
+}
+
+void bench_write_header(ajson_writer_t *w, const char *tool) {
+    char host[256] = "unknown";
+    gethostname(host, sizeof(host) - 1);
+
+    char stamp[32];
+    time_t now = time(NULL);
+    struct tm tm;
+    gmtime_r(&now, &tm);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", &tm);
+
+    KEY(w, "tool");      ajson_writer_string(w, tool, strlen(tool));
+    KEY(w, "host");      ajson_writer_string(w, host, strlen(host));
+    KEY(w, "timestamp"); ajson_writer_string(w, stamp, strlen(stamp));
+#ifdef __VERSION__
+    KEY(w, "compiler");  ajson_writer_string(w, __VERSION__, strlen(__VERSION__));
+#endif
+}
+
+const char *bench_arg(int argc, char **argv, int *i, const char *name) {
+    if (strcmp(argv[*i], name) || *i + 1 >= argc) return NULL;
+    return argv[++*i];
+}
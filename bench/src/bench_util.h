@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _AJSON_BENCH_UTIL_H
+#define _AJSON_BENCH_UTIL_H
+
+#include "a-json-sax-library/ajson_writer.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* ========================
+ * Timing
+ * ======================== */
+
+/** Monotonic clock in nanoseconds. */
+uint64_t bench_now_ns(void);
+
+/** Keep the compiler from discarding a computed value. */
+static inline void bench_consume(uint64_t v) {
+    __asm__ volatile("" : : "r"(v) : "memory");
+}
+
+/** Deterministic xorshift generator (same corpus on every run/host). */
+static inline uint64_t bench_rand(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+/* ========================
+ * Summary statistics
+ * ======================== */
+
+typedef struct {
+    double min;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+    double mean;
+} bench_summary_t;
+
+/** Summarize 'n' samples (sorts 'samples' in place). */
+void bench_summarize(bench_summary_t *s, double *samples, size_t n);
+
+/** Write 's' as the value of 'key' in the current object. */
+void bench_write_summary(ajson_writer_t *w, const char *key, const bench_summary_t *s);
+
+/* ========================
+ * Corpora
+ * ======================== */
+
+/* A corpus is a run of documents, each followed by '\n'. */
+typedef struct {
+    const char *name;
+    char *data;
+    size_t len;
+    size_t *offsets;   /* Start of each document */
+    size_t *lengths;   /* Length of each document (without the '\n') */
+    size_t ndocs;
+} bench_corpus_t;
+
+/** Names accepted by bench_corpus_make, NULL terminated. */
+extern const char *const bench_corpus_names[];
+
+/** Generate about 'target_bytes' of the named synthetic corpus.
+ * Returns false if the name is unknown. */
+bool bench_corpus_make(bench_corpus_t *c, const char *name, size_t target_bytes);
+
+void bench_corpus_free(bench_corpus_t *c);
+
+/* ========================
+ * Report output
+ * ======================== */
+
+/** ajson_writer flush callback writing to a FILE* 'arg'. */
+int bench_file_flush(void *arg, const char *data, size_t len);
+
+/** Write the fields every report starts with (tool, host, timestamp). */
+void bench_write_header(ajson_writer_t *w, const char *tool);
+
+/** Parse "--name value" style options shared by the benchmark tools.
+ * Returns the value following argv[*i] if it matches 'name', else NULL. */
+const char *bench_arg(int argc, char **argv, int *i, const char *name);
+
+#endif /* _AJSON_BENCH_UTIL_H */
@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _ajson_bind_H
+#define _ajson_bind_H
+
+#include "a-json-sax-library/ajson_sax.h"
+#include "a-memory-library/aml_pool.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Declarative binding: parse a JSON object straight into a C struct.
+ *
+ *   typedef struct { int id; char *name; double *scores; size_t num_scores; } user_t;
+ *
+ *   static const ajson_bind_field_t user_fields[] = {
+ *       AJSON_BIND_FIELD(user_t, id, AJSON_BIND_INT),
+ *       AJSON_BIND_FIELD(user_t, name, AJSON_BIND_STRING),
+ *       AJSON_BIND_ARRAY_FIELD(user_t, scores, num_scores, AJSON_BIND_DOUBLE),
+ *   };
+ *   static const ajson_bind_desc_t user_desc = AJSON_BIND_DESC(user_t, user_fields);
+ *
+ *   ajson_bind_t *b = ajson_bind_init(&user_desc);   // once, at startup
+ *   user_t u = {0};
+ *   rc = ajson_bind_parse(b, &u, p, ep, pool, &error_at, 0);
+ *
+ * Keys are looked up in a hash table built by ajson_bind_init, and the
+ * handlers are compiled into the parser (AJSON_SAX_DEFINE_PARSER), so a
+ * binding is as fast as, or faster than, hand-written callbacks.
+ *
+ * - Members whose key is absent, or whose value is null, are left as they
+ *   are; unknown keys are skipped (with everything nested under them).
+ *   When a key repeats, the last value wins.
+ * - Strings are decoded and NUL-terminated.  They are copied into 'pool',
+ *   or aliased from the input with AJSON_SAX_DESTRUCTIVE.
+ * - Arrays are stored as a pool-allocated 'T *' plus a size_t count.
+ * - A value of the wrong type (or an integer out of range) fails the parse
+ *   with AJSON_BIND_MISMATCH.
+ */
+
+typedef enum {
+    AJSON_BIND_INT = 1,      /* int */
+    AJSON_BIND_INT64,        /* int64_t */
+    AJSON_BIND_UINT64,       /* uint64_t */
+    AJSON_BIND_DOUBLE,       /* double */
+    AJSON_BIND_BOOL,         /* bool */
+    AJSON_BIND_STRING,       /* char * */
+    AJSON_BIND_OBJECT        /* Nested struct described by 'nested' */
+} ajson_bind_type_t;
+
+/* OR'd into a type: the member is 'T *' and 'count_offset' locates a
+   size_t member receiving the number of elements. */
+#define AJSON_BIND_ARRAY 0x100
+
+/* Returned by ajson_bind_parse for a value of the wrong type. */
+#define AJSON_BIND_MISMATCH (-2)
+
+struct ajson_bind_desc_s;
+
+typedef struct {
+    const char *name;                        /* JSON key */
+    size_t offset;                           /* offsetof the member */
+    unsigned type;                           /* ajson_bind_type_t | AJSON_BIND_ARRAY */
+    const struct ajson_bind_desc_s *nested;  /* AJSON_BIND_OBJECT only */
+    size_t count_offset;                     /* AJSON_BIND_ARRAY only */
+} ajson_bind_field_t;
+
+typedef struct ajson_bind_desc_s {
+    const ajson_bind_field_t *fields;
+    size_t num_fields;
+    size_t size;                             /* sizeof the struct */
+} ajson_bind_desc_t;
+
+#define AJSON_BIND_NAMED(name, type, member, kind) \
+    { (name), offsetof(type, member), (kind), NULL, 0 }
+
+#define AJSON_BIND_FIELD(type, member, kind) \
+    AJSON_BIND_NAMED(#member, type, member, kind)
+
+#define AJSON_BIND_OBJECT_FIELD(type, member, desc) \
+    { #member, offsetof(type, member), AJSON_BIND_OBJECT, (desc), 0 }
+
+#define AJSON_BIND_ARRAY_FIELD(type, member, count, kind) \
+    { #member, offsetof(type, member), (kind) | AJSON_BIND_ARRAY, NULL, offsetof(type, count) }
+
+#define AJSON_BIND_OBJECT_ARRAY_FIELD(type, member, count, desc)              \
+    { #member, offsetof(type, member), AJSON_BIND_OBJECT | AJSON_BIND_ARRAY,   \
+      (desc), offsetof(type, count) }
+
+#define AJSON_BIND_DESC(type, fields) \
+    { (fields), sizeof(fields) / sizeof((fields)[0]), sizeof(type) }
+
+typedef struct ajson_bind_s ajson_bind_t;
+
+/** Compile 'desc' and every descriptor reachable from it (recursion is
+ * allowed) into key hash tables.  The descriptors must outlive the
+ * result, which is immutable and may be shared between threads. */
+ajson_bind_t *ajson_bind_init(const ajson_bind_desc_t *desc);
+
+void ajson_bind_destroy(ajson_bind_t *b);
+
+/** Parse the object in [p, ep) into 'out', a struct described by the root
+ * descriptor.  'pool' receives strings, arrays and the parser's own
+ * allocations.  'flags' are AJSON_SAX_DESTRUCTIVE and
+ * AJSON_SAX_VALIDATE_UTF8 (strings are always decoded).  Returns 0, -1 on
+ * a syntax error or AJSON_BIND_MISMATCH; 'error_at' is set on failure. */
+int ajson_bind_parse(const ajson_bind_t *b, void *out,
+                     char *p, char *ep, aml_pool_t *pool,
+                     char **error_at, unsigned flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ajson_bind_H */
@@ -0,0 +1,261 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _ajson_gen_rt_H
+#define _ajson_gen_rt_H
+
+/* Runtime support for parsers generated by the ajson_gen tool (see
+ * tools/src/ajson_gen.c).  Generated code includes this header; nothing else
+ * should need it.
+ *
+ * Every helper takes 'p' at the first byte of a value (whitespace already
+ * skipped) and returns the byte after it, or NULL after recording the
+ * error in the ajson_gen_t.  As with ajson_sax_parse, the input must be
+ * followed by a NUL at 'ep'; scans stop on it.
+ */
+
+#include "a-json-sax-library/ajson_number.h"
+#include "a-json-sax-library/ajson_sax.h"
+#include "a-json-sax-library/ajson_scan.h"
+#include "a-json-sax-library/ajson_string_utils.h"
+#include "a-memory-library/aml_pool.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Returned for a value of the wrong type (as AJSON_BIND_MISMATCH). */
+#define AJSON_GEN_MISMATCH (-2)
+
+typedef struct {
+    char *ep;
+    aml_pool_t *pool;
+    bool alias;             /* AJSON_SAX_DESTRUCTIVE: strings point into the input */
+    int rc;
+    char *error_at;
+} ajson_gen_t;
+
+/* A growing array, moved into the struct once complete */
+typedef struct {
+    char *items;
+    size_t count;
+    size_t cap;
+} ajson_gen_vec_t;
+
+/** Skip (and check) any value.  Used for keys the schema does not know. */
+char *ajson_gen_skip(ajson_gen_t *g, char *p);
+
+static inline void ajson_gen_init(ajson_gen_t *g, char *ep, aml_pool_t *pool, unsigned flags) {
+    g->ep = ep;
+    g->pool = pool;
+    g->alias = (flags & AJSON_SAX_DESTRUCTIVE) != 0;
+    g->rc = 0;
+    g->error_at = NULL;
+}
+
+static inline char *ajson_gen_fail(ajson_gen_t *g, char *p) {
+    g->rc = -1;
+    g->error_at = p;
+    return NULL;
+}
+
+static inline char *ajson_gen_mismatch(ajson_gen_t *g, char *p) {
+    g->rc = AJSON_GEN_MISMATCH;
+    g->error_at = p;
+    return NULL;
+}
+
+static inline char *ajson_gen_ws(char *p) {
+    while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t') p++;
+    return p;
+}
+
+/* 'null' is accepted for every member and leaves it untouched. */
+static inline bool ajson_gen_is_null(const char *p) {
+    return p[0] == 'n' && p[1] == 'u' && p[2] == 'l' && p[3] == 'l';
+}
+
+/* Finds the closing quote of the string opening at 'p'.  Returns NULL if
+   it is unterminated; '*escapes' says whether a '\\' was seen. */
+static inline char *ajson_gen_string_end(ajson_gen_t *g, char *p, bool *escapes) {
+    *escapes = false;
+    p++;
+    for (;;) {
+        p = (char *)ajson_scan_string(p, g->ep);
+        if (p >= g->ep) return NULL;
+        if (*p == '\"') return p;
+        *escapes = true;
+        p += 2;
+    }
+}
+
+/* A key and the ':' after it.  'p' is at the opening quote; returns the
+   start of the value with the decoded key in *key / *len. */
+static inline char *ajson_gen_key(ajson_gen_t *g, char *p, char **key, size_t *len) {
+    if (*p != '\"') return ajson_gen_fail(g, p);
+    bool escapes;
+    char *e = ajson_gen_string_end(g, p, &escapes);
+    if (!e) return ajson_gen_fail(g, p);
+    *key = p + 1;
+    *len = e - p - 1;
+    if (AJSON_UNLIKELY(escapes)) *key = ajson_decode2(len, g->pool, *key, *len);
+    p = ajson_gen_ws(e + 1);
+    if (*p != ':') return ajson_gen_fail(g, p);
+    return ajson_gen_ws(p + 1);
+}
+
+static inline char *ajson_gen_string(ajson_gen_t *g, char *p, char **out) {
+    if (*p != '\"') {
+        if (ajson_gen_is_null(p)) return p + 4;
+        return ajson_gen_mismatch(g, p);
+    }
+    bool escapes;
+    char *e = ajson_gen_string_end(g, p, &escapes);
+    if (!e) return ajson_gen_fail(g, p);
+    char *s = p + 1;
+    size_t len = e - s;
+    if (g->alias) {
+        *e = 0;
+        if (escapes) ajson_decode_inplace(s, len);
+        *out = s;
+    } else if (escapes) {
+        *out = ajson_decode2(&len, g->pool, s, len);
+    } else {
+        *out = aml_pool_strndup(g->pool, s, len);
+    }
+    return e + 1;
+}
+
+static inline char *ajson_gen_bool(ajson_gen_t *g, char *p, bool *out) {
+    if (p[0] == 't' && p[1] == 'r' && p[2] == 'u' && p[3] == 'e') {
+        *out = true;
+        return p + 4;
+    }
+    if (p[0] == 'f' && p[1] == 'a' && p[2] == 'l' && p[3] == 's' && p[4] == 'e') {
+        *out = false;
+        return p + 5;
+    }
+    if (ajson_gen_is_null(p)) return p + 4;
+    return ajson_gen_mismatch(g, p);
+}
+
+/* Integer digits with the JSON rules for leading zeros.  Values over 'max'
+   and numbers with a fraction or exponent are mismatches. */
+static inline char *ajson_gen_digits(ajson_gen_t *g, char *p, uint64_t max, uint64_t *out) {
+    char *sp = p;
+    unsigned d = (unsigned)(*p - '0');
+    if (d > 9) return ajson_gen_fail(g, p);
+    uint64_t x = d;
+    p++;
+    if (d) {
+        while ((d = (unsigned)(*p - '0')) <= 9) {
+            if (x > (max - d) / 10) return ajson_gen_mismatch(g, sp);
+            x = x * 10 + d;
+            p++;
+        }
+    }
+    if ((unsigned)(*p - '0') <= 9) return ajson_gen_fail(g, p);  /* Leading zero */
+    if (*p == '.' || *p == 'e' || *p == 'E' || x > max) return ajson_gen_mismatch(g, sp);
+    *out = x;
+    return p;
+}
+
+static inline char *ajson_gen_int64(ajson_gen_t *g, char *p, int64_t *out) {
+    uint64_t x;
+    if (*p == '-') {
+        if (!(p = ajson_gen_digits(g, p + 1, (uint64_t)INT64_MAX + 1, &x))) return NULL;
+        *out = (int64_t)(0 - x);
+        return p;
+    }
+    if (*p == 'n' && ajson_gen_is_null(p)) return p + 4;
+    if (*p == '\"' || *p == 't' || *p == 'f' || *p == '{' || *p == '[')
+        return ajson_gen_mismatch(g, p);
+    if (!(p = ajson_gen_digits(g, p, INT64_MAX, &x))) return NULL;
+    *out = (int64_t)x;
+    return p;
+}
+
+static inline char *ajson_gen_int(ajson_gen_t *g, char *p, int *out) {
+    int64_t v;
+    char *r;
+    if (*p == 'n' && ajson_gen_is_null(p)) return p + 4;
+    if (!(r = ajson_gen_int64(g, p, &v))) return NULL;
+    if (v < INT32_MIN || v > INT32_MAX) return ajson_gen_mismatch(g, p);
+    *out = (int)v;
+    return r;
+}
+
+static inline char *ajson_gen_uint64(ajson_gen_t *g, char *p, uint64_t *out) {
+    if (*p == 'n' && ajson_gen_is_null(p)) return p + 4;
+    if (*p == '-' || *p == '\"' || *p == 't' || *p == 'f' || *p == '{' || *p == '[')
+        return ajson_gen_mismatch(g, p);
+    return ajson_gen_digits(g, p, UINT64_MAX, out);
+}
+
+/* Plain integers that fit in 2^53 convert exactly; the rest go through
+   ajson_parse_double once the JSON grammar has been checked. */
+static inline char *ajson_gen_double(ajson_gen_t *g, char *p, double *out) {
+    char *sp = p;
+    if (*p == '-') p++;
+    unsigned d = (unsigned)(*p - '0');
+    if (d > 9) {
+        if (sp == p) {
+            if (ajson_gen_is_null(p)) return p + 4;
+            if (*p == '\"' || *p == 't' || *p == 'f' || *p == '{' || *p == '[')
+                return ajson_gen_mismatch(g, p);
+        }
+        return ajson_gen_fail(g, p);
+    }
+    uint64_t x = 0;
+    int n = 0;
+    if (*p == '0') p++;
+    else
+        while ((d = (unsigned)(*p - '0')) <= 9) {
+            x = x * 10 + d;
+            n++;
+            p++;
+        }
+    bool simple = n <= 15;
+    if (*p == '.') {
+        p++;
+        if ((unsigned)(*p - '0') > 9) return ajson_gen_fail(g, p);
+        while ((unsigned)(*p - '0') <= 9) p++;
+        simple = false;
+    }
+    if (*p == 'e' || *p == 'E') {
+        p++;
+        if (*p == '+' || *p == '-') p++;
+        if ((unsigned)(*p - '0') > 9) return ajson_gen_fail(g, p);
+        while ((unsigned)(*p - '0') <= 9) p++;
+        simple = false;
+    }
+    if (simple) *out = *sp == '-' ? -(double)x : (double)x;
+    else *out = ajson_parse_double(sp, (size_t)(p - sp));
+    return p;
+}
+
+/* Append a zeroed element of 'size' bytes. */
+static inline void *ajson_gen_push(ajson_gen_t *g, ajson_gen_vec_t *v, size_t size) {
+    if (v->count == v->cap) {
+        size_t cap = v->cap ? v->cap * 2 : 8;
+        char *items = (char *)aml_pool_alloc(g->pool, cap * size);
+        if (v->count) memcpy(items, v->items, v->count * size);
+        v->items = items;
+        v->cap = cap;
+    }
+    char *r = v->items + v->count++ * size;
+    memset(r, 0, size);
+    return r;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ajson_gen_rt_H */
@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _AJSON_NUMBER_H
+#define _AJSON_NUMBER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Longest text ajson_format_double writes ("-2.2250738585072014e-308"). */
+#define AJSON_DOUBLE_MAX_LEN 24
+
+/** Write the shortest decimal that reads back as exactly 'v' into 'buf'
+ * (at least AJSON_DOUBLE_MAX_LEN bytes, not NUL-terminated) and return
+ * its length.  The layout follows printf's %g: plain notation when the
+ * leading digit's power of ten is in [-4, 17), otherwise "d.ddde+NN".
+ * The decimal point is always '.', whatever the locale.  NaN and
+ * infinities have no JSON form and are written as null. */
+size_t ajson_format_double(char *buf, double v);
+
+/** Convert the JSON number of 'len' bytes at 's' to the nearest double.
+ * The text must already have been checked against the JSON grammar and
+ * must not be followed by a byte that could continue it.  The decimal
+ * point is '.' whatever the locale.  Short inputs convert without
+ * strtod; the rest use strtod_l in the "C" locale. */
+double ajson_parse_double(const char *s, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AJSON_NUMBER_H */
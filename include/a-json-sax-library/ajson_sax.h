@@ -7,13 +7,15 @@
 #include "a-memory-library/aml_pool.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* Forward declaration */
+/* Forward declarations */
 typedef struct ajson_sax_s ajson_sax_t;
+struct iovec;
 
 /* * The Virtual Method Table (VTable) for handlers.
  * Define these as 'static const' structs in your code to avoid
@@ -50,12 +52,20 @@ struct ajson_sax_s {
     sax_handler_node_t *top; /* The stack head */
     int current_depth;       /* Tracked by the parser */
     int anchor_depth;        /* The depth where current 'cb' took control */
+    bool has_escapes;        /* Set before on_key/on_string: the raw string had a '\\' */
 };
 
 /* * Main Parse Function.
  * - Modifies 'p' in-place (adds NUL terminators).
  * - Uses 'pool' only for the handler stack (not for nodes).
  * - 'initial_cb' sets the root handlers.
+ * - Only whitespace may separate a key from its ':', and a key that is
+ *   still open at 'ep' is an error.
+ * - [p, ep) must hold exactly one value: only whitespace may follow it,
+ *   and a container still open at 'ep' is an error.  A root number is
+ *   only known to end at 'ep' by reading *ep, which must be NUL.
+ *   (A stream instead ends the document at its last byte: see
+ *   ajson_sax_stream_offset.)
  */
 int ajson_sax_parse(char *p, char *ep,
                     const ajson_sax_cb_t *initial_cb,
@@ -74,6 +84,153 @@ int ajson_sax_parse_destructive(char *p, char *ep,
                                 void *ctx,
                                 char **error_at);
 
+/* * Parse options for ajson_sax_parse_ex (bitwise OR).
+ * - AJSON_SAX_DESTRUCTIVE: same as ajson_sax_parse_destructive.
+ * - AJSON_SAX_DECODE_STRINGS: on_key/on_string receive decoded UTF-8
+ *   instead of the raw JSON slice.  Strings without escapes are passed
+ *   through untouched.  In destructive mode escaped strings are decoded in
+ *   place; otherwise they are decoded into 'pool'.
+ * - AJSON_SAX_VALIDATE_UTF8: reject keys/strings that contain invalid
+ *   UTF-8 (strict RFC 3629), raw control characters or malformed escapes.
+ *   'error_at' points at the offending byte.
+ */
+#define AJSON_SAX_DESTRUCTIVE    0x01
+#define AJSON_SAX_DECODE_STRINGS 0x02
+#define AJSON_SAX_VALIDATE_UTF8  0x04
+
+/* * Parse with options (see AJSON_SAX_* above).
+ * Handlers that receive raw strings can check sax->has_escapes and skip
+ * ajson_decode entirely for the (common) strings that have no escapes.
+ */
+int ajson_sax_parse_ex(char *p, char *ep,
+                       const ajson_sax_cb_t *initial_cb,
+                       aml_pool_t *pool,
+                       void *ctx,
+                       char **error_at,
+                       unsigned flags);
+
+/* * Per-parse statistics, filled in by ajson_sax_parse_stats. */
+typedef struct {
+    size_t bytes;             /* Bytes consumed (up to the error on failure) */
+    size_t objects;
+    size_t arrays;
+    size_t keys;
+    size_t strings;
+    size_t numbers;
+    size_t bools;
+    size_t nulls;
+    size_t escaped_strings;   /* Keys/strings containing a '\\' */
+    size_t longest_string;    /* Longest raw key or string, in bytes */
+    int max_depth;
+    size_t handler_pushes;    /* Handler stack changes made by callbacks */
+    size_t handler_pops;
+    size_t pool_bytes;        /* Growth of aml_pool_used(pool) */
+    uint64_t total_ns;        /* Whole parse (AJSON_SAX_TIME_CALLBACKS only) */
+    uint64_t callback_ns;     /* Inside callbacks (AJSON_SAX_TIME_CALLBACKS only) */
+} ajson_sax_stats_t;
+
+/* * Extra option for ajson_sax_parse_stats: time the parse and every
+ * callback (two clock reads per callback).  total_ns - callback_ns is the
+ * time spent in the parser itself.
+ */
+#define AJSON_SAX_TIME_CALLBACKS 0x08
+
+/* * Parse like ajson_sax_parse_ex while recording 'stats'.
+ * This is a separate, non-specialized entry point; the regular parse
+ * functions carry no instrumentation at all.
+ */
+int ajson_sax_parse_stats(char *p, char *ep,
+                          const ajson_sax_cb_t *initial_cb,
+                          aml_pool_t *pool,
+                          void *ctx,
+                          char **error_at,
+                          unsigned flags,
+                          ajson_sax_stats_t *stats);
+
+/* * Per-document callbacks for ajson_sax_parse_many (either may be NULL).
+ * 'index' counts documents from 0 and 'offset' is relative to 'p': the
+ * first byte of the document, or the byte after it.  A non-zero result
+ * stops the parse and is returned.
+ */
+typedef struct {
+    int (*on_begin_document)(void *ctx, size_t index, size_t offset);
+    int (*on_end_document)(void *ctx, size_t index, size_t offset);
+} ajson_sax_doc_cb_t;
+
+/* * Parse consecutive top-level values (NDJSON, JSON text sequences without
+ * the RS byte, or values simply run together) in one call.
+ * - Values may be separated by whitespace; it is required only after a
+ *   number ("1 2", but "{}[]" or "\"a\"1" are fine).  Any other byte
+ *   between values, NUL included, is a syntax error.
+ * - As with ajson_sax_parse, *ep must be readable and NUL: a number that
+ *   ends the input is terminated by it.  With AJSON_SAX_DESTRUCTIVE the
+ *   whitespace after a number is overwritten with NUL; that one byte is
+ *   still taken as the separator.
+ * - Each document starts with 'initial_cb' as the active handlers.
+ * - 'end_at' is set to where parsing stopped: 'ep' once everything has
+ *   been parsed, otherwise the syntax error or the position at which a
+ *   callback returned non-zero.
+ * - Returns 0, -1 on a syntax error or the first non-zero callback result.
+ */
+int ajson_sax_parse_many(char *p, char *ep,
+                         const ajson_sax_cb_t *initial_cb,
+                         const ajson_sax_doc_cb_t *doc_cb,
+                         aml_pool_t *pool,
+                         void *ctx,
+                         char **end_at,
+                         unsigned flags);
+
+/* * Parse 'n' separate documents, docs[i] being [iov_base, iov_base + iov_len),
+ * e.g. a batch of messages from a queue whose buffers are scattered in
+ * memory.  The first cache lines of the next few documents (and their
+ * contexts) are prefetched while the current one is parsed.
+ * - Document i is parsed as ajson_sax_parse_ex would, with 'initial_cb'
+ *   and ctxs[i] (NULL for every document if 'ctxs' is NULL).
+ * - status[i] is its result: 0, -1 on a syntax error or the non-zero
+ *   callback result.  If 'error_at' is not NULL, error_at[i] is set to the
+ *   syntax error, or NULL.
+ * - 'pool' is shared and not cleared between documents.
+ * - Returns the number of documents whose status is not 0.
+ */
+size_t ajson_sax_parse_batch(const struct iovec *docs, size_t n,
+                             const ajson_sax_cb_t *initial_cb,
+                             aml_pool_t *pool,
+                             void *const *ctxs,
+                             int *status,
+                             char **error_at,
+                             unsigned flags);
+
+/* * Reusable parser for many documents, typically many small messages.
+ *
+ *   ajson_sax_parser_t *ps = ajson_sax_parser_init(&handlers, flags, 0);
+ *   for (each message)
+ *       rc = ajson_sax_parser_parse(ps, p, ep, ctx, &error_at);
+ *   ajson_sax_parser_destroy(ps);
+ *
+ * The handler table, the parse variant for 'flags' and the pool are set
+ * up once.  The pool is owned by the parser and serves the handler stack
+ * and decoded strings; it is cleared at the start of each parse, so what a
+ * document put there stays valid until the next call.  Once the pool has
+ * grown to what a document needs, parsing allocates nothing.
+ */
+typedef struct ajson_sax_parser_s ajson_sax_parser_t;
+
+/* 'pool_size' is the pool's initial size (0 for 4 KiB). */
+ajson_sax_parser_t *ajson_sax_parser_init(const ajson_sax_cb_t *initial_cb,
+                                          unsigned flags, size_t pool_size);
+
+/* Parse one document in [p, ep) as ajson_sax_parse_ex would. */
+int ajson_sax_parser_parse(ajson_sax_parser_t *ps, char *p, char *ep,
+                           void *ctx, char **error_at);
+
+/* The parser's pool, e.g. for callbacks that copy values out of the input */
+aml_pool_t *ajson_sax_parser_pool(ajson_sax_parser_t *ps);
+
+/* Clear the pool now instead of at the next parse. */
+void ajson_sax_parser_reset(ajson_sax_parser_t *ps);
+
+void ajson_sax_parser_destroy(ajson_sax_parser_t *ps);
+
 /* * Stack Operations
  * Use these inside your callbacks (e.g., inside on_start_object).
  */
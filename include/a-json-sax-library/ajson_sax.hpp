@@ -0,0 +1,330 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _ajson_sax_HPP
+#define _ajson_sax_HPP
+
+/* Header-only C++17 front end.  The state machine from ajson_sax_impl.h is
+ * instantiated once per handler type, and the handler's member functions
+ * are called directly (and usually inlined) instead of through a
+ * 'void *ctx' trampoline table chosen at run time:
+ *
+ *   struct Totals {
+ *       double sum = 0;
+ *       void on_number(std::string_view v) { sum += std::strtod(v.data(), nullptr); }
+ *       int on_key(ajson::sax &sax, std::string_view k) { ... return 0; }
+ *   };
+ *
+ *   Totals t;
+ *   int rc = ajson::sax_parse(p, ep, t, pool, &error_at);
+ *
+ * Every member is optional; missing ones cost nothing.  The names match
+ * ajson_sax_cb_t:
+ *
+ *   on_null()                 on_bool(bool)
+ *   on_number(string_view)    on_string(string_view)    on_key(string_view)
+ *   on_start_object()         on_end_object()
+ *   on_start_array()          on_end_array()
+ *
+ * Each may also take an 'ajson::sax &' first, and may return void
+ * (continue) or an int (0 to continue, anything else aborts the parse and
+ * is returned, as in the C API).
+ *
+ * sax.push(sub) hands the contents of the object or array that is being
+ * opened (call it from on_start_object/on_start_array) to another handler
+ * object.  The push is scoped: 'sub' also receives the matching end event,
+ * after which the previous handler is restored automatically.  Pushed
+ * handlers are dispatched through a per-type table, like ajson_sax_push.
+ */
+
+#include "a-json-sax-library/ajson_sax.h"
+#include "a-json-sax-library/ajson_sax_impl.h"
+#include "a-json-sax-library/ajson_sax_stream.h"
+#include "a-memory-library/aml_pool.h"
+
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#endif
+
+namespace ajson {
+
+class sax;
+
+namespace detail {
+
+/* Handler state shared by every callback of one parse ('ctx'). */
+struct frame {
+    void *handler;
+    frame *next;
+};
+
+struct state {
+    void *handler;       /* The active handler object */
+    frame *saved;        /* Handlers displaced by sax::push */
+    aml_pool_t *owned;   /* Pool created on demand when none was given */
+};
+
+/* One tag per callback; call() is SFINAE-friendly so the tags double as
+   member detectors. */
+#define AJSON_CXX_EVENT(name)                                                  \
+    struct name##_event {                                                      \
+        template <class H, class... A>                                         \
+        static auto call(H &h, A &&...a)                                       \
+            -> decltype(h.name(std::forward<A>(a)...)) {                       \
+            return h.name(std::forward<A>(a)...);                              \
+        }                                                                      \
+    };
+
+AJSON_CXX_EVENT(on_null)
+AJSON_CXX_EVENT(on_bool)
+AJSON_CXX_EVENT(on_number)
+AJSON_CXX_EVENT(on_string)
+AJSON_CXX_EVENT(on_key)
+AJSON_CXX_EVENT(on_start_object)
+AJSON_CXX_EVENT(on_end_object)
+AJSON_CXX_EVENT(on_start_array)
+AJSON_CXX_EVENT(on_end_array)
+
+#undef AJSON_CXX_EVENT
+
+template <class... A> struct args {};
+
+template <class E, class H, class Args, class = void>
+struct accepts : std::false_type {};
+
+template <class E, class H, class... A>
+struct accepts<E, H, args<A...>,
+               std::void_t<decltype(E::call(std::declval<H &>(), std::declval<A>()...))>>
+    : std::true_type {};
+
+template <class E, class H, class... A>
+inline constexpr bool takes_sax = accepts<E, H, args<sax &, A...>>::value;
+
+template <class E, class H, class... A>
+inline constexpr bool has_event = takes_sax<E, H, A...> || accepts<E, H, args<A...>>::value;
+
+template <class R> inline int status(R &&r) { return static_cast<int>(r); }
+
+/* Call event E on 'h' in whichever form it declares; 0 if it has none. */
+template <class E, class H, class... A>
+inline int fire(H &h, sax &s, A... a) {
+    if constexpr (takes_sax<E, H, A...>) {
+        if constexpr (std::is_void_v<decltype(E::call(h, s, a...))>) {
+            E::call(h, s, a...);
+            return 0;
+        } else {
+            return status(E::call(h, s, a...));
+        }
+    } else if constexpr (has_event<E, H, A...>) {
+        if constexpr (std::is_void_v<decltype(E::call(h, a...))>) {
+            E::call(h, a...);
+            return 0;
+        } else {
+            return status(E::call(h, a...));
+        }
+    } else {
+        (void)h; (void)s;
+        ((void)a, ...);
+        return 0;
+    }
+}
+
+template <class H> struct table;
+
+} // namespace detail
+
+/* The parser as seen from a callback. */
+class sax {
+public:
+    /* Nesting depth of the value being delivered (0 for the root value). */
+    int depth() const { return s_->current_depth; }
+
+    /* The raw key/string had a '\\' (see ajson_sax_t::has_escapes). */
+    bool has_escapes() const { return s_->has_escapes; }
+
+    /* The parse pool; one is created on first use if none was given. */
+    aml_pool_t *pool() {
+        if (!s_->pool) s_->pool = st_->owned = aml_pool_init(1024);
+        return s_->pool;
+    }
+
+    /* Route the contents of the container being opened to 'sub' until it
+       closes.  'sub' must outlive that container. */
+    template <class Sub> void push(Sub &sub) {
+        aml_pool_t *p = pool();
+        detail::frame *f = (detail::frame *)aml_pool_alloc(p, sizeof(detail::frame));
+        f->handler = st_->handler;
+        f->next = st_->saved;
+        st_->saved = f;
+        st_->handler = &sub;
+        ajson_sax_push(s_, &detail::table<Sub>::pushed);
+    }
+
+    /* Restore the handler displaced by the last push.  Normally automatic. */
+    void pop() {
+        if (!st_->saved) return;
+        st_->handler = st_->saved->handler;
+        st_->saved = st_->saved->next;
+        ajson_sax_pop(s_);
+    }
+
+    ajson_sax_t *get() const { return s_; }
+
+    sax(ajson_sax_t *s, void *ctx) : s_(s), st_(static_cast<detail::state *>(ctx)) {}
+
+private:
+    ajson_sax_t *s_;
+    detail::state *st_;
+};
+
+namespace detail {
+
+template <class H> inline H &handler(void *ctx) {
+    return *static_cast<H *>(static_cast<state *>(ctx)->handler);
+}
+
+template <class E, class H>
+inline int event(void *ctx, ajson_sax_t *s) {
+    sax x(s, ctx);
+    return fire<E>(handler<H>(ctx), x);
+}
+
+/* End events of a pushed handler also end its scope. */
+template <class E, class H>
+inline int scoped_end(void *ctx, ajson_sax_t *s) {
+    sax x(s, ctx);
+    int rc = fire<E>(handler<H>(ctx), x);
+    if (!rc && s->current_depth == s->anchor_depth) x.pop();
+    return rc;
+}
+
+template <class H>
+inline int bool_event(void *ctx, ajson_sax_t *s, bool v) {
+    sax x(s, ctx);
+    return fire<on_bool_event>(handler<H>(ctx), x, v);
+}
+
+template <class E, class H>
+inline int text_event(void *ctx, ajson_sax_t *s, const char *v, size_t len) {
+    sax x(s, ctx);
+    return fire<E>(handler<H>(ctx), x, std::string_view(v, len));
+}
+
+template <class H> struct table {
+    using sv = std::string_view;
+
+    /* Root handlers: absent members are left NULL so the specialized parser
+       drops them entirely. */
+    static constexpr ajson_sax_cb_t root = {
+        has_event<on_null_event, H> ? &event<on_null_event, H> : nullptr,
+        has_event<on_bool_event, H, bool> ? &bool_event<H> : nullptr,
+        has_event<on_number_event, H, sv> ? &text_event<on_number_event, H> : nullptr,
+        has_event<on_string_event, H, sv> ? &text_event<on_string_event, H> : nullptr,
+        has_event<on_key_event, H, sv> ? &text_event<on_key_event, H> : nullptr,
+        has_event<on_start_object_event, H> ? &event<on_start_object_event, H> : nullptr,
+        has_event<on_end_object_event, H> ? &event<on_end_object_event, H> : nullptr,
+        has_event<on_start_array_event, H> ? &event<on_start_array_event, H> : nullptr,
+        has_event<on_end_array_event, H> ? &event<on_end_array_event, H> : nullptr,
+    };
+
+    /* Pushed handlers always see end events, to end their scope. */
+    static constexpr ajson_sax_cb_t pushed = {
+        root.on_null, root.on_bool, root.on_number, root.on_string, root.on_key,
+        root.on_start_object, &scoped_end<on_end_object_event, H>,
+        root.on_start_array, &scoped_end<on_end_array_event, H>,
+    };
+};
+
+/* Releases the on-demand pool, whatever way the parse ends. */
+struct state_guard {
+    state st{nullptr, nullptr, nullptr};
+    ~state_guard() {
+        if (st.owned) aml_pool_destroy(st.owned);
+    }
+};
+
+} // namespace detail
+
+/* ajson_sax_parse_ex for handler type H with constant AJSON_SAX_* 'Flags'.
+   Returns 0, -1 on a syntax error (with *error_at set if given), or the
+   first non-zero handler result.  'pool' may be NULL: one is created when
+   a push or a decoded string needs it, and released before returning. */
+template <unsigned Flags, class H>
+inline int sax_parse_ex(char *p, char *ep, H &handler, aml_pool_t *pool = nullptr,
+                        char **error_at = nullptr) {
+    static_assert((Flags & ~(unsigned)(AJSON_SAX_DESTRUCTIVE | AJSON_SAX_DECODE_STRINGS |
+                                       AJSON_SAX_VALIDATE_UTF8)) == 0,
+                  "unsupported AJSON_SAX_* flag");
+    detail::state_guard g;
+    g.st.handler = &handler;
+    /* Escaped strings are decoded into the pool unless decoded in place */
+    if constexpr ((Flags & AJSON_SAX_DECODE_STRINGS) && !(Flags & AJSON_SAX_DESTRUCTIVE)) {
+        if (!pool) pool = g.st.owned = aml_pool_init(1024);
+    }
+    return ajson_sax_parse_impl(p, ep, &detail::table<H>::root, pool, &g.st, error_at,
+                                Flags, nullptr, &detail::table<H>::root, nullptr);
+}
+
+template <class H>
+inline int sax_parse(char *p, char *ep, H &handler, aml_pool_t *pool = nullptr,
+                     char **error_at = nullptr) {
+    return sax_parse_ex<0>(p, ep, handler, pool, error_at);
+}
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+template <unsigned Flags, class H>
+inline int sax_parse_ex(std::span<char> buf, H &handler, aml_pool_t *pool = nullptr,
+                        char **error_at = nullptr) {
+    return sax_parse_ex<Flags>(buf.data(), buf.data() + buf.size(), handler, pool, error_at);
+}
+
+template <class H>
+inline int sax_parse(std::span<char> buf, H &handler, aml_pool_t *pool = nullptr,
+                     char **error_at = nullptr) {
+    return sax_parse_ex<0>(buf.data(), buf.data() + buf.size(), handler, pool, error_at);
+}
+#endif
+
+/* Incremental parsing (ajson_sax_stream.h) with a C++ handler.  The
+   resumable parser is compiled once in the library, so the handler is
+   called through its table rather than inlined.  A pool is created if none
+   is given.  See ajson_sax_coro.hpp for a coroutine front end. */
+template <class H> class stream {
+public:
+    explicit stream(H &handler, aml_pool_t *pool = nullptr, unsigned flags = 0)
+        : root_(&handler) {
+        if (!pool) pool = g_.st.owned = aml_pool_init(1024);
+        g_.st.handler = root_;
+        s_ = ajson_sax_stream_init(&detail::table<H>::root, pool, &g_.st, flags);
+    }
+    ~stream() { ajson_sax_stream_destroy(s_); }
+
+    stream(const stream &) = delete;
+    stream &operator=(const stream &) = delete;
+
+    /* As ajson_sax_stream_feed / _finish / _done / _offset */
+    int feed(std::string_view data) { return ajson_sax_stream_feed(s_, data.data(), data.size()); }
+    int finish() { return ajson_sax_stream_finish(s_); }
+    bool done() const { return ajson_sax_stream_done(s_); }
+    size_t offset() const { return ajson_sax_stream_offset(s_); }
+
+    void reset() {
+        ajson_sax_stream_reset(s_);
+        g_.st.handler = root_;
+        g_.st.saved = nullptr;
+    }
+
+private:
+    detail::state_guard g_;
+    H *root_;
+    ajson_sax_stream_t *s_;
+};
+
+} // namespace ajson
+
+#endif /* _ajson_sax_HPP */
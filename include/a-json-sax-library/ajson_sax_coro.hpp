@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _ajson_sax_coro_HPP
+#define _ajson_sax_coro_HPP
+
+/* C++20 coroutine front end for incremental parsing.  A parse runs as a
+ * coroutine that suspends whenever its input runs dry and resumes when the
+ * next piece arrives, so one thread can drive any number of parses from
+ * an event loop:
+ *
+ *   ajson::task<int> t = ajson::async_parse(source, handler);
+ *   ...                  // the event loop resumes it as data arrives
+ *   if (t.done()) rc = t.result();
+ *
+ * 'source.read()' must return an awaitable whose result converts to
+ * std::string_view: the next piece of input, or an empty view at end of
+ * input.  The piece only has to stay valid until the next read.  The
+ * parse itself is ajson::stream (ajson_sax.hpp): handlers and return
+ * codes are as for ajson::sax_parse.
+ *
+ * Tasks start eagerly and run until their first suspension; they can be
+ * co_awaited from other coroutines or polled with done()/result().
+ */
+
+#include "a-json-sax-library/ajson_sax.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace ajson {
+
+template <class T> class task {
+public:
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+
+        task get_return_object() {
+            return task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+
+        /* Hand control to the awaiting coroutine, if any */
+        struct final_awaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                std::coroutine_handle<> c = h.promise().continuation;
+                return c ? c : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        final_awaiter final_suspend() noexcept { return {}; }
+
+        void return_value(T v) { value = std::move(v); }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    task(task &&o) noexcept : h_(std::exchange(o.h_, {})) {}
+    task &operator=(task &&o) noexcept {
+        if (this != &o) {
+            if (h_) h_.destroy();
+            h_ = std::exchange(o.h_, {});
+        }
+        return *this;
+    }
+    ~task() {
+        if (h_) h_.destroy();
+    }
+
+    bool done() const { return h_.done(); }
+
+    /* The co_returned value (rethrows an escaped exception).  done() only. */
+    T result() {
+        if (h_.promise().error) std::rethrow_exception(h_.promise().error);
+        return std::move(*h_.promise().value);
+    }
+
+    bool await_ready() const noexcept { return h_.done(); }
+    void await_suspend(std::coroutine_handle<> c) noexcept { h_.promise().continuation = c; }
+    T await_resume() { return result(); }
+
+private:
+    explicit task(std::coroutine_handle<promise_type> h) : h_(h) {}
+    std::coroutine_handle<promise_type> h_;
+};
+
+/* Parse one document from 'source' into 's'.  Returns 0, -1 on a syntax
+   error or the first non-zero handler result.  Input after the end of the
+   document is not parsed; s.offset() says where it ended. */
+template <class Source, class H>
+task<int> async_parse(Source &source, stream<H> &s) {
+    for (;;) {
+        std::string_view piece = co_await source.read();
+        if (piece.empty()) co_return s.finish();
+        if (int rc = s.feed(piece)) co_return rc;
+        if (s.done()) co_return 0;
+    }
+}
+
+template <class Source, class H>
+task<int> async_parse(Source &source, H &handler, aml_pool_t *pool = nullptr,
+                      unsigned flags = 0) {
+    stream<H> s(handler, pool, flags);
+    co_return co_await async_parse(source, s);
+}
+
+} // namespace ajson
+
+#endif /* _ajson_sax_coro_HPP */
@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _ajson_sax_decompress_H
+#define _ajson_sax_decompress_H
+
+#include "a-json-sax-library/ajson_sax.h"
+#include "a-memory-library/aml_pool.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Parse a compressed document without decompressing it first.
+ *
+ * Each block of output goes straight into the buffer of an
+ * ajson_sax_stream_t (see ajson_sax_stream_reserve) and is parsed before
+ * the next one is produced.  Memory stays at about two blocks plus the
+ * decompressor's window, whatever the size of the document.  Decompression
+ * stops as soon as the document is complete.
+ *
+ * The readers exist when the library is built with the matching CMake
+ * option, which also defines the macro tested below:
+ *   A_WITH_ZLIB -> AJSON_SAX_HAVE_ZLIB (gzip and zlib streams)
+ *   A_WITH_ZSTD -> AJSON_SAX_HAVE_ZSTD
+ *
+ * Results are those of ajson_sax_stream_finish, or one of the errors
+ * below.  The '_fd' forms read a blocking descriptor until end of file.
+ */
+
+/* Decompressed bytes parsed at a time */
+#define AJSON_SAX_DECOMPRESS_BLOCK (64 * 1024)
+
+/* read() failed (errno is kept) */
+#define AJSON_SAX_DECOMPRESS_IO_ERROR (-3)
+/* Corrupt or truncated compressed data */
+#define AJSON_SAX_DECOMPRESS_ERROR (-4)
+
+#ifdef AJSON_SAX_HAVE_ZLIB
+/** gzip (including concatenated members) or zlib-wrapped input. */
+int ajson_sax_parse_gzip(const void *data, size_t len,
+                         const ajson_sax_cb_t *initial_cb, aml_pool_t *pool,
+                         void *ctx, unsigned flags);
+int ajson_sax_parse_gzip_fd(int fd,
+                            const ajson_sax_cb_t *initial_cb, aml_pool_t *pool,
+                            void *ctx, unsigned flags);
+#endif
+
+#ifdef AJSON_SAX_HAVE_ZSTD
+/** zstd input, one or more frames. */
+int ajson_sax_parse_zstd(const void *data, size_t len,
+                         const ajson_sax_cb_t *initial_cb, aml_pool_t *pool,
+                         void *ctx, unsigned flags);
+int ajson_sax_parse_zstd_fd(int fd,
+                            const ajson_sax_cb_t *initial_cb, aml_pool_t *pool,
+                            void *ctx, unsigned flags);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ajson_sax_decompress_H */
@@ -0,0 +1,824 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _ajson_sax_impl_H
+#define _ajson_sax_impl_H
+
+/* The SAX state machine as an always-inline template, for building parsers
+ * specialized to a fixed handler table:
+ *
+ *   static int on_number(void *ctx, ajson_sax_t *sax, const char *v, size_t len) { ... }
+ *   static const ajson_sax_cb_t my_handlers = { .on_number = on_number };
+ *   AJSON_SAX_DEFINE_PARSER(my_parse, my_handlers)
+ *
+ *   rc = my_parse(p, ep, pool, ctx, &error_at);
+ *
+ * Handlers missing from the table cost nothing and present ones are called
+ * directly (and usually inlined) rather than through a function pointer.
+ * Handlers pushed at run time with ajson_sax_push still work; they are
+ * dispatched dynamically as in ajson_sax_parse.
+ */
+
+#include "a-json-sax-library/ajson_sax.h"
+#include "a-json-sax-library/ajson_string_utils.h"
+#include "a-json-sax-library/ajson_scan.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Library internals used by the instrumented (stats) path. */
+uint64_t ajson_sax_clock_ns(void);
+void ajson_sax_stats_track(ajson_sax_stats_t *stats,
+                           const sax_handler_node_t *before,
+                           const sax_handler_node_t *after);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* Internal Parser Stack Constants */
+#define SAX_MODE_ROOT   0
+#define SAX_MODE_OBJECT 1
+#define SAX_MODE_ARRAY  2
+
+/* Max depth for the internal syntax stack (on C stack). */
+#define AJSON_SAX_MAX_STACK_DEPTH 512
+
+/* Case Macros for Tokenization */
+#define AJSON_NATURAL_NUMBER_CASE                                            \
+  '1' : case '2' : case '3' : case '4' : case '5' : case '6' : case '7'        \
+      : case '8' : case '9'
+
+#define AJSON_SPACE_CASE 32 : case 9 : case 13 : case 10
+
+/* Where a suspended parse continues (ajson_sax_resume_t.state) */
+#define AJSON_SAX_RESUME_START       0  /* Nothing parsed yet */
+#define AJSON_SAX_RESUME_KEY         1  /* Expecting a key or '}' */
+#define AJSON_SAX_RESUME_COLON       2  /* Key delivered, expecting ':' */
+#define AJSON_SAX_RESUME_KEYED_VALUE 3  /* Expecting a member value */
+#define AJSON_SAX_RESUME_AFTER_KEYED 4  /* Expecting ',' or '}' */
+#define AJSON_SAX_RESUME_VALUE       5  /* Expecting an array element or ']' */
+#define AJSON_SAX_RESUME_AFTER_VALUE 6  /* Expecting ',' or ']' */
+#define AJSON_SAX_RESUME_NEXT        7  /* A container just closed */
+#define AJSON_SAX_RESUME_DONE        8  /* Finished (or failed) */
+
+/* Parser state carried between calls by the resumable parser.  Before the
+   first call zero it.  A call that runs out of input before the document
+   ends (and 'final' is not set) returns 0 with 'state' naming where to
+   continue and 'consumed' at the start of the unfinished token; call again
+   with the input from there on, extended.  Callbacks have seen everything
+   before 'consumed', and nothing after it.  'token_scanned' says how much
+   of the unfinished token has already been scanned; the next call carries
+   on from there instead of scanning it again. */
+typedef struct {
+    int state;
+    bool final;               /* No more input follows: end means end */
+    bool after_comma;
+    int stack_depth;
+    size_t consumed;          /* Out: bytes of this call's input used up */
+    size_t token_scanned;     /* Bytes from 'consumed' known to be fine */
+    ajson_sax_t sax;
+    unsigned char stack[AJSON_SAX_MAX_STACK_DEPTH];
+} ajson_sax_resume_t;
+
+/* The parser template.  Callers pass constant 'flags', 'stats' and
+   'static_cb', so the compiler inlines a specialized copy and drops the
+   option checks, the instrumentation (stats == NULL) and, with static
+   handlers, the checks for missing callbacks.
+
+   'static_cb', if not NULL, must point at a constant handler table equal
+   to *initial_cb.  It is used whenever nothing has been pushed with
+   ajson_sax_push (sax.top == NULL), so its callbacks are called directly
+   and can be inlined.  Pushed handlers are always called through sax.cb.
+
+   'resume', if not NULL, makes the parse resumable (see
+   ajson_sax_resume_t): running out of input mid-document suspends instead
+   of failing.  [p, ep) must be followed by a NUL byte at ep. */
+static inline __attribute__((always_inline)) int ajson_sax_parse_impl(
+                    char *p, char *ep,
+                    const ajson_sax_cb_t *initial_cb,
+                    aml_pool_t *pool,
+                    void *ctx,
+                    char **error_at,
+                    unsigned flags,
+                    ajson_sax_stats_t *stats,
+                    const ajson_sax_cb_t *static_cb,
+                    ajson_sax_resume_t *resume) {
+
+    const bool destructive = (flags & AJSON_SAX_DESTRUCTIVE) != 0;
+    const bool decode = (flags & AJSON_SAX_DECODE_STRINGS) != 0;
+    const bool validate = (flags & AJSON_SAX_VALIDATE_UTF8) != 0;
+    const bool timing = stats && (flags & AJSON_SAX_TIME_CALLBACKS) != 0;
+    char *const start = p;
+
+    /* --- Context Setup --- */
+    ajson_sax_t sax;
+    if (resume && resume->state) {
+        sax = resume->sax;
+    } else {
+        sax.cb = *initial_cb;
+        sax.pool = pool;
+        sax.top = NULL;
+        sax.current_depth = 0;
+        sax.anchor_depth = 0;
+        sax.has_escapes = false;
+    }
+
+    /* --- Internal Syntax Stack (On Stack, or kept in 'resume') --- */
+    unsigned char local_stack[AJSON_SAX_MAX_STACK_DEPTH];
+    unsigned char *stack = resume ? resume->stack : local_stack;
+    int stack_depth = 0;
+    stack[0] = SAX_MODE_ROOT;
+
+    /* Stack Helper Macros */
+    #define SYNTAX_PUSH(mode) do { \
+        if (stack_depth >= AJSON_SAX_MAX_STACK_DEPTH - 1) SAX_RETURN(-1); \
+        stack[++stack_depth] = (mode); \
+        sax.current_depth++; \
+        if (stats && sax.current_depth > stats->max_depth) \
+            stats->max_depth = sax.current_depth; \
+    } while(0)
+
+    #define SYNTAX_POP() do { \
+        if (stack_depth > 0) stack_depth--; \
+        sax.current_depth--; \
+    } while(0)
+
+    #define CURRENT_MODE() (stack[stack_depth])
+
+    /* Callback Helper Macros */
+    int rc = 0;
+
+    /* Statistics helpers (no-ops unless 'stats' is set) */
+    #define STAT(expr) do { if (stats) stats->expr; } while(0)
+
+    #define SAX_RETURN(v) do { \
+        STAT(bytes = (size_t)(p - start)); \
+        if (resume) { \
+            resume->state = AJSON_SAX_RESUME_DONE; \
+            resume->consumed = (size_t)(p - start); \
+        } \
+        return (v); \
+    } while(0)
+
+    /* Resumable parsing: out of input, so save the state and return 0,
+       to continue at 'where' with the token that starts at 'at', of which
+       'scanned' bytes have been checked. */
+    #define SAX_SUSPEND_AT(where, at, scanned) do { \
+        if (resume && !resume->final) { \
+            resume->state = (where); \
+            resume->after_comma = after_comma; \
+            resume->stack_depth = stack_depth; \
+            resume->sax = sax; \
+            resume->consumed = (size_t)((at) - start); \
+            resume->token_scanned = (scanned); \
+            return 0; \
+        } \
+    } while(0)
+
+    #define SAX_SUSPEND(where, at) SAX_SUSPEND_AT(where, at, 0)
+
+    /* Inside the string that opened at stringp - 1, scanned up to p */
+    #define SAX_SUSPEND_STRING(where) \
+        SAX_SUSPEND_AT(where, stringp - 1, (size_t)(p - (stringp - 1)))
+
+    #define NEED_INPUT(where) if (p >= ep) { \
+        SAX_SUSPEND(where, p); \
+        SAX_ERROR; \
+    }
+
+    /* The number starting at p - 1 may continue past ep.  The number a
+       resumed call starts with has been checked up to 'resume_from'. */
+    #define NEED_NUMBER(where) do { \
+        if (resume && !resume->final) { \
+            const char *nq = resume_from && p - 1 == start ? resume_from : p; \
+            while (nq < ep && ((*nq >= '0' && *nq <= '9') || *nq == '.' || \
+                               *nq == 'e' || *nq == 'E' || *nq == '+' || *nq == '-')) nq++; \
+            if (nq >= ep) SAX_SUSPEND_AT(where, p - 1, (size_t)(ep - (p - 1))); \
+        } \
+    } while(0)
+
+    #define NEED_LITERAL(n, where) if (p + (n) > ep) { \
+        SAX_SUSPEND(where, p - 1); \
+        SAX_ERROR; \
+    }
+
+    #define SAX_ERROR { \
+        if (error_at) *error_at = p; \
+        SAX_RETURN(-1); \
+    }
+
+    #define CHECK_CB(x) if ((rc = (x))) { \
+        if (error_at) *error_at = p; \
+        SAX_RETURN(rc); \
+    }
+
+    /* Call 'fn' with the parenthesized 'args'.  With stats, also time it
+       and note any handler pushes/pops it performed. */
+    #define INVOKE_CB(fn, args) do { \
+        if (!stats) { \
+            CHECK_CB(fn args); \
+        } else { \
+            sax_handler_node_t *top_before = sax.top; \
+            uint64_t t0 = timing ? ajson_sax_clock_ns() : 0; \
+            int cb_rc = fn args; \
+            if (timing) stats->callback_ns += ajson_sax_clock_ns() - t0; \
+            if (sax.top != top_before) ajson_sax_stats_track(stats, top_before, sax.top); \
+            CHECK_CB(cb_rc); \
+        } \
+    } while(0)
+
+    /* Call the active 'on_x' handler, if any */
+    #define STATIC_HANDLERS() (static_cb && !sax.top)
+
+    #define CALL_CB(on_x, args) do { \
+        if (STATIC_HANDLERS()) { \
+            if (static_cb->on_x) INVOKE_CB(static_cb->on_x, args); \
+        } else if (sax.cb.on_x) { \
+            INVOKE_CB(sax.cb.on_x, args); \
+        } \
+    } while(0)
+
+    /* Advance p to the closing quote of the string starting at stringp,
+       noting whether any escapes were seen on the way.  When validating,
+       the same scan also stops on control and non-ASCII bytes; p is left
+       on the offending byte if anything is malformed.  A resumable parse
+       that reaches ep suspends at 'where', before the opening quote, and
+       comes back in at 'again' with p where the scan stopped (never inside
+       an escape or a UTF-8 sequence). */
+    #define SCAN_STRING(where, again) do { \
+        sax.has_escapes = false; \
+    again:; \
+        if (!validate) { \
+            for (;;) { \
+                p = (char *)ajson_scan_string(p, ep); \
+                if (p >= ep) { \
+                    p = ep; \
+                    SAX_SUSPEND_STRING(where); \
+                    SAX_ERROR; \
+                } \
+                if (*p == '\"') break; \
+                sax.has_escapes = true; \
+                if (ep - p < 2) { \
+                    SAX_SUSPEND_STRING(where); \
+                    p = ep; \
+                    SAX_ERROR; \
+                } \
+                p += 2; /* Skip the escaped byte */ \
+            } \
+        } else { \
+            for (;;) { \
+                p = (char *)ajson_scan_string_strict(p, ep); \
+                if (p >= ep) { \
+                    p = ep; \
+                    SAX_SUSPEND_STRING(where); \
+                    SAX_ERROR; \
+                } \
+                unsigned char sc = (unsigned char)*p; \
+                if (sc == '\"') break; \
+                int sn; \
+                if (sc == '\\') { \
+                    sax.has_escapes = true; \
+                    sn = ajson_escape_length(p, ep); \
+                } else if (sc < 0x20) { \
+                    sn = 0; \
+                } else { \
+                    sn = ajson_utf8_sequence_length((const unsigned char *)p, \
+                                                    (const unsigned char *)ep); \
+                } \
+                if (!sn) { \
+                    /* A sequence cut short by ep may be completed later */ \
+                    if (ep - p < 12) SAX_SUSPEND_STRING(where); \
+                    SAX_ERROR; \
+                } \
+                p += sn; \
+            } \
+        } \
+        if (stats) { \
+            size_t slen = (size_t)(p - stringp); \
+            if (slen > stats->longest_string) stats->longest_string = slen; \
+            if (sax.has_escapes) stats->escaped_strings++; \
+        } \
+    } while(0)
+
+    /* Hand [stringp, p) to a string callback (p is NUL-terminated),
+       decoding escapes first when AJSON_SAX_DECODE_STRINGS is set. */
+    #define EMIT_STRING_TO(fn) do { \
+        char *sv = stringp; \
+        size_t sl = p - stringp; \
+        if (decode && sax.has_escapes) { \
+            if (destructive) sl = ajson_decode_inplace(sv, sl); \
+            else sv = ajson_decode2(&sl, sax.pool, sv, sl); \
+        } \
+        INVOKE_CB(fn, (ctx, &sax, sv, sl)); \
+    } while(0)
+
+    #define EMIT_STRING(on_x) do { \
+        if (STATIC_HANDLERS()) { \
+            if (static_cb->on_x) EMIT_STRING_TO(static_cb->on_x); \
+        } else if (sax.cb.on_x) { \
+            EMIT_STRING_TO(sax.cb.on_x); \
+        } \
+    } while(0)
+
+    /* --- Parsing Variables --- */
+    char ch;
+    char *stringp = NULL;
+    char *resume_from = NULL;
+    bool after_comma = false;
+
+    if (resume && resume->state) {
+        after_comma = resume->after_comma;
+        stack_depth = resume->stack_depth;
+        ch = *p;
+        if (resume->token_scanned) {
+            /* Carry on inside the token the last call stopped in */
+            resume_from = p + resume->token_scanned;
+            if (ch == '\"') {
+                stringp = p + 1;
+                p = resume_from;
+                switch (resume->state) {
+                case AJSON_SAX_RESUME_KEY:         goto key_again;
+                case AJSON_SAX_RESUME_KEYED_VALUE: goto keyed_string_again;
+                default:                           goto string_again;
+                }
+            }
+        }
+        switch (resume->state) {
+        case AJSON_SAX_RESUME_KEY:         goto start_key;
+        case AJSON_SAX_RESUME_COLON:       goto key_colon;
+        case AJSON_SAX_RESUME_KEYED_VALUE: goto start_key_object;
+        case AJSON_SAX_RESUME_AFTER_KEYED: goto look_for_key;
+        case AJSON_SAX_RESUME_VALUE:       goto start_value;
+        case AJSON_SAX_RESUME_AFTER_VALUE: goto look_for_next_object;
+        case AJSON_SAX_RESUME_NEXT:        goto determine_next_step;
+        default:                           SAX_ERROR;
+        }
+    }
+
+    NEED_INPUT(AJSON_SAX_RESUME_VALUE);
+
+    /* Jump into the state machine */
+    goto start_value;
+
+start_key:;
+    NEED_INPUT(AJSON_SAX_RESUME_KEY);
+    ch = *p++;
+    switch (ch) {
+    case '\"':
+        after_comma = false;
+        stringp = p;
+        goto get_end_of_key;
+    case AJSON_SPACE_CASE:
+        goto start_key;
+    case '}':
+        if (after_comma) SAX_ERROR;
+        CALL_CB(on_end_object, (ctx, &sax));
+        SYNTAX_POP();
+        goto determine_next_step;
+    default:
+        SAX_ERROR;
+    };
+
+get_end_of_key:;
+    SCAN_STRING(AJSON_SAX_RESUME_KEY, key_again);
+    *p = 0;
+    STAT(keys++);
+    EMIT_STRING(on_key);
+
+    if (!destructive) {
+        *p = '\"'; /* Restore closing quote */
+    }
+    p++;
+
+key_colon:;
+    while (p < ep && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+    NEED_INPUT(AJSON_SAX_RESUME_COLON);
+    if (*p != ':') SAX_ERROR;
+    p++;
+
+start_key_object:;
+    NEED_INPUT(AJSON_SAX_RESUME_KEYED_VALUE);
+    ch = *p++;
+    switch (ch) {
+    case '\"':
+        stringp = p;
+        goto keyed_start_string;
+    case AJSON_SPACE_CASE:
+        goto start_key_object;
+    case '{':
+        STAT(objects++); CALL_CB(on_start_object, (ctx, &sax));
+        SYNTAX_PUSH(SAX_MODE_OBJECT);
+        goto start_key;
+    case '[':
+        STAT(arrays++); CALL_CB(on_start_array, (ctx, &sax));
+        SYNTAX_PUSH(SAX_MODE_ARRAY);
+        goto start_value;
+    case '-':
+        NEED_NUMBER(AJSON_SAX_RESUME_KEYED_VALUE);
+        stringp = p - 1;
+        ch = *p++;
+        if (ch == '0') {
+            char la = *p;
+            if (la == '.') { p++; goto keyed_decimal_number; }
+            if (la == 'e' || la == 'E') { goto keyed_next_digit; }
+            if (la >= '0' && la <= '9') { SAX_ERROR; }
+            /* -0 */
+            STAT(numbers++); CALL_CB(on_number, (ctx, &sax, "-0", 2));
+            goto look_for_key;
+        } else if (ch >= '1' && ch <= '9') {
+            goto keyed_next_digit;
+        } else {
+            SAX_ERROR;
+        }
+    case '0': {
+        NEED_NUMBER(AJSON_SAX_RESUME_KEYED_VALUE);
+        stringp = p - 1;
+        if (p < ep) {
+            char la = *p;
+            if (la == '.') { p++; goto keyed_decimal_number; }
+            if (la == 'e' || la == 'E') { goto keyed_next_digit; }
+            if (la >= '0' && la <= '9') { SAX_ERROR; }
+        }
+        STAT(numbers++); CALL_CB(on_number, (ctx, &sax, "0", 1));
+        ch = *p;
+        goto look_for_key;
+    }
+    case AJSON_NATURAL_NUMBER_CASE:
+        NEED_NUMBER(AJSON_SAX_RESUME_KEYED_VALUE);
+        stringp = p - 1;
+        goto keyed_next_digit;
+    case 't':
+        NEED_LITERAL(3, AJSON_SAX_RESUME_KEYED_VALUE);
+        if (*p++ != 'r') SAX_ERROR;
+        if (*p++ != 'u') SAX_ERROR;
+        if (*p++ != 'e') SAX_ERROR;
+        STAT(bools++); CALL_CB(on_bool, (ctx, &sax, true));
+        ch = *p;
+        goto look_for_key;
+    case 'f':
+        NEED_LITERAL(4, AJSON_SAX_RESUME_KEYED_VALUE);
+        if (*p++ != 'a') SAX_ERROR;
+        if (*p++ != 'l') SAX_ERROR;
+        if (*p++ != 's') SAX_ERROR;
+        if (*p++ != 'e') SAX_ERROR;
+        STAT(bools++); CALL_CB(on_bool, (ctx, &sax, false));
+        ch = *p;
+        goto look_for_key;
+    case 'n':
+        NEED_LITERAL(3, AJSON_SAX_RESUME_KEYED_VALUE);
+        if (*p++ != 'u') SAX_ERROR;
+        if (*p++ != 'l') SAX_ERROR;
+        if (*p++ != 'l') SAX_ERROR;
+        STAT(nulls++); CALL_CB(on_null, (ctx, &sax));
+        ch = *p;
+        goto look_for_key;
+    default:
+        SAX_ERROR;
+    };
+
+keyed_start_string:;
+    SCAN_STRING(AJSON_SAX_RESUME_KEYED_VALUE, keyed_string_again);
+    *p = 0;
+    STAT(strings++);
+    EMIT_STRING(on_string);
+
+    if (!destructive) {
+        *p = '\"'; /* Restore closing quote */
+    }
+    p++;
+    ch = *p;
+
+look_for_key:;
+    switch (ch) {
+    case ',':
+        if (p >= ep) SAX_ERROR;
+        p++;
+        after_comma = true;
+        goto start_key;
+    case '}':
+        if (after_comma) SAX_ERROR;
+        CALL_CB(on_end_object, (ctx, &sax));
+        SYNTAX_POP();
+        p++;
+        goto determine_next_step;
+    case AJSON_SPACE_CASE:
+        p++;
+        ch = *p;
+        goto look_for_key;
+    case 0:
+        if (p >= ep) SAX_SUSPEND(AJSON_SAX_RESUME_AFTER_KEYED, p);
+        SAX_ERROR;
+    default:
+        SAX_ERROR;
+    };
+
+keyed_next_digit:;
+    ch = *p++;
+    while ((ch >= '0' && ch <= '9')) ch = *p++;
+
+    if (ch == '.') goto keyed_decimal_number;
+    if (ch == 'e' || ch == 'E') {
+        ch = *p++;
+        if (ch == '+' || ch == '-') ch = *p++;
+        if (ch < '0' || ch > '9') SAX_ERROR;
+        while (ch >= '0' && ch <= '9') ch = *p++;
+    }
+    p--; *p = 0;
+    STAT(numbers++); CALL_CB(on_number, (ctx, &sax, stringp, p - stringp));
+
+    if (!destructive) {
+        *p = ch; /* Restore delimiter */
+    }
+    goto look_for_key;
+
+keyed_decimal_number:;
+    ch = *p++;
+    if (ch < '0' || ch > '9') SAX_ERROR;
+    while (ch >= '0' && ch <= '9') ch = *p++;
+
+    if (ch == 'e' || ch == 'E') {
+        ch = *p++;
+        if (ch == '+' || ch == '-') ch = *p++;
+        if (ch < '0' || ch > '9') SAX_ERROR;
+        while (ch >= '0' && ch <= '9') ch = *p++;
+    }
+    p--; *p = 0;
+    STAT(numbers++); CALL_CB(on_number, (ctx, &sax, stringp, p - stringp));
+
+    if (!destructive) {
+        *p = ch; /* Restore delimiter */
+    }
+    goto look_for_key;
+
+start_value:;
+    NEED_INPUT(AJSON_SAX_RESUME_VALUE);
+    ch = *p++;
+    switch (ch) {
+    case '\"':
+        after_comma = false;
+        stringp = p;
+        goto start_string;
+    case AJSON_SPACE_CASE:
+        goto start_value;
+    case '{':
+        after_comma = false;
+        STAT(objects++); CALL_CB(on_start_object, (ctx, &sax));
+        SYNTAX_PUSH(SAX_MODE_OBJECT);
+        goto start_key;
+    case '[':
+        after_comma = false;
+        STAT(arrays++); CALL_CB(on_start_array, (ctx, &sax));
+        SYNTAX_PUSH(SAX_MODE_ARRAY);
+        goto start_value;
+    case ']':
+        if (after_comma || stack_depth == 0) SAX_ERROR;
+        CALL_CB(on_end_array, (ctx, &sax));
+        SYNTAX_POP();
+        goto determine_next_step;
+    case '-':
+        NEED_NUMBER(AJSON_SAX_RESUME_VALUE);
+        after_comma = false;
+        stringp = p - 1;
+        ch = *p++;
+        if (ch == '0') {
+            char la = *p;
+            if (la == '.') { p++; goto decimal_number; }
+            if (la == 'e' || la == 'E') { goto next_digit; }
+            if (la >= '0' && la <= '9') SAX_ERROR;
+            /* -0 */
+            STAT(numbers++); CALL_CB(on_number, (ctx, &sax, "-0", 2));
+            ch = *p;
+            goto add_number;
+        } else if (ch >= '1' && ch <= '9') {
+            goto next_digit;
+        } else {
+            SAX_ERROR;
+        }
+    case '0': {
+        NEED_NUMBER(AJSON_SAX_RESUME_VALUE);
+        after_comma = false;
+        stringp = p - 1;
+        if (p < ep) {
+            char la = *p;
+            if (la == '.') { p++; goto decimal_number; }
+            if (la == 'e' || la == 'E') { goto next_digit; }
+            if (la >= '0' && la <= '9') { SAX_ERROR; }
+        }
+        STAT(numbers++); CALL_CB(on_number, (ctx, &sax, "0", 1));
+        ch = *p;
+        goto add_number;
+    }
+    case AJSON_NATURAL_NUMBER_CASE:
+        NEED_NUMBER(AJSON_SAX_RESUME_VALUE);
+        after_comma = false;
+        stringp = p - 1;
+        goto next_digit;
+    case 't':
+        after_comma = false;
+        NEED_LITERAL(3, AJSON_SAX_RESUME_VALUE);
+        if (*p++ != 'r') SAX_ERROR;
+        if (*p++ != 'u') SAX_ERROR;
+        if (*p++ != 'e') SAX_ERROR;
+        STAT(bools++); CALL_CB(on_bool, (ctx, &sax, true));
+        ch = *p;
+        goto add_string;
+    case 'f':
+        after_comma = false;
+        NEED_LITERAL(4, AJSON_SAX_RESUME_VALUE);
+        if (*p++ != 'a') SAX_ERROR;
+        if (*p++ != 'l') SAX_ERROR;
+        if (*p++ != 's') SAX_ERROR;
+        if (*p++ != 'e') SAX_ERROR;
+        STAT(bools++); CALL_CB(on_bool, (ctx, &sax, false));
+        ch = *p;
+        goto add_string;
+    case 'n':
+        after_comma = false;
+        NEED_LITERAL(3, AJSON_SAX_RESUME_VALUE);
+        if (*p++ != 'u') SAX_ERROR;
+        if (*p++ != 'l') SAX_ERROR;
+        if (*p++ != 'l') SAX_ERROR;
+        STAT(nulls++); CALL_CB(on_null, (ctx, &sax));
+        ch = *p;
+        goto add_string;
+    default:
+        SAX_ERROR;
+    };
+
+start_string:;
+    SCAN_STRING(AJSON_SAX_RESUME_VALUE, string_again);
+    *p = 0;
+    STAT(strings++);
+    EMIT_STRING(on_string);
+
+    if (!destructive) {
+        *p = '\"'; /* Restore closing quote */
+    }
+    p++;
+    ch = *p;
+
+add_string:;
+    /* A root scalar ends at its last byte, like a root container */
+    if (stack_depth == 0) goto root_done;
+    goto look_for_next_object;
+
+add_number:;
+    /* A root number needs whitespace (or the end) to tell where it stops */
+    if (stack_depth == 0) {
+        switch (ch) {
+        case AJSON_SPACE_CASE:
+            if (!resume) p++; /* May hold the NUL that ended the number */
+            goto root_done;
+        case 0:
+            goto root_done;
+        default:
+            SAX_ERROR;
+        }
+    }
+    goto look_for_next_object;
+
+look_for_next_object:;
+    switch (ch) {
+    case ',':
+        if (p >= ep) SAX_ERROR;
+        p++;
+        after_comma = true;
+        goto start_value;
+    case ']':
+        if (after_comma) SAX_ERROR;
+        CALL_CB(on_end_array, (ctx, &sax));
+        SYNTAX_POP();
+        p++;
+        goto determine_next_step;
+    case AJSON_SPACE_CASE:
+        p++;
+        if (p >= ep) {
+            if (stack_depth == 0) SAX_RETURN(0);
+            SAX_SUSPEND(AJSON_SAX_RESUME_AFTER_VALUE, p);
+            SAX_ERROR;
+        }
+        ch = *p;
+        goto look_for_next_object;
+    case 0:
+        if (stack_depth == 0) SAX_RETURN(0);
+        if (p >= ep) SAX_SUSPEND(AJSON_SAX_RESUME_AFTER_VALUE, p);
+        SAX_ERROR;
+    default:
+        SAX_ERROR;
+    };
+
+next_digit:;
+    ch = *p++;
+    while ((ch >= '0' && ch <= '9')) ch = *p++;
+
+    if (ch == '.') goto decimal_number;
+    if (ch == 'e' || ch == 'E') {
+        ch = *p++;
+        if (ch == '+' || ch == '-') ch = *p++;
+        if (ch < '0' || ch > '9') SAX_ERROR;
+        while (ch >= '0' && ch <= '9') ch = *p++;
+    }
+    p--; *p = 0;
+    STAT(numbers++); CALL_CB(on_number, (ctx, &sax, stringp, p - stringp));
+
+    if (!destructive) {
+        *p = ch; /* Restore delimiter */
+    }
+    goto add_number;
+
+decimal_number:;
+    ch = *p++;
+    if (ch < '0' || ch > '9') SAX_ERROR;
+    while (ch >= '0' && ch <= '9') ch = *p++;
+
+    if (ch == 'e' || ch == 'E') {
+        ch = *p++;
+        if (ch == '+' || ch == '-') ch = *p++;
+        if (ch < '0' || ch > '9') SAX_ERROR;
+        while (ch >= '0' && ch <= '9') ch = *p++;
+    }
+    p--; *p = 0;
+    STAT(numbers++); CALL_CB(on_number, (ctx, &sax, stringp, p - stringp));
+
+    if (!destructive) {
+        *p = ch; /* Restore delimiter */
+    }
+    goto add_number;
+
+determine_next_step:
+    if (stack_depth == 0) goto root_done;
+
+    if (p >= ep) {
+        SAX_SUSPEND(AJSON_SAX_RESUME_NEXT, p);
+        SAX_ERROR; /* Unclosed containers at the end */
+    }
+    ch = *p;
+
+    if (CURRENT_MODE() == SAX_MODE_OBJECT) {
+        goto look_for_key;
+    } else {
+        goto look_for_next_object;
+    }
+
+    SAX_ERROR;
+
+root_done:;
+    /* A resumable parse ends the document at its last byte.  A one-shot
+       parse was given the whole document, so only whitespace may follow. */
+    if (!resume) {
+        for (; p < ep; p++) {
+            switch (*p) {
+            case AJSON_SPACE_CASE:
+                break;
+            default:
+                SAX_ERROR;
+            }
+        }
+    }
+    SAX_RETURN(0);
+}
+
+/* Keep the template's helper macros out of the including file */
+#undef SAX_MODE_ROOT
+#undef SAX_MODE_OBJECT
+#undef SAX_MODE_ARRAY
+#undef SYNTAX_PUSH
+#undef SYNTAX_POP
+#undef CURRENT_MODE
+#undef STAT
+#undef SAX_RETURN
+#undef SAX_ERROR
+#undef SAX_SUSPEND
+#undef SAX_SUSPEND_AT
+#undef SAX_SUSPEND_STRING
+#undef NEED_INPUT
+#undef NEED_NUMBER
+#undef NEED_LITERAL
+#undef CHECK_CB
+#undef INVOKE_CB
+#undef STATIC_HANDLERS
+#undef CALL_CB
+#undef SCAN_STRING
+#undef EMIT_STRING_TO
+#undef EMIT_STRING
+
+/* * Define 'static int name(char *p, char *ep, aml_pool_t *pool, void *ctx,
+ * char **error_at)': ajson_sax_parse_ex specialized for 'handlers', a
+ * 'static const ajson_sax_cb_t' visible at this point, and the AJSON_SAX_*
+ * option 'flags'.  Return values match ajson_sax_parse.
+ */
+#define AJSON_SAX_DEFINE_PARSER_EX(name, handlers, flags)                      \
+    static int name(char *p, char *ep, aml_pool_t *pool, void *ctx,            \
+                    char **error_at) {                                         \
+        return ajson_sax_parse_impl(p, ep, &(handlers), pool, ctx, error_at,   \
+                                    (flags), NULL, &(handlers), NULL);         \
+    }
+
+#define AJSON_SAX_DEFINE_PARSER(name, handlers)                                \
+    AJSON_SAX_DEFINE_PARSER_EX(name, handlers, 0)
+
+#endif /* _ajson_sax_impl_H */
@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _ajson_sax_ingest_H
+#define _ajson_sax_ingest_H
+
+#include "a-json-sax-library/ajson_sax.h"
+#include "a-memory-library/aml_pool.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Parse a list of files (one JSON document each) with the reads running
+ * ahead of the parser.
+ *
+ * Files are read in order in 'buffer_size' pieces into a ring of
+ * 'queue_depth' aligned buffers.  Up to 'queue_depth' reads are in flight
+ * at once, crossing into the next files, while the parser works on the
+ * oldest piece through an ajson_sax_stream_t.  Reads go through io_uring
+ * on Linux; where it is missing or not permitted (older kernels, seccomp
+ * filters) a small pool of threads issuing pread() takes its place.
+ *
+ * Bytes after the end of a file's document are ignored, as in
+ * ajson_sax_stream_feed.
+ */
+
+/* Per-file result when a file cannot be opened or read (errno is kept) */
+#define AJSON_SAX_INGEST_IO_ERROR (-3)
+
+/* ajson_sax_ingest_options_t.flags */
+#define AJSON_SAX_INGEST_NO_URING 0x01  /* Always use the thread pool */
+#define AJSON_SAX_INGEST_DIRECT   0x02  /* O_DIRECT where the file system allows it */
+
+typedef struct {
+    unsigned queue_depth;   /* Buffers in the ring (default 8) */
+    size_t buffer_size;     /* Bytes per read, rounded up to 4 KiB (default 1 MiB) */
+    unsigned threads;       /* Thread pool size (default queue_depth) */
+    unsigned flags;         /* AJSON_SAX_INGEST_* */
+} ajson_sax_ingest_options_t;
+
+/* Called around each file (either may be NULL).  on_begin_file returns the
+ * 'ctx' handed to that file's SAX callbacks (NULL if it is missing).
+ * on_end_file receives the file's result: 0, -1 for a syntax error, a
+ * handler's non-zero result or AJSON_SAX_INGEST_IO_ERROR.  It is the place
+ * to clear the pool between files.  A non-zero return stops the run. */
+typedef struct {
+    void *(*on_begin_file)(void *arg, size_t index, const char *path);
+    int (*on_end_file)(void *arg, size_t index, const char *path, void *ctx, int rc);
+} ajson_sax_ingest_file_cb_t;
+
+/** Parse 'num_paths' files.  'pool' and 'flags' are passed to each file's
+ * stream parser; 'options' may be NULL for the defaults.  Returns 0 once
+ * every file has been parsed, or the first non-zero on_end_file result
+ * (without on_end_file, the first failing file's result). */
+int ajson_sax_ingest(const char *const *paths, size_t num_paths,
+                     const ajson_sax_cb_t *initial_cb,
+                     const ajson_sax_ingest_file_cb_t *file_cb, void *arg,
+                     aml_pool_t *pool, unsigned flags,
+                     const ajson_sax_ingest_options_t *options);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ajson_sax_ingest_H */
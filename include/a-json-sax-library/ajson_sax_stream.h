@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _ajson_sax_stream_H
+#define _ajson_sax_stream_H
+
+#include "a-json-sax-library/ajson_sax.h"
+#include "a-memory-library/aml_pool.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Incremental parsing of one JSON document that arrives in pieces.
+ *
+ *   ajson_sax_stream_t *s = ajson_sax_stream_init(&handlers, pool, ctx, 0);
+ *   while (!ajson_sax_stream_done(s) && (n = read(fd, buf, sizeof(buf))) > 0)
+ *       if ((rc = ajson_sax_stream_feed(s, buf, n))) break;
+ *   if (!rc) rc = ajson_sax_stream_finish(s);
+ *   ajson_sax_stream_destroy(s);
+ *
+ * The parser state is kept between calls, so each byte is parsed once.
+ * A token cut off by the end of a piece is kept in the buffer until it is
+ * complete.  Its scan picks up where the last piece ended, so a long
+ * string fed in small pieces still costs time linear in its length.
+ * Callbacks fire as soon as their token is complete, with the same
+ * arguments as ajson_sax_parse_ex.  Keys and strings point into the
+ * stream's buffer and are valid only during the callback (also with
+ * AJSON_SAX_DESTRUCTIVE, which here just selects in-place decoding).
+ */
+
+typedef struct ajson_sax_stream_s ajson_sax_stream_t;
+
+/** Create a stream parser.  'pool' serves the handler stack and string
+ * decoding as in ajson_sax_parse_ex; 'flags' are AJSON_SAX_* options. */
+ajson_sax_stream_t *ajson_sax_stream_init(const ajson_sax_cb_t *initial_cb,
+                                          aml_pool_t *pool, void *ctx,
+                                          unsigned flags);
+
+/** Parse the next 'len' bytes.  Returns 0 while the input is well formed
+ * (complete or not), -1 on a syntax error or the first non-zero handler
+ * result; errors are sticky.  Once the document is complete the rest of
+ * the input is ignored: see ajson_sax_stream_offset. */
+int ajson_sax_stream_feed(ajson_sax_stream_t *s, const char *data, size_t len);
+
+/** Feed without a copy: returns room for 'len' bytes at the end of the
+ * stream's buffer.  Write the next piece there (a decompressor's output,
+ * say) and pass the number of bytes written to ajson_sax_stream_commit,
+ * which parses them as ajson_sax_stream_feed would.  The pointer is valid
+ * until the commit. */
+char *ajson_sax_stream_reserve(ajson_sax_stream_t *s, size_t len);
+int ajson_sax_stream_commit(ajson_sax_stream_t *s, size_t len);
+
+/** Signal the end of input.  Completes a document that can only end at
+ * end of input (a bare number at the root) and returns -1 if the document
+ * is unfinished.  Otherwise returns what the last feed did. */
+int ajson_sax_stream_finish(ajson_sax_stream_t *s);
+
+/** The document is complete (or parsing failed). */
+bool ajson_sax_stream_done(const ajson_sax_stream_t *s);
+
+/** Offset into the whole input (all feeds) of the end of the document once
+ * done, of the error after a failure, and otherwise of the first byte not
+ * yet handed to a callback. */
+size_t ajson_sax_stream_offset(const ajson_sax_stream_t *s);
+
+/** Drop any buffered input and state to parse a new document. */
+void ajson_sax_stream_reset(ajson_sax_stream_t *s);
+
+void ajson_sax_stream_destroy(ajson_sax_stream_t *s);
+
+/* Reading from a file descriptor (pipe, socket or file).
+ *
+ * Input is read into a ring buffer that is mapped twice, back to back
+ * (a memfd on Linux), so bytes that wrap past the end of the ring are
+ * still contiguous.  The parser runs over the ring in place: callbacks get
+ * pointers straight into it, and nothing is copied or compacted.  Where
+ * the mirror cannot be set up, a plain buffer that is compacted now and
+ * then takes its place.  A single token must fit in the ring; one that
+ * spans many reads is scanned once, not again after every read.
+ *
+ * Bytes read past the end of the document are dropped.
+ */
+
+/* ajson_sax_fd_reader_pump: a non-blocking fd has no data yet */
+#define AJSON_SAX_FD_AGAIN 1
+/* read() failed (errno is kept) */
+#define AJSON_SAX_FD_IO_ERROR (-3)
+/* A token is longer than the ring */
+#define AJSON_SAX_FD_TOO_LONG (-5)
+
+typedef struct ajson_sax_fd_reader_s ajson_sax_fd_reader_t;
+
+/** 'ring_size' is rounded up to whole pages (0 for 1 MiB).  The other
+ * arguments are as for ajson_sax_stream_init. */
+ajson_sax_fd_reader_t *ajson_sax_fd_reader_init(int fd, size_t ring_size,
+                                                const ajson_sax_cb_t *initial_cb,
+                                                aml_pool_t *pool, void *ctx,
+                                                unsigned flags);
+
+/** Read and parse until the document is complete, the fd reports end of
+ * file or, for a non-blocking fd, it has nothing more to give.  Returns
+ * AJSON_SAX_FD_AGAIN in that last case (call again once it is readable),
+ * otherwise the final result: 0, -1, a handler's result or one of the
+ * AJSON_SAX_FD_* errors. */
+int ajson_sax_fd_reader_pump(ajson_sax_fd_reader_t *r);
+
+void ajson_sax_fd_reader_destroy(ajson_sax_fd_reader_t *r);
+
+/** Parse one document from 'fd', waiting with poll() when a non-blocking
+ * fd has no data. */
+int ajson_sax_parse_fd(int fd, size_t ring_size,
+                       const ajson_sax_cb_t *initial_cb,
+                       aml_pool_t *pool, void *ctx, unsigned flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ajson_sax_stream_H */
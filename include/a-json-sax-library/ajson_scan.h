@@ -0,0 +1,311 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+/* Byte-scanning kernels shared by the parser, the string utilities and the
+   writer.  SSE2 is used when the target has it (always on x86-64),
+   otherwise the scans fall back to 8 bytes at a time (SWAR).
+
+   Internal: this header is installed only because ajson_sax_impl.h needs
+   it.  Nothing here is a stable API. */
+
+#ifndef _AJSON_SCAN_H
+#define _AJSON_SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AJSON_SCAN_SSE2 1
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AJSON_CTZ32(x) __builtin_ctz(x)
+#define AJSON_CTZ64(x) __builtin_ctzll(x)
+#define AJSON_LIKELY(x) __builtin_expect(!!(x), 1)
+#define AJSON_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+static inline int AJSON_CTZ32(uint32_t x) { int n = 0; while (!(x & 1)) { x >>= 1; n++; } return n; }
+static inline int AJSON_CTZ64(uint64_t x) { int n = 0; while (!(x & 1)) { x >>= 1; n++; } return n; }
+#define AJSON_LIKELY(x) (x)
+#define AJSON_UNLIKELY(x) (x)
+#endif
+
+/* SWAR helpers (bytes are treated as unsigned).  These only answer
+   "does the word contain a match"; the exact position is found by a short
+   scalar scan since borrows can flag bytes above a true match. */
+#define AJSON_SWAR_ONES  0x0101010101010101ULL
+#define AJSON_SWAR_HIGHS 0x8080808080808080ULL
+#define AJSON_SWAR_HAS_ZERO(x) (((x) - AJSON_SWAR_ONES) & ~(x) & AJSON_SWAR_HIGHS)
+#define AJSON_SWAR_HAS_BYTE(x, b) AJSON_SWAR_HAS_ZERO((x) ^ (AJSON_SWAR_ONES * (uint8_t)(b)))
+#define AJSON_SWAR_HAS_LESS(x, n) (((x) - AJSON_SWAR_ONES * (n)) & ~(x) & AJSON_SWAR_HIGHS)
+
+static inline uint64_t ajson_load64(const char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* Escape table for JSON output.  Zero means the byte is copied as-is,
+   'u' means \u00XX and anything else is the character that follows the
+   backslash. */
+static const unsigned char ajson_escape_table[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0, 0, '\"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '/',
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0
+    /* 0x60 .. 0xFF are all zero */
+};
+
+static const char ajson_hex_upper[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7',
+    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+/* Hex digit values; -1 for anything that is not a hex digit. */
+static const signed char ajson_hex_values[256] = {
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+     0, 1, 2, 3, 4, 5, 6, 7, 8, 9,-1,-1,-1,-1,-1,-1,
+    -1,10,11,12,13,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,10,11,12,13,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+};
+
+/* Reads four hex digits at 's'.  Returns the value or -1. */
+static inline int ajson_hex4(const char *s) {
+    int a = ajson_hex_values[(unsigned char)s[0]];
+    int b = ajson_hex_values[(unsigned char)s[1]];
+    int c = ajson_hex_values[(unsigned char)s[2]];
+    int d = ajson_hex_values[(unsigned char)s[3]];
+    if ((a | b | c | d) < 0) return -1;
+    return (a << 12) | (b << 8) | (c << 4) | d;
+}
+
+/* Writes the escape sequence for 'c' (a byte flagged by ajson_escape_table)
+   at 'wp' and returns the new write position (2 or 6 bytes). */
+static inline char *ajson_write_escape(char *wp, unsigned char c) {
+    unsigned char esc = ajson_escape_table[c];
+    *wp++ = '\\';
+    if (esc == 'u') {
+        *wp++ = 'u';
+        *wp++ = '0';
+        *wp++ = '0';
+        *wp++ = ajson_hex_upper[c >> 4];
+        *wp++ = ajson_hex_upper[c & 15];
+    } else {
+        *wp++ = (char)esc;
+    }
+    return wp;
+}
+
+/* Number of extra bytes needed to escape byte 'c' (0, 1 or 5). */
+static inline size_t ajson_escape_extra(unsigned char c) {
+    unsigned char esc = ajson_escape_table[c];
+    return esc ? (esc == 'u' ? 5 : 1) : 0;
+}
+
+/* Returns the first byte in [p, ep) that must be escaped inside a JSON
+   string ('"', '\\', '/' or a control byte), or ep if there is none. */
+static inline const char *ajson_scan_escape(const char *p, const char *ep) {
+#ifdef AJSON_SCAN_SSE2
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i ctrl = _mm_set1_epi8(0x1F);
+    while (ep - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, bslash)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, slash),
+                         _mm_cmpeq_epi8(_mm_max_epu8(v, ctrl), ctrl)));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(m);
+        if (mask) return p + AJSON_CTZ32(mask);
+        p += 16;
+    }
+#else
+    while (ep - p >= 8) {
+        uint64_t v = ajson_load64(p);
+        if (AJSON_SWAR_HAS_BYTE(v, '\"') | AJSON_SWAR_HAS_BYTE(v, '\\') |
+            AJSON_SWAR_HAS_BYTE(v, '/') | AJSON_SWAR_HAS_LESS(v, 0x20))
+            break;
+        p += 8;
+    }
+#endif
+    while (p < ep && !ajson_escape_table[(unsigned char)*p]) p++;
+    return p;
+}
+
+/* Returns the first '\\' in [p, ep), or ep if there is none. */
+static inline const char *ajson_scan_backslash(const char *p, const char *ep) {
+#ifdef AJSON_SCAN_SSE2
+    const __m128i bslash = _mm_set1_epi8('\\');
+    while (ep - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, bslash));
+        if (mask) return p + AJSON_CTZ32(mask);
+        p += 16;
+    }
+#else
+    while (ep - p >= 8) {
+        if (AJSON_SWAR_HAS_BYTE(ajson_load64(p), '\\')) break;
+        p += 8;
+    }
+#endif
+    while (p < ep && *p != '\\') p++;
+    return p;
+}
+
+/* Returns the first '"' or '\\' in [p, ep), or ep if there is none.
+   This is the inner loop of string scanning in the parser. */
+static inline const char *ajson_scan_string(const char *p, const char *ep) {
+#ifdef AJSON_SCAN_SSE2
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    while (ep - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, bslash));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(m);
+        if (mask) return p + AJSON_CTZ32(mask);
+        p += 16;
+    }
+#else
+    while (ep - p >= 8) {
+        uint64_t v = ajson_load64(p);
+        if (AJSON_SWAR_HAS_BYTE(v, '\"') | AJSON_SWAR_HAS_BYTE(v, '\\')) break;
+        p += 8;
+    }
+#endif
+    while (p < ep && *p != '\"' && *p != '\\') p++;
+    return p;
+}
+
+/* Like ajson_scan_string, but also stops on control bytes (< 0x20) and on
+   any non-ASCII byte so the caller can validate it.  Everything is tested
+   against the same loaded block. */
+static inline const char *ajson_scan_string_strict(const char *p, const char *ep) {
+#ifdef AJSON_SCAN_SSE2
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i ctrl = _mm_set1_epi8(0x1F);
+    while (ep - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, bslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(v, ctrl), ctrl));
+        uint32_t mask = (uint32_t)(_mm_movemask_epi8(m) | _mm_movemask_epi8(v));
+        if (mask) return p + AJSON_CTZ32(mask);
+        p += 16;
+    }
+#else
+    while (ep - p >= 8) {
+        uint64_t v = ajson_load64(p);
+        if (AJSON_SWAR_HAS_BYTE(v, '\"') | AJSON_SWAR_HAS_BYTE(v, '\\') |
+            AJSON_SWAR_HAS_LESS(v, 0x20) | (v & AJSON_SWAR_HIGHS))
+            break;
+        p += 8;
+    }
+#endif
+    while (p < ep) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '\"' || c == '\\' || c < 0x20 || c >= 0x80) break;
+        p++;
+    }
+    return p;
+}
+
+/* Returns the first '"', '\\' or control byte (< 0x20) in [p, ep), or ep
+   if there is none.  Non-ASCII bytes are skipped, so a run of text can be
+   handed to the UTF-8 validator in one piece. */
+static inline const char *ajson_scan_string_ctrl(const char *p, const char *ep) {
+#ifdef AJSON_SCAN_SSE2
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i ctrl = _mm_set1_epi8(0x1F);
+    while (ep - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, bslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(v, ctrl), ctrl));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(m);
+        if (mask) return p + AJSON_CTZ32(mask);
+        p += 16;
+    }
+#else
+    while (ep - p >= 8) {
+        uint64_t v = ajson_load64(p);
+        if (AJSON_SWAR_HAS_BYTE(v, '\"') | AJSON_SWAR_HAS_BYTE(v, '\\') |
+            AJSON_SWAR_HAS_LESS(v, 0x20))
+            break;
+        p += 8;
+    }
+#endif
+    while (p < ep) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '\"' || c == '\\' || c < 0x20) break;
+        p++;
+    }
+    return p;
+}
+
+/* Length of the JSON escape starting at the backslash at p (2 or 6), or 0
+   if it is not one of \" \\ \/ \b \f \n \r \t \uXXXX. */
+static inline int ajson_escape_length(const char *p, const char *ep) {
+    if (ep - p < 2) return 0;
+    switch (p[1]) {
+    case '\"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+        return 2;
+    case 'u':
+        if (ep - p < 6 || ajson_hex4(p + 2) < 0) return 0;
+        return 6;
+    default:
+        return 0;
+    }
+}
+
+/* Length of the well-formed UTF-8 sequence at p (1-4), or 0 if the bytes
+   at p are not a complete, strictly valid sequence (RFC 3629: no
+   overlongs, no surrogates, nothing above U+10FFFF). */
+static inline int ajson_utf8_sequence_length(const unsigned char *p,
+                                             const unsigned char *ep) {
+    unsigned char c = p[0];
+    if (c < 0x80) return 1;
+    if (c < 0xC2) return 0;
+    if (c < 0xE0) {
+        if (ep - p < 2 || (p[1] & 0xC0) != 0x80) return 0;
+        return 2;
+    }
+    if (c < 0xF0) {
+        if (ep - p < 3) return 0;
+        unsigned char lo = 0x80, hi = 0xBF;
+        if (c == 0xE0) lo = 0xA0;
+        else if (c == 0xED) hi = 0x9F;
+        if (p[1] < lo || p[1] > hi || (p[2] & 0xC0) != 0x80) return 0;
+        return 3;
+    }
+    if (c < 0xF5) {
+        if (ep - p < 4) return 0;
+        unsigned char lo = 0x80, hi = 0xBF;
+        if (c == 0xF0) lo = 0x90;
+        else if (c == 0xF4) hi = 0x8F;
+        if (p[1] < lo || p[1] > hi || (p[2] & 0xC0) != 0x80 || (p[3] & 0xC0) != 0x80)
+            return 0;
+        return 4;
+    }
+    return 0;
+}
+
+#endif /* _AJSON_SCAN_H */
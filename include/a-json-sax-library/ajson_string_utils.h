@@ -7,6 +7,7 @@
 #include "a-memory-library/aml_pool.h"
 #include "a-memory-library/aml_buffer.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 
@@ -27,18 +28,46 @@ char *ajson_decode(aml_pool_t *pool, char *s, size_t length);
  * May alias input if nothing to decode. */
 char *ajson_decode2(size_t *rlen, aml_pool_t *pool, char *s, size_t length);
 
+/** Decode JSON escape sequences in place.  The decoded form is never
+ * longer than the source, so no allocation is needed (meant for buffers
+ * handed out by ajson_sax_parse_destructive).  Returns the decoded length;
+ * if it is shorter than 'length' a NUL is written at the new end. */
+size_t ajson_decode_inplace(char *s, size_t length);
+
 /** Escape JSON specials/control bytes in [s, s+length).
  * May return 's' unchanged if nothing needs escaping (aliasing!),
- * otherwise returns a pool-allocated buffer. */
+ * otherwise returns a NUL-terminated pool buffer sized to the exact
+ * encoded length. */
 char *ajson_encode(aml_pool_t *pool, char *s, size_t length);
 
+/** Escape like ajson_encode, appending the result to 'bh'. */
+void ajson_buffer_append_encoded(aml_buffer_t *bh, const char *s, size_t length);
+
 /* ========================
  * UTF-8 Validation / Copy
- * ======================== */
+ * ========================
+ * Validation is strict RFC 3629: overlong encodings, surrogates
+ * (U+D800..U+DFFF) and code points above U+10FFFF are invalid.  The
+ * repair functions below drop the first byte of each invalid or truncated
+ * sequence and resynchronize on the next byte. */
 
-/** Write only valid UTF-8 sequences from src[0..len) to FILE* out. */
+/** Returns the length of the longest valid UTF-8 prefix of src[0..len),
+ * i.e. the offset of the first invalid byte or 'len' if all is valid. */
+size_t ajson_utf8_valid_prefix(const char *src, size_t len);
+
+/** Returns true if src[0..len) is entirely valid UTF-8. */
+bool ajson_utf8_is_valid(const char *src, size_t len);
+
+/** Write only valid UTF-8 sequences from src[0..len) to FILE* out.
+ * Valid runs are written in bulk under a single stream lock. */
 void ajson_file_write_valid_utf8(FILE *out, const char *src, size_t len);
 
+/** Write only valid UTF-8 sequences from src[0..len) to file descriptor
+ * 'fd', bypassing stdio.  Valid input is written directly; otherwise the
+ * repaired output is staged through a page-aligned 1 MiB block.  Returns 0,
+ * or -1 with errno set if a write fails. */
+int ajson_fd_write_valid_utf8(int fd, const char *src, size_t len);
+
 /** Copies bytes from 'src' (length 'len') to 'dest', skipping any invalid UTF-8.
  * Returns a pointer to the position after the last valid byte written. */
 char *ajson_copy_valid_utf8(char *dest, const char *src, size_t len);
@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _ajson_validate_H
+#define _ajson_validate_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Check that [p, p+len) is exactly one JSON document (RFC 8259), without
+ * calling anything back or writing to the input.  The input needs no NUL
+ * terminator and may sit in read-only memory.
+ *
+ * The rules are those of ajson_sax_parse_ex with AJSON_SAX_VALIDATE_UTF8:
+ * strict UTF-8 and escapes in strings, no raw control bytes, the same
+ * number grammar and nesting limit, and only whitespace after the value.
+ * Unlike that parse it needs neither a writable buffer nor a NUL at the
+ * end.
+ *
+ * Strings are scanned 16 bytes at a time, and UTF-8 is checked a chunk
+ * at a time with ajson_utf8_valid_prefix rather than per character.  Only
+ * an input that fails is walked a second time to find the error offset.
+ *
+ * Returns true if the document is valid.  Otherwise '*error_offset' (if
+ * not NULL) is set to the offset of the first byte that cannot belong to
+ * a valid document, or to 'len' if the input ends too early.
+ */
+bool ajson_validate(const char *p, size_t len, size_t *error_offset);
+
+/* Validate [src, src+len) as ajson_validate does and copy it to 'dst'
+ * without the whitespace between tokens.  Strings, escapes included, are
+ * copied as they are.  'dst' needs room for 'len' bytes; the output is not
+ * NUL-terminated.  On success '*out_len' (if not NULL) is set to the
+ * length written.  On failure '*error_offset' is set as by ajson_validate
+ * and the contents of 'dst' are unspecified.
+ */
+bool ajson_minify(char *dst, const char *src, size_t len, size_t *out_len,
+                  size_t *error_offset);
+
+/* ajson_minify with the output written over the input, for buffers that
+ * are about to be parsed destructively or stored.  On failure the buffer
+ * has been partly rewritten, but '*error_offset' still refers to the
+ * original input.
+ */
+bool ajson_minify_in_place(char *p, size_t len, size_t *out_len, size_t *error_offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ajson_validate_H */
@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _AJSON_WRITER_H
+#define _AJSON_WRITER_H
+
+#include "a-memory-library/aml_buffer.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Forward declaration */
+typedef struct ajson_writer_s ajson_writer_t;
+
+/** Receives a block of output.  Return non-zero to signal a write error;
+ * the writer then discards all further output and reports the error from
+ * ajson_writer_flush / ajson_writer_destroy. */
+typedef int (*ajson_writer_flush_cb)(void *arg, const char *data, size_t len);
+
+/** Default block size for callback writers. */
+#define AJSON_WRITER_BLOCK_SIZE (64 * 1024)
+
+/* ========================
+ * Lifecycle
+ * ======================== */
+
+/** Create a writer that appends to 'bh'.  Output is written directly into
+ * the buffer's storage; call ajson_writer_flush (or destroy) before reading
+ * 'bh' so the reserved tail is trimmed off. */
+ajson_writer_t *ajson_writer_init(aml_buffer_t *bh);
+
+/** Create a writer that hands output to 'flush' in blocks of 'block_size'
+ * bytes (AJSON_WRITER_BLOCK_SIZE if 0). */
+ajson_writer_t *ajson_writer_init_cb(ajson_writer_flush_cb flush, void *arg,
+                                     size_t block_size);
+
+/** Push pending output to the sink.  Returns 0 or the sticky error code. */
+int ajson_writer_flush(ajson_writer_t *w);
+
+/** Flush and free the writer.  Returns the same value as ajson_writer_flush. */
+int ajson_writer_destroy(ajson_writer_t *w);
+
+/** Returns the sticky error code (0 if no flush has failed). */
+int ajson_writer_error(ajson_writer_t *w);
+
+/* ========================
+ * Structure
+ * ======================== */
+
+void ajson_writer_start_object(ajson_writer_t *w);
+void ajson_writer_end_object(ajson_writer_t *w);
+void ajson_writer_start_array(ajson_writer_t *w);
+void ajson_writer_end_array(ajson_writer_t *w);
+
+/** Write an object key (escaped) followed by ':'. */
+void ajson_writer_key(ajson_writer_t *w, const char *key, size_t len);
+
+/* ========================
+ * Values
+ * ======================== */
+
+/** Write a quoted, escaped string value. */
+void ajson_writer_string(ajson_writer_t *w, const char *s, size_t len);
+
+void ajson_writer_int(ajson_writer_t *w, int64_t v);
+void ajson_writer_uint(ajson_writer_t *w, uint64_t v);
+
+/** Write the shortest representation that round-trips, independent of
+ * the locale (see ajson_format_double).  NaN and infinities have no JSON
+ * form and are written as null. */
+void ajson_writer_double(ajson_writer_t *w, double v);
+
+void ajson_writer_bool(ajson_writer_t *w, bool v);
+void ajson_writer_null(ajson_writer_t *w);
+
+/** Splice pre-encoded JSON as a single value (comma handling still applies). */
+void ajson_writer_raw(ajson_writer_t *w, const char *json, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AJSON_WRITER_H */
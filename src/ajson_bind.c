@@ -0,0 +1,410 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#include "a-json-sax-library/ajson_bind.h"
+#include "a-json-sax-library/ajson_number.h"
+#include "a-json-sax-library/ajson_sax_impl.h"
+#include "a-memory-library/aml_pool.h"
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Bound structs nested deeper than this fail the parse (-1).  Unbound
+   content is skipped with a counter and may nest as deep as the parser
+   allows. */
+#define AJSON_BIND_MAX_DEPTH 64
+
+typedef struct ajson_bind_node_s ajson_bind_node_t;
+
+/* A field with everything the handlers need precomputed */
+typedef struct {
+    const ajson_bind_field_t *field;
+    const ajson_bind_node_t *nested;   /* AJSON_BIND_OBJECT */
+    size_t elem_size;                  /* Size of one value of the base type */
+    uint32_t hash;
+    uint32_t len;
+} ajson_bind_entry_t;
+
+typedef struct {
+    uint32_t hash;
+    uint32_t entry;                    /* Index + 1, 0 if empty */
+} ajson_bind_slot_t;
+
+struct ajson_bind_node_s {
+    const ajson_bind_desc_t *desc;
+    ajson_bind_entry_t *entries;
+    ajson_bind_slot_t *slots;          /* Open addressing, linear probing */
+    uint32_t mask;
+    ajson_bind_node_t *next;
+};
+
+struct ajson_bind_s {
+    aml_pool_t *pool;
+    ajson_bind_node_t *root;
+    ajson_bind_node_t *nodes;
+};
+
+/* FNV-1a: keys are short, so a byte loop beats anything wider. */
+static inline uint32_t ajson_bind_hash(const char *s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static size_t ajson_bind_type_size(unsigned type, const ajson_bind_desc_t *nested) {
+    switch (type & ~AJSON_BIND_ARRAY) {
+    case AJSON_BIND_INT:    return sizeof(int);
+    case AJSON_BIND_INT64:  return sizeof(int64_t);
+    case AJSON_BIND_UINT64: return sizeof(uint64_t);
+    case AJSON_BIND_DOUBLE: return sizeof(double);
+    case AJSON_BIND_BOOL:   return sizeof(bool);
+    case AJSON_BIND_STRING: return sizeof(char *);
+    case AJSON_BIND_OBJECT: return nested ? nested->size : 0;
+    default:                return 0;
+    }
+}
+
+static ajson_bind_node_t *ajson_bind_compile(ajson_bind_t *b, const ajson_bind_desc_t *desc) {
+    for (ajson_bind_node_t *n = b->nodes; n; n = n->next)
+        if (n->desc == desc) return n;
+
+    /* Registered before recursing, so self-referencing descriptors work */
+    ajson_bind_node_t *n = (ajson_bind_node_t *)aml_pool_zalloc(b->pool, sizeof(*n));
+    n->desc = desc;
+    n->next = b->nodes;
+    b->nodes = n;
+
+    size_t cap = 4;
+    while (cap < desc->num_fields * 2) cap <<= 1;
+    n->mask = (uint32_t)(cap - 1);
+    n->slots = (ajson_bind_slot_t *)aml_pool_zalloc(b->pool, cap * sizeof(ajson_bind_slot_t));
+    n->entries = (ajson_bind_entry_t *)aml_pool_zalloc(
+        b->pool, (desc->num_fields ? desc->num_fields : 1) * sizeof(ajson_bind_entry_t));
+
+    for (size_t i = 0; i < desc->num_fields; i++) {
+        const ajson_bind_field_t *f = desc->fields + i;
+        ajson_bind_entry_t *e = n->entries + i;
+        e->field = f;
+        e->len = (uint32_t)strlen(f->name);
+        e->hash = ajson_bind_hash(f->name, e->len);
+        e->elem_size = ajson_bind_type_size(f->type, f->nested);
+        if ((f->type & ~AJSON_BIND_ARRAY) == AJSON_BIND_OBJECT && f->nested)
+            e->nested = ajson_bind_compile(b, f->nested);
+
+        uint32_t j = e->hash & n->mask;
+        while (n->slots[j].entry) j = (j + 1) & n->mask;
+        n->slots[j].hash = e->hash;
+        n->slots[j].entry = (uint32_t)(i + 1);
+    }
+    return n;
+}
+
+ajson_bind_t *ajson_bind_init(const ajson_bind_desc_t *desc) {
+    aml_pool_t *pool = aml_pool_init(1024);
+    ajson_bind_t *b = (ajson_bind_t *)aml_pool_zalloc(pool, sizeof(ajson_bind_t));
+    b->pool = pool;
+    b->root = ajson_bind_compile(b, desc);
+    return b;
+}
+
+void ajson_bind_destroy(ajson_bind_t *b) {
+    if (!b) return;
+    aml_pool_destroy(b->pool);
+}
+
+static inline const ajson_bind_entry_t *
+ajson_bind_lookup(const ajson_bind_node_t *n, const char *key, size_t len) {
+    uint32_t h = ajson_bind_hash(key, len);
+    for (uint32_t j = h & n->mask; n->slots[j].entry; j = (j + 1) & n->mask) {
+        if (n->slots[j].hash != h) continue;
+        const ajson_bind_entry_t *e = n->entries + n->slots[j].entry - 1;
+        if (e->len == len && !memcmp(e->field->name, key, len)) return e;
+    }
+    return NULL;
+}
+
+/* ---------- Parse State ---------- */
+
+typedef struct {
+    const ajson_bind_node_t *node;     /* NULL for an array frame */
+    char *base;                        /* Struct being filled (or owning the array) */
+    const ajson_bind_entry_t *entry;   /* Object: the key just seen; array: the member */
+    char *items;                       /* Array elements so far */
+    size_t count;
+    size_t cap;
+} ajson_bind_frame_t;
+
+typedef struct {
+    aml_pool_t *pool;
+    const ajson_bind_node_t *root;
+    void *out;
+    bool alias;                        /* Strings may point into the input */
+    int skip;                          /* Depth inside an unbound container */
+    int depth;                         /* Frames in use */
+    ajson_bind_frame_t frames[AJSON_BIND_MAX_DEPTH];
+} ajson_bind_ctx_t;
+
+/* Append a zeroed element to an array frame. */
+static inline char *ajson_bind_append(ajson_bind_ctx_t *c, ajson_bind_frame_t *fr) {
+    size_t size = fr->entry->elem_size;
+    if (fr->count == fr->cap) {
+        size_t cap = fr->cap ? fr->cap * 2 : 8;
+        char *items = (char *)aml_pool_alloc(c->pool, cap * size);
+        if (fr->count) memcpy(items, fr->items, fr->count * size);
+        fr->items = items;
+        fr->cap = cap;
+    }
+    char *r = fr->items + fr->count++ * size;
+    memset(r, 0, size);
+    return r;
+}
+
+/* Where the next scalar goes and its type.  Returns NULL with *type 0 to
+   ignore the value, or NULL with a non-zero *type for a mismatch (a scalar
+   at the root or for an array member). */
+static inline char *ajson_bind_target(ajson_bind_ctx_t *c, unsigned *type) {
+    *type = 0;
+    if (c->skip) return NULL;
+    if (!c->depth) {
+        *type = AJSON_BIND_ARRAY;      /* The root must be an object */
+        return NULL;
+    }
+    ajson_bind_frame_t *fr = c->frames + c->depth - 1;
+    const ajson_bind_entry_t *e = fr->entry;
+    if (fr->node) {
+        fr->entry = NULL;
+        if (!e) return NULL;
+        *type = e->field->type;
+        if (*type & AJSON_BIND_ARRAY) return NULL;
+        return fr->base + e->field->offset;
+    }
+    *type = e->field->type & ~AJSON_BIND_ARRAY;
+    return ajson_bind_append(c, fr);
+}
+
+static inline int ajson_bind_int(const char *v, size_t len, bool neg_ok,
+                                 uint64_t max, bool *neg, uint64_t *r) {
+    const char *ep = v + len;
+    *neg = (*v == '-');
+    if (*neg) {
+        if (!neg_ok) return AJSON_BIND_MISMATCH;
+        v++;
+    }
+    uint64_t x = 0;
+    for (; v < ep; v++) {
+        unsigned d = (unsigned)(*v - '0');
+        if (d > 9) return AJSON_BIND_MISMATCH;    /* Fraction or exponent */
+        if (x > (max - d) / 10) return AJSON_BIND_MISMATCH;
+        x = x * 10 + d;
+    }
+    *r = x;
+    return 0;
+}
+
+static inline int ajson_bind_on_number(void *ctx, ajson_sax_t *sax, const char *v, size_t len) {
+    (void)sax;
+    unsigned type;
+    char *dst = ajson_bind_target((ajson_bind_ctx_t *)ctx, &type);
+    if (!dst) return type ? AJSON_BIND_MISMATCH : 0;
+
+    bool neg;
+    uint64_t x;
+    int rc;
+    switch (type) {
+    case AJSON_BIND_INT:
+        rc = ajson_bind_int(v, len, true, (uint64_t)INT_MAX + 1, &neg, &x);
+        if (rc || (!neg && x > INT_MAX)) return AJSON_BIND_MISMATCH;
+        *(int *)dst = neg ? (int)(0 - (int64_t)x) : (int)x;
+        return 0;
+    case AJSON_BIND_INT64:
+        rc = ajson_bind_int(v, len, true, (uint64_t)INT64_MAX + 1, &neg, &x);
+        if (rc || (!neg && x > INT64_MAX)) return AJSON_BIND_MISMATCH;
+        *(int64_t *)dst = neg ? (int64_t)(0 - x) : (int64_t)x;
+        return 0;
+    case AJSON_BIND_UINT64:
+        rc = ajson_bind_int(v, len, false, UINT64_MAX, &neg, &x);
+        if (rc) return rc;
+        *(uint64_t *)dst = x;
+        return 0;
+    case AJSON_BIND_DOUBLE:
+        *(double *)dst = ajson_parse_double(v, len);
+        return 0;
+    default:
+        return AJSON_BIND_MISMATCH;
+    }
+}
+
+static inline int ajson_bind_on_string(void *ctx, ajson_sax_t *sax, const char *v, size_t len) {
+    ajson_bind_ctx_t *c = (ajson_bind_ctx_t *)ctx;
+    unsigned type;
+    char *dst = ajson_bind_target(c, &type);
+    if (!dst) return type ? AJSON_BIND_MISMATCH : 0;
+    if (type != AJSON_BIND_STRING) return AJSON_BIND_MISMATCH;
+
+    /* Decoded escapes already live in the pool */
+    if (c->alias || sax->has_escapes) *(char **)dst = (char *)v;
+    else *(char **)dst = aml_pool_strndup(c->pool, v, len);
+    return 0;
+}
+
+static inline int ajson_bind_on_bool(void *ctx, ajson_sax_t *sax, bool val) {
+    (void)sax;
+    unsigned type;
+    char *dst = ajson_bind_target((ajson_bind_ctx_t *)ctx, &type);
+    if (!dst) return type ? AJSON_BIND_MISMATCH : 0;
+    if (type != AJSON_BIND_BOOL) return AJSON_BIND_MISMATCH;
+    *(bool *)dst = val;
+    return 0;
+}
+
+/* null leaves a member untouched; in an array it is a zeroed element. */
+static inline int ajson_bind_on_null(void *ctx, ajson_sax_t *sax) {
+    (void)sax;
+    ajson_bind_ctx_t *c = (ajson_bind_ctx_t *)ctx;
+    if (c->skip) return 0;
+    if (!c->depth) return AJSON_BIND_MISMATCH;
+    ajson_bind_frame_t *fr = c->frames + c->depth - 1;
+    if (fr->node) fr->entry = NULL;
+    else ajson_bind_append(c, fr);
+    return 0;
+}
+
+static inline int ajson_bind_on_key(void *ctx, ajson_sax_t *sax, const char *key, size_t len) {
+    (void)sax;
+    ajson_bind_ctx_t *c = (ajson_bind_ctx_t *)ctx;
+    if (c->skip) return 0;
+    ajson_bind_frame_t *fr = c->frames + c->depth - 1;
+    fr->entry = ajson_bind_lookup(fr->node, key, len);
+    return 0;
+}
+
+static inline int ajson_bind_push(ajson_bind_ctx_t *c, const ajson_bind_node_t *node,
+                                  char *base, const ajson_bind_entry_t *entry) {
+    if (c->depth == AJSON_BIND_MAX_DEPTH) return -1;
+    ajson_bind_frame_t *fr = c->frames + c->depth++;
+    fr->node = node;
+    fr->base = base;
+    fr->entry = entry;
+    fr->items = NULL;
+    fr->count = 0;
+    fr->cap = 0;
+    return 0;
+}
+
+static inline int ajson_bind_on_start_object(void *ctx, ajson_sax_t *sax) {
+    (void)sax;
+    ajson_bind_ctx_t *c = (ajson_bind_ctx_t *)ctx;
+    if (c->skip) {
+        c->skip++;
+        return 0;
+    }
+    if (!c->depth) return ajson_bind_push(c, c->root, (char *)c->out, NULL);
+
+    ajson_bind_frame_t *fr = c->frames + c->depth - 1;
+    const ajson_bind_entry_t *e = fr->entry;
+    if (fr->node) {
+        fr->entry = NULL;
+        if (!e) {
+            c->skip = 1;
+            return 0;
+        }
+        if (e->field->type != AJSON_BIND_OBJECT || !e->nested) return AJSON_BIND_MISMATCH;
+        return ajson_bind_push(c, e->nested, fr->base + e->field->offset, NULL);
+    }
+    if (!e->nested) return AJSON_BIND_MISMATCH;
+    return ajson_bind_push(c, e->nested, ajson_bind_append(c, fr), NULL);
+}
+
+static inline int ajson_bind_on_end_object(void *ctx, ajson_sax_t *sax) {
+    (void)sax;
+    ajson_bind_ctx_t *c = (ajson_bind_ctx_t *)ctx;
+    if (c->skip) c->skip--;
+    else c->depth--;
+    return 0;
+}
+
+static inline int ajson_bind_on_start_array(void *ctx, ajson_sax_t *sax) {
+    (void)sax;
+    ajson_bind_ctx_t *c = (ajson_bind_ctx_t *)ctx;
+    if (c->skip) {
+        c->skip++;
+        return 0;
+    }
+    if (!c->depth) return AJSON_BIND_MISMATCH;
+
+    ajson_bind_frame_t *fr = c->frames + c->depth - 1;
+    const ajson_bind_entry_t *e = fr->entry;
+    if (!fr->node) return AJSON_BIND_MISMATCH;  /* Arrays of arrays */
+    fr->entry = NULL;
+    if (!e) {
+        c->skip = 1;
+        return 0;
+    }
+    if (!(e->field->type & AJSON_BIND_ARRAY) || !e->elem_size) return AJSON_BIND_MISMATCH;
+    return ajson_bind_push(c, NULL, fr->base, e);
+}
+
+static inline int ajson_bind_on_end_array(void *ctx, ajson_sax_t *sax) {
+    (void)sax;
+    ajson_bind_ctx_t *c = (ajson_bind_ctx_t *)ctx;
+    if (c->skip) {
+        c->skip--;
+        return 0;
+    }
+    ajson_bind_frame_t *fr = c->frames + --c->depth;
+    const ajson_bind_field_t *f = fr->entry->field;
+    *(char **)(fr->base + f->offset) = fr->items;
+    *(size_t *)(fr->base + f->count_offset) = fr->count;
+    return 0;
+}
+
+static const ajson_sax_cb_t ajson_bind_handlers = {
+    .on_null = ajson_bind_on_null,
+    .on_bool = ajson_bind_on_bool,
+    .on_number = ajson_bind_on_number,
+    .on_string = ajson_bind_on_string,
+    .on_key = ajson_bind_on_key,
+    .on_start_object = ajson_bind_on_start_object,
+    .on_end_object = ajson_bind_on_end_object,
+    .on_start_array = ajson_bind_on_start_array,
+    .on_end_array = ajson_bind_on_end_array
+};
+
+AJSON_SAX_DEFINE_PARSER_EX(ajson_bind_parse_d, ajson_bind_handlers,
+                           AJSON_SAX_DECODE_STRINGS)
+AJSON_SAX_DEFINE_PARSER_EX(ajson_bind_parse_xd, ajson_bind_handlers,
+                           AJSON_SAX_DESTRUCTIVE | AJSON_SAX_DECODE_STRINGS)
+AJSON_SAX_DEFINE_PARSER_EX(ajson_bind_parse_dv, ajson_bind_handlers,
+                           AJSON_SAX_DECODE_STRINGS | AJSON_SAX_VALIDATE_UTF8)
+AJSON_SAX_DEFINE_PARSER_EX(ajson_bind_parse_xdv, ajson_bind_handlers,
+                           AJSON_SAX_DESTRUCTIVE | AJSON_SAX_DECODE_STRINGS |
+                           AJSON_SAX_VALIDATE_UTF8)
+
+typedef int (*ajson_bind_variant_t)(char *p, char *ep, aml_pool_t *pool, void *ctx,
+                                    char **error_at);
+
+/* Indexed by DESTRUCTIVE | VALIDATE_UTF8 >> 1 */
+static const ajson_bind_variant_t ajson_bind_variants[4] = {
+    ajson_bind_parse_d, ajson_bind_parse_xd, ajson_bind_parse_dv, ajson_bind_parse_xdv
+};
+
+int ajson_bind_parse(const ajson_bind_t *b, void *out,
+                     char *p, char *ep, aml_pool_t *pool,
+                     char **error_at, unsigned flags) {
+    ajson_bind_ctx_t c;
+    c.pool = pool;
+    c.root = b->root;
+    c.out = out;
+    c.alias = (flags & AJSON_SAX_DESTRUCTIVE) != 0;
+    c.skip = 0;
+    c.depth = 0;
+
+    unsigned v = (flags & AJSON_SAX_DESTRUCTIVE) | ((flags & AJSON_SAX_VALIDATE_UTF8) >> 1);
+    return ajson_bind_variants[v](p, ep, pool, &c, error_at);
+}
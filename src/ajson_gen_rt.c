@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#include "a-json-sax-library/ajson_gen_rt.h"
+
+/* Nesting allowed inside a skipped value (as the parser's own limit) */
+#define AJSON_GEN_MAX_SKIP_DEPTH 512
+
+static char *ajson_gen_skip_number(ajson_gen_t *g, char *p) {
+    if (*p == '-') p++;
+    if (*p == '0') p++;
+    else if ((unsigned)(*p - '1') <= 8)
+        while ((unsigned)(*p - '0') <= 9) p++;
+    else
+        return ajson_gen_fail(g, p);
+    if (*p == '.') {
+        p++;
+        if ((unsigned)(*p - '0') > 9) return ajson_gen_fail(g, p);
+        while ((unsigned)(*p - '0') <= 9) p++;
+    }
+    if (*p == 'e' || *p == 'E') {
+        p++;
+        if (*p == '+' || *p == '-') p++;
+        if ((unsigned)(*p - '0') > 9) return ajson_gen_fail(g, p);
+        while ((unsigned)(*p - '0') <= 9) p++;
+    }
+    return p;
+}
+
+static char *ajson_gen_skip_value(ajson_gen_t *g, char *p, int depth) {
+    bool escapes;
+    char *e;
+    switch (*p) {
+    case '\"':
+        if (!(e = ajson_gen_string_end(g, p, &escapes))) return ajson_gen_fail(g, p);
+        return e + 1;
+    case 't':
+        if (p[1] == 'r' && p[2] == 'u' && p[3] == 'e') return p + 4;
+        return ajson_gen_fail(g, p);
+    case 'f':
+        if (p[1] == 'a' && p[2] == 'l' && p[3] == 's' && p[4] == 'e') return p + 5;
+        return ajson_gen_fail(g, p);
+    case 'n':
+        if (ajson_gen_is_null(p)) return p + 4;
+        return ajson_gen_fail(g, p);
+    case '{':
+        if (depth == AJSON_GEN_MAX_SKIP_DEPTH) return ajson_gen_fail(g, p);
+        p = ajson_gen_ws(p + 1);
+        if (*p == '}') return p + 1;
+        for (;;) {
+            if (*p != '\"' || !(e = ajson_gen_string_end(g, p, &escapes)))
+                return ajson_gen_fail(g, p);
+            p = ajson_gen_ws(e + 1);
+            if (*p != ':') return ajson_gen_fail(g, p);
+            p = ajson_gen_ws(p + 1);
+            if (!(p = ajson_gen_skip_value(g, p, depth + 1))) return NULL;
+            p = ajson_gen_ws(p);
+            if (*p == '}') return p + 1;
+            if (*p != ',') return ajson_gen_fail(g, p);
+            p = ajson_gen_ws(p + 1);
+        }
+    case '[':
+        if (depth == AJSON_GEN_MAX_SKIP_DEPTH) return ajson_gen_fail(g, p);
+        p = ajson_gen_ws(p + 1);
+        if (*p == ']') return p + 1;
+        for (;;) {
+            if (!(p = ajson_gen_skip_value(g, p, depth + 1))) return NULL;
+            p = ajson_gen_ws(p);
+            if (*p == ']') return p + 1;
+            if (*p != ',') return ajson_gen_fail(g, p);
+            p = ajson_gen_ws(p + 1);
+        }
+    default:
+        return ajson_gen_skip_number(g, p);
+    }
+}
+
+char *ajson_gen_skip(ajson_gen_t *g, char *p) {
+    return ajson_gen_skip_value(g, p, 0);
+}
@@ -1,492 +1,191 @@
 // SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
 // SPDX-License-Identifier: Apache-2.0
 
-#include "a-json-sax-library/ajson_sax.h"
-#include <string.h>
-
-/* Internal Parser Stack Constants */
-#define SAX_MODE_ROOT   0
-#define SAX_MODE_OBJECT 1
-#define SAX_MODE_ARRAY  2
-
-/* Max depth for the internal syntax stack (on C stack). */
-#define AJSON_SAX_MAX_STACK_DEPTH 512
+#define _POSIX_C_SOURCE 200809L
 
-/* Case Macros for Tokenization */
-#define AJSON_NATURAL_NUMBER_CASE                                            \
-  '1' : case '2' : case '3' : case '4' : case '5' : case '6' : case '7'        \
-      : case '8' : case '9'
+#include "a-json-sax-library/ajson_sax.h"
+#include "a-json-sax-library/ajson_sax_impl.h"
+#include "a-memory-library/aml_alloc.h"
 
-#define AJSON_SPACE_CASE 32 : case 9 : case 13 : case 10
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
 
+/* ========================================================================
+ * Instrumentation helpers (see ajson_sax_impl.h)
+ * ======================================================================== */
 
-/* The internal template. The compiler will inline this into the two wrappers
-   below, entirely optimizing away the `if (!destructive)` checks! */
-static inline __attribute__((always_inline)) int ajson_sax_parse_impl(
-                    char *p, char *ep,
-                    const ajson_sax_cb_t *initial_cb,
-                    aml_pool_t *pool,
-                    void *ctx,
-                    char **error_at,
-                    bool destructive) {
-
-    /* --- Context Setup --- */
-    ajson_sax_t sax;
-    sax.cb = *initial_cb;
-    sax.pool = pool;
-    sax.top = NULL;
-    sax.current_depth = 0;
-    sax.anchor_depth = 0;
-
-    /* --- Internal Syntax Stack (On Stack) --- */
-    unsigned char stack[AJSON_SAX_MAX_STACK_DEPTH];
-    int stack_depth = 0;
-    stack[0] = SAX_MODE_ROOT;
-
-    /* Stack Helper Macros */
-    #define SYNTAX_PUSH(mode) do { \
-        if (stack_depth >= AJSON_SAX_MAX_STACK_DEPTH - 1) return -1; \
-        stack[++stack_depth] = (mode); \
-        sax.current_depth++; \
-    } while(0)
-
-    #define SYNTAX_POP() do { \
-        if (stack_depth > 0) stack_depth--; \
-        sax.current_depth--; \
-    } while(0)
-
-    #define CURRENT_MODE() (stack[stack_depth])
-
-    /* Callback Helper Macros */
-    int rc = 0;
-
-    #define SAX_ERROR { \
-        if (error_at) *error_at = p; \
-        return -1; \
-    }
+uint64_t ajson_sax_clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
 
-    #define CHECK_CB(x) if ((rc = (x))) { \
-        if (error_at) *error_at = p; \
-        return rc; \
-    }
+static size_t ajson_sax_chain_length(const sax_handler_node_t *n) {
+    size_t len = 0;
+    for (; n; n = n->next) len++;
+    return len;
+}
 
-    /* --- Parsing Variables --- */
-    char *sp = p;
-    char ch;
-    char *stringp = NULL;
-    bool after_comma = false;
-
-    if (p >= ep) SAX_ERROR;
-
-    /* Jump into the state machine */
-    goto start_value;
-
-start_key:;
-    if (p >= ep) SAX_ERROR;
-    ch = *p++;
-    switch (ch) {
-    case '\"':
-        after_comma = false;
-        stringp = p;
-        goto get_end_of_key;
-    case AJSON_SPACE_CASE:
-        goto start_key;
-    case '}':
-        if (after_comma) SAX_ERROR;
-        if (sax.cb.on_end_object) CHECK_CB(sax.cb.on_end_object(ctx, &sax));
-        SYNTAX_POP();
-        goto determine_next_step;
-    default:
-        SAX_ERROR;
-    };
-
-get_end_of_key:;
-    while (p < ep && *p != '\"') p++;
-    if (p < ep) {
-        if (p[-1] == '\\') {
-            char *backtrack = p-1;
-            while(*backtrack == '\\') backtrack--;
-            if(((p-backtrack) & 1) == 0) {
-                p++;
-                goto get_end_of_key;
-            }
-        }
-        *p = 0;
+/* A callback moved the handler stack from 'before' to 'after'; count the
+   nodes popped down to their common ancestor and the nodes pushed above it. */
+void ajson_sax_stats_track(ajson_sax_stats_t *stats,
+                           const sax_handler_node_t *before,
+                           const sax_handler_node_t *after) {
+    size_t nb = ajson_sax_chain_length(before);
+    size_t na = ajson_sax_chain_length(after);
+    for (; nb > na; nb--, before = before->next) stats->handler_pops++;
+    for (; na > nb; na--, after = after->next) stats->handler_pushes++;
+    for (; before != after; before = before->next, after = after->next) {
+        stats->handler_pops++;
+        stats->handler_pushes++;
     }
+}
 
-    if (sax.cb.on_key) CHECK_CB(sax.cb.on_key(ctx, &sax, stringp, p - stringp));
-
-    if (!destructive) {
-        *p = '\"'; /* Restore closing quote */
-    }
-    p++;
-    while (p < ep && *p != ':') p++;
-    p++;
-
-start_key_object:;
-    if (p >= ep) SAX_ERROR;
-    ch = *p++;
-    switch (ch) {
-    case '\"':
-        stringp = p;
-        goto keyed_start_string;
-    case AJSON_SPACE_CASE:
-        goto start_key_object;
-    case '{':
-        if (sax.cb.on_start_object) CHECK_CB(sax.cb.on_start_object(ctx, &sax));
-        SYNTAX_PUSH(SAX_MODE_OBJECT);
-        goto start_key;
-    case '[':
-        if (sax.cb.on_start_array) CHECK_CB(sax.cb.on_start_array(ctx, &sax));
-        SYNTAX_PUSH(SAX_MODE_ARRAY);
-        goto start_value;
-    case '-':
-        stringp = p - 1;
-        ch = *p++;
-        if (ch == '0') {
-            char la = *p;
-            if (la == '.') { p++; goto keyed_decimal_number; }
-            if (la == 'e' || la == 'E') { goto keyed_next_digit; }
-            if (la >= '0' && la <= '9') { SAX_ERROR; }
-            /* -0 */
-            if (sax.cb.on_number) CHECK_CB(sax.cb.on_number(ctx, &sax, "-0", 2));
-            goto look_for_key;
-        } else if (ch >= '1' && ch <= '9') {
-            goto keyed_next_digit;
-        } else {
-            SAX_ERROR;
-        }
-    case '0': {
-        stringp = p - 1;
-        if (p < ep) {
-            char la = *p;
-            if (la == '.') { p++; goto keyed_decimal_number; }
-            if (la == 'e' || la == 'E') { goto keyed_next_digit; }
-            if (la >= '0' && la <= '9') { SAX_ERROR; }
-        }
-        if (sax.cb.on_number) CHECK_CB(sax.cb.on_number(ctx, &sax, "0", 1));
-        ch = *p;
-        goto look_for_key;
-    }
-    case AJSON_NATURAL_NUMBER_CASE:
-        stringp = p - 1;
-        goto keyed_next_digit;
-    case 't':
-        if (p + 3 > ep) SAX_ERROR;
-        if (*p++ != 'r') SAX_ERROR;
-        if (*p++ != 'u') SAX_ERROR;
-        if (*p++ != 'e') SAX_ERROR;
-        if (sax.cb.on_bool) CHECK_CB(sax.cb.on_bool(ctx, &sax, true));
-        ch = *p;
-        goto look_for_key;
-    case 'f':
-        if (p + 4 > ep) SAX_ERROR;
-        if (*p++ != 'a') SAX_ERROR;
-        if (*p++ != 'l') SAX_ERROR;
-        if (*p++ != 's') SAX_ERROR;
-        if (*p++ != 'e') SAX_ERROR;
-        if (sax.cb.on_bool) CHECK_CB(sax.cb.on_bool(ctx, &sax, false));
-        ch = *p;
-        goto look_for_key;
-    case 'n':
-        if (p + 3 > ep) SAX_ERROR;
-        if (*p++ != 'u') SAX_ERROR;
-        if (*p++ != 'l') SAX_ERROR;
-        if (*p++ != 'l') SAX_ERROR;
-        if (sax.cb.on_null) CHECK_CB(sax.cb.on_null(ctx, &sax));
-        ch = *p;
-        goto look_for_key;
-    default:
-        SAX_ERROR;
-    };
-
-keyed_start_string:;
-    while (p < ep && *p != '\"') p++;
-    if (p >= ep) SAX_ERROR;
-    if (p[-1] == '\\') {
-        char *backtrack = p-1;
-        while(*backtrack == '\\') backtrack--;
-        if(((p-backtrack) & 1) == 0) {
-            p++;
-            goto keyed_start_string;
-        }
-    }
-    *p = 0;
-    if (sax.cb.on_string) CHECK_CB(sax.cb.on_string(ctx, &sax, stringp, p - stringp));
+/* ========================================================================
+ * PUBLIC API WRAPPERS
+ * ======================================================================== */
 
-    if (!destructive) {
-        *p = '\"'; /* Restore closing quote */
-    }
-    p++;
-    ch = *p;
-
-look_for_key:;
-    switch (ch) {
-    case ',':
-        if (p >= ep) SAX_ERROR;
-        p++;
-        after_comma = true;
-        goto start_key;
-    case '}':
-        if (after_comma) SAX_ERROR;
-        if (sax.cb.on_end_object) CHECK_CB(sax.cb.on_end_object(ctx, &sax));
-        SYNTAX_POP();
-        p++;
-        goto determine_next_step;
-    case AJSON_SPACE_CASE:
-        p++;
-        ch = *p;
-        goto look_for_key;
-    default:
-        SAX_ERROR;
-    };
-
-keyed_next_digit:;
-    ch = *p++;
-    while ((ch >= '0' && ch <= '9')) ch = *p++;
-
-    if (ch == '.') goto keyed_decimal_number;
-    if (ch == 'e' || ch == 'E') {
-        ch = *p++;
-        if (ch == '+' || ch == '-') ch = *p++;
-        if (ch < '0' || ch > '9') SAX_ERROR;
-        while (ch >= '0' && ch <= '9') ch = *p++;
-    }
-    p--; *p = 0;
-    if (sax.cb.on_number) CHECK_CB(sax.cb.on_number(ctx, &sax, stringp, p - stringp));
+int ajson_sax_parse(char *p, char *ep,
+                    const ajson_sax_cb_t *initial_cb,
+                    aml_pool_t *pool, void *ctx, char **error_at) {
+    return ajson_sax_parse_impl(p, ep, initial_cb, pool, ctx, error_at, 0, NULL, NULL, NULL);
+}
 
-    if (!destructive) {
-        *p = ch; /* Restore delimiter */
-    }
-    goto look_for_key;
-
-keyed_decimal_number:;
-    ch = *p++;
-    if (ch < '0' || ch > '9') SAX_ERROR;
-    while (ch >= '0' && ch <= '9') ch = *p++;
-
-    if (ch == 'e' || ch == 'E') {
-        ch = *p++;
-        if (ch == '+' || ch == '-') ch = *p++;
-        if (ch < '0' || ch > '9') SAX_ERROR;
-        while (ch >= '0' && ch <= '9') ch = *p++;
-    }
-    p--; *p = 0;
-    if (sax.cb.on_number) CHECK_CB(sax.cb.on_number(ctx, &sax, stringp, p - stringp));
+int ajson_sax_parse_destructive(char *p, char *ep,
+                                const ajson_sax_cb_t *initial_cb,
+                                aml_pool_t *pool, void *ctx, char **error_at) {
+    return ajson_sax_parse_impl(p, ep, initial_cb, pool, ctx, error_at,
+                                AJSON_SAX_DESTRUCTIVE, NULL, NULL, NULL);
+}
 
-    if (!destructive) {
-        *p = ch; /* Restore delimiter */
-    }
-    goto look_for_key;
-
-start_value:;
-    if (p >= ep) SAX_ERROR;
-    ch = *p++;
-    switch (ch) {
-    case '\"':
-        after_comma = false;
-        stringp = p;
-        goto start_string;
-    case AJSON_SPACE_CASE:
-        goto start_value;
-    case '{':
-        after_comma = false;
-        if (sax.cb.on_start_object) CHECK_CB(sax.cb.on_start_object(ctx, &sax));
-        SYNTAX_PUSH(SAX_MODE_OBJECT);
-        goto start_key;
-    case '[':
-        after_comma = false;
-        if (sax.cb.on_start_array) CHECK_CB(sax.cb.on_start_array(ctx, &sax));
-        SYNTAX_PUSH(SAX_MODE_ARRAY);
-        goto start_value;
-    case ']':
-        if (after_comma) SAX_ERROR;
-        if (sax.cb.on_end_array) CHECK_CB(sax.cb.on_end_array(ctx, &sax));
-        SYNTAX_POP();
-        goto determine_next_step;
-    case '-':
-        after_comma = false;
-        stringp = p - 1;
-        ch = *p++;
-        if (ch == '0') {
-            char la = *p;
-            if (la == '.') { p++; goto decimal_number; }
-            if (la == 'e' || la == 'E') { goto next_digit; }
-            if (la >= '0' && la <= '9') SAX_ERROR;
-            /* -0 */
-            if (sax.cb.on_number) CHECK_CB(sax.cb.on_number(ctx, &sax, "-0", 2));
-            ch = *p;
-            goto add_string;
-        } else if (ch >= '1' && ch <= '9') {
-            goto next_digit;
-        } else {
-            SAX_ERROR;
-        }
-    case '0': {
-        after_comma = false;
-        stringp = p - 1;
-        if (p < ep) {
-            char la = *p;
-            if (la == '.') { p++; goto decimal_number; }
-            if (la == 'e' || la == 'E') { goto next_digit; }
-            if (la >= '0' && la <= '9') { SAX_ERROR; }
-        }
-        if (sax.cb.on_number) CHECK_CB(sax.cb.on_number(ctx, &sax, "0", 1));
-        ch = *p;
-        goto add_string;
-    }
-    case AJSON_NATURAL_NUMBER_CASE:
-        after_comma = false;
-        stringp = p - 1;
-        goto next_digit;
-    case 't':
-        after_comma = false;
-        if (p + 3 > ep) SAX_ERROR;
-        if (*p++ != 'r') SAX_ERROR;
-        if (*p++ != 'u') SAX_ERROR;
-        if (*p++ != 'e') SAX_ERROR;
-        if (sax.cb.on_bool) CHECK_CB(sax.cb.on_bool(ctx, &sax, true));
-        ch = *p;
-        goto add_string;
-    case 'f':
-        after_comma = false;
-        if (p + 4 > ep) SAX_ERROR;
-        if (*p++ != 'a') SAX_ERROR;
-        if (*p++ != 'l') SAX_ERROR;
-        if (*p++ != 's') SAX_ERROR;
-        if (*p++ != 'e') SAX_ERROR;
-        if (sax.cb.on_bool) CHECK_CB(sax.cb.on_bool(ctx, &sax, false));
-        ch = *p;
-        goto add_string;
-    case 'n':
-        after_comma = false;
-        if (p + 3 > ep) SAX_ERROR;
-        if (*p++ != 'u') SAX_ERROR;
-        if (*p++ != 'l') SAX_ERROR;
-        if (*p++ != 'l') SAX_ERROR;
-        if (sax.cb.on_null) CHECK_CB(sax.cb.on_null(ctx, &sax));
-        ch = *p;
-        goto add_string;
-    default:
-        SAX_ERROR;
-    };
-
-start_string:;
-    while (p < ep && *p != '\"') p++;
-    if (p >= ep) SAX_ERROR;
-    if (p[-1] == '\\') {
-        char *backtrack = p-1;
-        while(*backtrack == '\\') backtrack--;
-        if(((p-backtrack) & 1) == 0) {
-            p++;
-            goto start_string;
-        }
-    }
-    *p = 0;
-    if (sax.cb.on_string) CHECK_CB(sax.cb.on_string(ctx, &sax, stringp, p - stringp));
+/* One constant instantiation per option combination, indexed by flags. */
+#define AJSON_SAX_VARIANT(name, flags)                                         \
+    static int name(char *p, char *ep, const ajson_sax_cb_t *initial_cb,       \
+                    aml_pool_t *pool, void *ctx, char **error_at) {            \
+        return ajson_sax_parse_impl(p, ep, initial_cb, pool, ctx, error_at,    \
+                                    (flags), NULL, NULL, NULL);                \
+    }
+
+AJSON_SAX_VARIANT(ajson_sax_parse_d, AJSON_SAX_DECODE_STRINGS)
+AJSON_SAX_VARIANT(ajson_sax_parse_xd, AJSON_SAX_DESTRUCTIVE | AJSON_SAX_DECODE_STRINGS)
+AJSON_SAX_VARIANT(ajson_sax_parse_v, AJSON_SAX_VALIDATE_UTF8)
+AJSON_SAX_VARIANT(ajson_sax_parse_xv, AJSON_SAX_DESTRUCTIVE | AJSON_SAX_VALIDATE_UTF8)
+AJSON_SAX_VARIANT(ajson_sax_parse_dv, AJSON_SAX_DECODE_STRINGS | AJSON_SAX_VALIDATE_UTF8)
+AJSON_SAX_VARIANT(ajson_sax_parse_xdv, AJSON_SAX_DESTRUCTIVE | AJSON_SAX_DECODE_STRINGS |
+                                       AJSON_SAX_VALIDATE_UTF8)
+
+typedef int (*ajson_sax_variant_t)(char *p, char *ep, const ajson_sax_cb_t *initial_cb,
+                                   aml_pool_t *pool, void *ctx, char **error_at);
+
+static const ajson_sax_variant_t ajson_sax_variants[8] = {
+    ajson_sax_parse,     ajson_sax_parse_destructive,
+    ajson_sax_parse_d,   ajson_sax_parse_xd,
+    ajson_sax_parse_v,   ajson_sax_parse_xv,
+    ajson_sax_parse_dv,  ajson_sax_parse_xdv
+};
+
+int ajson_sax_parse_ex(char *p, char *ep,
+                       const ajson_sax_cb_t *initial_cb,
+                       aml_pool_t *pool, void *ctx, char **error_at,
+                       unsigned flags) {
+    return ajson_sax_variants[flags & 7](p, ep, initial_cb, pool, ctx, error_at);
+}
 
-    if (!destructive) {
-        *p = '\"'; /* Restore closing quote */
-    }
-    p++;
-    ch = *p;
-
-add_string:;
-    goto look_for_next_object;
-
-look_for_next_object:;
-    switch (ch) {
-    case ',':
-        if (p >= ep) SAX_ERROR;
-        p++;
-        after_comma = true;
-        goto start_value;
-    case ']':
-        if (after_comma) SAX_ERROR;
-        if (sax.cb.on_end_array) CHECK_CB(sax.cb.on_end_array(ctx, &sax));
-        SYNTAX_POP();
-        p++;
-        goto determine_next_step;
-    case AJSON_SPACE_CASE:
-        p++;
-        if (p >= ep) {
-            if (stack_depth == 0) return 0;
-            SAX_ERROR;
-        }
-        ch = *p;
-        goto look_for_next_object;
-    case 0:
-        if (stack_depth == 0) return 0;
-        SAX_ERROR;
-    default:
-        SAX_ERROR;
-    };
-
-next_digit:;
-    ch = *p++;
-    while ((ch >= '0' && ch <= '9')) ch = *p++;
-
-    if (ch == '.') goto decimal_number;
-    if (ch == 'e' || ch == 'E') {
-        ch = *p++;
-        if (ch == '+' || ch == '-') ch = *p++;
-        if (ch < '0' || ch > '9') SAX_ERROR;
-        while (ch >= '0' && ch <= '9') ch = *p++;
-    }
-    p--; *p = 0;
-    if (sax.cb.on_number) CHECK_CB(sax.cb.on_number(ctx, &sax, stringp, p - stringp));
+int ajson_sax_parse_stats(char *p, char *ep,
+                          const ajson_sax_cb_t *initial_cb,
+                          aml_pool_t *pool, void *ctx, char **error_at,
+                          unsigned flags, ajson_sax_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    size_t pool_before = aml_pool_used(pool);
+    uint64_t t0 = (flags & AJSON_SAX_TIME_CALLBACKS) ? ajson_sax_clock_ns() : 0;
+
+    /* Diagnostics path: one instantiation with run-time option checks */
+    int rc = ajson_sax_parse_impl(p, ep, initial_cb, pool, ctx, error_at, flags, stats, NULL, NULL);
+
+    if (flags & AJSON_SAX_TIME_CALLBACKS) stats->total_ns = ajson_sax_clock_ns() - t0;
+    size_t pool_after = aml_pool_used(pool);
+    stats->pool_bytes = pool_after > pool_before ? pool_after - pool_before : 0;
+    return rc;
+}
 
-    if (!destructive) {
-        *p = ch; /* Restore delimiter */
-    }
-    goto add_string;
-
-decimal_number:;
-    ch = *p++;
-    if (ch < '0' || ch > '9') SAX_ERROR;
-    while (ch >= '0' && ch <= '9') ch = *p++;
-
-    if (ch == 'e' || ch == 'E') {
-        ch = *p++;
-        if (ch == '+' || ch == '-') ch = *p++;
-        if (ch < '0' || ch > '9') SAX_ERROR;
-        while (ch >= '0' && ch <= '9') ch = *p++;
-    }
-    p--; *p = 0;
-    if (sax.cb.on_number) CHECK_CB(sax.cb.on_number(ctx, &sax, stringp, p - stringp));
+/* ========================================================================
+ * BATCHES OF DOCUMENTS
+ * ======================================================================== */
 
-    if (!destructive) {
-        *p = ch; /* Restore delimiter */
-    }
-    goto add_string;
+/* How many documents ahead of the one being parsed are prefetched, and how
+   many cache lines of each.  Small messages fit in the lines fetched; for
+   longer ones the hardware prefetcher takes over once the parse streams. */
+#define AJSON_SAX_BATCH_AHEAD 4
+#define AJSON_SAX_BATCH_LINES 4
+
+static inline void ajson_sax_batch_prefetch(const struct iovec *doc, void *ctx) {
+    const char *b = (const char *)doc->iov_base;
+    size_t len = doc->iov_len < AJSON_SAX_BATCH_LINES * 64 ? doc->iov_len
+                                                            : AJSON_SAX_BATCH_LINES * 64;
+    for (size_t off = 0; off < len; off += 64) __builtin_prefetch(b + off, 0, 3);
+    if (ctx) __builtin_prefetch(ctx, 1, 3);
+}
 
-determine_next_step:
-    if (stack_depth == 0) return 0;
+size_t ajson_sax_parse_batch(const struct iovec *docs, size_t n,
+                             const ajson_sax_cb_t *initial_cb,
+                             aml_pool_t *pool, void *const *ctxs,
+                             int *status, char **error_at, unsigned flags) {
+    ajson_sax_variant_t parse = ajson_sax_variants[flags & 7];
+    size_t failed = 0;
+
+    for (size_t i = 0; i < n && i < AJSON_SAX_BATCH_AHEAD; i++)
+        ajson_sax_batch_prefetch(&docs[i], ctxs ? ctxs[i] : NULL);
+
+    for (size_t i = 0; i < n; i++) {
+        size_t ahead = i + AJSON_SAX_BATCH_AHEAD;
+        if (ahead < n) ajson_sax_batch_prefetch(&docs[ahead], ctxs ? ctxs[ahead] : NULL);
+
+        char *p = (char *)docs[i].iov_base;
+        char *err = NULL;
+        int rc = parse(p, p + docs[i].iov_len, initial_cb, pool,
+                       ctxs ? ctxs[i] : NULL, &err);
+        status[i] = rc;
+        if (error_at) error_at[i] = rc ? err : NULL;
+        if (rc) failed++;
+    }
+    return failed;
+}
 
-    if (p >= ep) return 0;
-    ch = *p;
+/* ========================================================================
+ * REUSABLE PARSER
+ * ======================================================================== */
 
-    if (CURRENT_MODE() == SAX_MODE_OBJECT) {
-        goto look_for_key;
-    } else {
-        goto look_for_next_object;
-    }
+struct ajson_sax_parser_s {
+    ajson_sax_variant_t parse;
+    const ajson_sax_cb_t *initial_cb;
+    aml_pool_t *pool;
+};
+
+ajson_sax_parser_t *ajson_sax_parser_init(const ajson_sax_cb_t *initial_cb,
+                                          unsigned flags, size_t pool_size) {
+    ajson_sax_parser_t *ps = (ajson_sax_parser_t *)aml_malloc(sizeof(ajson_sax_parser_t));
+    ps->parse = ajson_sax_variants[flags & 7];
+    ps->initial_cb = initial_cb;
+    ps->pool = aml_pool_init(pool_size ? pool_size : 4096);
+    return ps;
+}
 
-    SAX_ERROR;
+int ajson_sax_parser_parse(ajson_sax_parser_t *ps, char *p, char *ep,
+                           void *ctx, char **error_at) {
+    aml_pool_clear(ps->pool);
+    return ps->parse(p, ep, ps->initial_cb, ps->pool, ctx, error_at);
 }
 
-/* ========================================================================
- * PUBLIC API WRAPPERS
- * ======================================================================== */
+aml_pool_t *ajson_sax_parser_pool(ajson_sax_parser_t *ps) {
+    return ps->pool;
+}
 
-int ajson_sax_parse(char *p, char *ep,
-                    const ajson_sax_cb_t *initial_cb,
-                    aml_pool_t *pool, void *ctx, char **error_at) {
-    return ajson_sax_parse_impl(p, ep, initial_cb, pool, ctx, error_at, false);
+void ajson_sax_parser_reset(ajson_sax_parser_t *ps) {
+    aml_pool_clear(ps->pool);
 }
 
-int ajson_sax_parse_destructive(char *p, char *ep,
-                                const ajson_sax_cb_t *initial_cb,
-                                aml_pool_t *pool, void *ctx, char **error_at) {
-    return ajson_sax_parse_impl(p, ep, initial_cb, pool, ctx, error_at, true);
+void ajson_sax_parser_destroy(ajson_sax_parser_t *ps) {
+    aml_pool_destroy(ps->pool);
+    aml_free(ps);
 }
@@ -0,0 +1,199 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#include "a-json-sax-library/ajson_sax_decompress.h"
+#include "a-json-sax-library/ajson_sax_stream.h"
+#include "a-memory-library/aml_alloc.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef AJSON_SAX_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef AJSON_SAX_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#if defined(AJSON_SAX_HAVE_ZLIB) || defined(AJSON_SAX_HAVE_ZSTD)
+
+/* Compressed input: all in memory, or read a block at a time */
+typedef struct {
+    const unsigned char *next;
+    size_t avail;
+    int fd;                     /* -1 for memory */
+    bool eof;
+    unsigned char *buf;
+} ajson_sax_input_t;
+
+static void ajson_sax_input_init(ajson_sax_input_t *in, const void *data, size_t len, int fd) {
+    in->next = (const unsigned char *)data;
+    in->avail = len;
+    in->fd = fd;
+    in->eof = fd < 0;
+    in->buf = fd < 0 ? NULL : (unsigned char *)aml_malloc(AJSON_SAX_DECOMPRESS_BLOCK);
+}
+
+/* Read the next block once the last one is used up.  Returns false on a
+   read error. */
+static bool ajson_sax_input_fill(ajson_sax_input_t *in) {
+    if (in->avail || in->eof) return true;
+    ssize_t n;
+    do {
+        n = read(in->fd, in->buf, AJSON_SAX_DECOMPRESS_BLOCK);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) return false;
+    in->eof = n == 0;
+    in->next = in->buf;
+    in->avail = (size_t)n;
+    return true;
+}
+
+static int ajson_sax_input_done(ajson_sax_input_t *in, int rc) {
+    int err = errno;
+    if (in->buf) aml_free(in->buf);
+    errno = err;
+    return rc;
+}
+
+#endif
+
+/* ---------- gzip / zlib ---------- */
+
+#ifdef AJSON_SAX_HAVE_ZLIB
+
+static int ajson_sax_gzip_run(ajson_sax_input_t *in, const ajson_sax_cb_t *initial_cb,
+                              aml_pool_t *pool, void *ctx, unsigned flags) {
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    if (inflateInit2(&z, 15 + 32) != Z_OK)   /* 32: detect the gzip or zlib header */
+        return ajson_sax_input_done(in, AJSON_SAX_DECOMPRESS_ERROR);
+
+    ajson_sax_stream_t *s = ajson_sax_stream_init(initial_cb, pool, ctx, flags);
+    bool member_done = false;   /* Z_STREAM_END: another member may follow */
+    bool pending = false;       /* The last block was filled: more output may be waiting */
+    int rc = 0;
+    for (;;) {
+        if (!ajson_sax_input_fill(in)) {
+            rc = AJSON_SAX_DECOMPRESS_IO_ERROR;
+            break;
+        }
+        if (!in->avail && in->eof && !pending) {
+            if (!member_done) rc = AJSON_SAX_DECOMPRESS_ERROR;   /* Truncated */
+            break;
+        }
+        if (member_done) {
+            inflateReset(&z);
+            member_done = false;
+        }
+
+        uInt take = in->avail > UINT_MAX ? UINT_MAX : (uInt)in->avail;
+        z.next_in = (Bytef *)in->next;
+        z.avail_in = take;
+        z.next_out = (Bytef *)ajson_sax_stream_reserve(s, AJSON_SAX_DECOMPRESS_BLOCK);
+        z.avail_out = AJSON_SAX_DECOMPRESS_BLOCK;
+        int zr = inflate(&z, Z_NO_FLUSH);
+        in->next += take - z.avail_in;
+        in->avail -= take - z.avail_in;
+
+        if ((rc = ajson_sax_stream_commit(s, AJSON_SAX_DECOMPRESS_BLOCK - z.avail_out))) break;
+        if (ajson_sax_stream_done(s)) break;
+        if (zr == Z_STREAM_END) {
+            member_done = true;
+        } else if (zr != Z_OK && zr != Z_BUF_ERROR) {
+            rc = AJSON_SAX_DECOMPRESS_ERROR;
+            break;
+        }
+        pending = !member_done && z.avail_out == 0;
+    }
+    if (!rc) rc = ajson_sax_stream_finish(s);
+
+    ajson_sax_stream_destroy(s);
+    inflateEnd(&z);
+    return ajson_sax_input_done(in, rc);
+}
+
+int ajson_sax_parse_gzip(const void *data, size_t len,
+                         const ajson_sax_cb_t *initial_cb, aml_pool_t *pool,
+                         void *ctx, unsigned flags) {
+    ajson_sax_input_t in;
+    ajson_sax_input_init(&in, data, len, -1);
+    return ajson_sax_gzip_run(&in, initial_cb, pool, ctx, flags);
+}
+
+int ajson_sax_parse_gzip_fd(int fd,
+                            const ajson_sax_cb_t *initial_cb, aml_pool_t *pool,
+                            void *ctx, unsigned flags) {
+    ajson_sax_input_t in;
+    ajson_sax_input_init(&in, NULL, 0, fd);
+    return ajson_sax_gzip_run(&in, initial_cb, pool, ctx, flags);
+}
+
+#endif /* AJSON_SAX_HAVE_ZLIB */
+
+/* ---------- zstd ---------- */
+
+#ifdef AJSON_SAX_HAVE_ZSTD
+
+static int ajson_sax_zstd_run(ajson_sax_input_t *in, const ajson_sax_cb_t *initial_cb,
+                              aml_pool_t *pool, void *ctx, unsigned flags) {
+    ZSTD_DCtx *d = ZSTD_createDCtx();
+    if (!d) return ajson_sax_input_done(in, AJSON_SAX_DECOMPRESS_ERROR);
+
+    ajson_sax_stream_t *s = ajson_sax_stream_init(initial_cb, pool, ctx, flags);
+    bool frame_done = false;    /* At a frame boundary */
+    bool pending = false;       /* The last block was filled: more output may be waiting */
+    int rc = 0;
+    for (;;) {
+        if (!ajson_sax_input_fill(in)) {
+            rc = AJSON_SAX_DECOMPRESS_IO_ERROR;
+            break;
+        }
+        if (!in->avail && in->eof && !pending) {
+            if (!frame_done) rc = AJSON_SAX_DECOMPRESS_ERROR;    /* Truncated */
+            break;
+        }
+
+        ZSTD_inBuffer ib = { in->next, in->avail, 0 };
+        ZSTD_outBuffer ob = { ajson_sax_stream_reserve(s, AJSON_SAX_DECOMPRESS_BLOCK),
+                              AJSON_SAX_DECOMPRESS_BLOCK, 0 };
+        size_t zr = ZSTD_decompressStream(d, &ob, &ib);
+        in->next += ib.pos;
+        in->avail -= ib.pos;
+
+        if ((rc = ajson_sax_stream_commit(s, ob.pos))) break;
+        if (ZSTD_isError(zr)) {
+            rc = AJSON_SAX_DECOMPRESS_ERROR;
+            break;
+        }
+        if (ajson_sax_stream_done(s)) break;
+        frame_done = zr == 0;
+        pending = !frame_done && ob.pos == ob.size;
+    }
+    if (!rc) rc = ajson_sax_stream_finish(s);
+
+    ajson_sax_stream_destroy(s);
+    ZSTD_freeDCtx(d);
+    return ajson_sax_input_done(in, rc);
+}
+
+int ajson_sax_parse_zstd(const void *data, size_t len,
+                         const ajson_sax_cb_t *initial_cb, aml_pool_t *pool,
+                         void *ctx, unsigned flags) {
+    ajson_sax_input_t in;
+    ajson_sax_input_init(&in, data, len, -1);
+    return ajson_sax_zstd_run(&in, initial_cb, pool, ctx, flags);
+}
+
+int ajson_sax_parse_zstd_fd(int fd,
+                            const ajson_sax_cb_t *initial_cb, aml_pool_t *pool,
+                            void *ctx, unsigned flags) {
+    ajson_sax_input_t in;
+    ajson_sax_input_init(&in, NULL, 0, fd);
+    return ajson_sax_zstd_run(&in, initial_cb, pool, ctx, flags);
+}
+
+#endif /* AJSON_SAX_HAVE_ZSTD */
@@ -0,0 +1,492 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#define _GNU_SOURCE /* O_DIRECT */
+
+#include "a-json-sax-library/ajson_sax_ingest.h"
+#include "a-json-sax-library/ajson_sax_stream.h"
+#include "a-memory-library/aml_alloc.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define AJSON_SAX_INGEST_HAVE_URING 1
+#endif
+#endif
+
+/* Buffer alignment and size granularity (what O_DIRECT needs) */
+#define AJSON_SAX_INGEST_ALIGN 4096
+
+enum { AJSON_SAX_SLOT_FREE, AJSON_SAX_SLOT_BUSY, AJSON_SAX_SLOT_READY };
+
+/* One piece of one file */
+typedef struct {
+    char *buf;
+    struct iovec iov;           /* buf and the (aligned) read length */
+    size_t want;                /* Bytes before the end of the file */
+    int fd;
+    size_t file;
+    off_t offset;
+    ssize_t result;             /* Bytes read or -errno */
+    int state;
+    bool first;
+    bool last;
+} ajson_sax_ingest_slot_t;
+
+typedef struct ajson_sax_ingest_s ajson_sax_ingest_t;
+
+struct ajson_sax_ingest_s {
+    const char *const *paths;
+    size_t num_paths;
+    size_t buffer_size;
+    unsigned depth;
+    bool direct;
+
+    ajson_sax_ingest_slot_t *slots;
+    char *buffers;
+    uint64_t issued;            /* Pieces handed to the backend */
+    uint64_t consumed;          /* Pieces parsed */
+
+    /* Read-ahead position */
+    size_t next_file;
+    int next_fd;
+    off_t next_offset;
+    off_t next_size;
+
+    /* Backend */
+    void (*submit)(ajson_sax_ingest_t *t, ajson_sax_ingest_slot_t *s);
+    void (*flush)(ajson_sax_ingest_t *t);
+    void (*wait)(ajson_sax_ingest_t *t, ajson_sax_ingest_slot_t *s);
+    void (*shutdown)(ajson_sax_ingest_t *t);   /* Waits for reads in flight */
+
+#ifdef AJSON_SAX_INGEST_HAVE_URING
+    struct {
+        int fd;
+        unsigned *sq_tail, *sq_mask, *sq_array;
+        unsigned *cq_head, *cq_tail, *cq_mask;
+        struct io_uring_sqe *sqes;
+        struct io_uring_cqe *cqes;
+        void *sq_ring, *cq_ring;
+        size_t sq_ring_size, cq_ring_size, sqes_size;
+        unsigned queued;        /* In the ring, not yet submitted */
+        unsigned in_flight;
+    } uring;
+#endif
+
+    /* Thread pool */
+    pthread_t *threads;
+    unsigned num_threads;
+    pthread_mutex_t mutex;
+    pthread_cond_t work;
+    pthread_cond_t done;
+    ajson_sax_ingest_slot_t **queue;
+    uint64_t queue_head;
+    uint64_t queue_tail;
+    bool stop;
+};
+
+/* pread() until the end of the piece, the end of the file or an error. */
+static ssize_t ajson_sax_ingest_pread(ajson_sax_ingest_slot_t *s, size_t got) {
+    while (got < s->want) {
+        ssize_t r = pread(s->fd, s->buf + got, s->iov.iov_len - got, s->offset + (off_t)got);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return -errno;
+        }
+        if (!r) break;
+        got += (size_t)r;
+    }
+    return (ssize_t)got;
+}
+
+/* ---------- io_uring backend (raw system calls, no liburing) ---------- */
+
+#ifdef AJSON_SAX_INGEST_HAVE_URING
+
+static int ajson_sax_uring_syscall_enter(int fd, unsigned to_submit, unsigned min_complete,
+                                         unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static void ajson_sax_uring_enter(ajson_sax_ingest_t *t, unsigned min_complete) {
+    int r;
+    do {
+        r = ajson_sax_uring_syscall_enter(t->uring.fd, t->uring.queued, min_complete,
+                                          min_complete ? IORING_ENTER_GETEVENTS : 0);
+    } while (r < 0 && errno == EINTR);
+    if (r >= 0) {
+        t->uring.queued -= (unsigned)r;
+        return;
+    }
+
+    /* Nothing was submitted: take the waiting entries back and fail them */
+    int err = errno;
+    unsigned tail = *t->uring.sq_tail;
+    while (t->uring.queued) {
+        tail--;
+        t->uring.queued--;
+        t->uring.in_flight--;
+        struct io_uring_sqe *sqe = t->uring.sqes + (tail & *t->uring.sq_mask);
+        ajson_sax_ingest_slot_t *s = (ajson_sax_ingest_slot_t *)(uintptr_t)sqe->user_data;
+        s->result = -err;
+        s->state = AJSON_SAX_SLOT_READY;
+    }
+    __atomic_store_n(t->uring.sq_tail, tail, __ATOMIC_RELEASE);
+}
+
+static void ajson_sax_uring_submit(ajson_sax_ingest_t *t, ajson_sax_ingest_slot_t *s) {
+    unsigned tail = *t->uring.sq_tail;
+    unsigned index = tail & *t->uring.sq_mask;
+    struct io_uring_sqe *sqe = t->uring.sqes + index;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = s->fd;
+    sqe->addr = (uint64_t)(uintptr_t)&s->iov;
+    sqe->len = 1;
+    sqe->off = (uint64_t)s->offset;
+    sqe->user_data = (uint64_t)(uintptr_t)s;
+    t->uring.sq_array[index] = index;
+    __atomic_store_n(t->uring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+    t->uring.queued++;
+    t->uring.in_flight++;
+}
+
+static void ajson_sax_uring_flush(ajson_sax_ingest_t *t) {
+    if (t->uring.queued) ajson_sax_uring_enter(t, 0);
+}
+
+static void ajson_sax_uring_reap(ajson_sax_ingest_t *t) {
+    unsigned head = *t->uring.cq_head;
+    while (head != __atomic_load_n(t->uring.cq_tail, __ATOMIC_ACQUIRE)) {
+        struct io_uring_cqe *cqe = t->uring.cqes + (head & *t->uring.cq_mask);
+        ajson_sax_ingest_slot_t *s = (ajson_sax_ingest_slot_t *)(uintptr_t)cqe->user_data;
+        s->result = cqe->res;
+        s->state = AJSON_SAX_SLOT_READY;
+        t->uring.in_flight--;
+        head++;
+    }
+    __atomic_store_n(t->uring.cq_head, head, __ATOMIC_RELEASE);
+}
+
+static void ajson_sax_uring_wait(ajson_sax_ingest_t *t, ajson_sax_ingest_slot_t *s) {
+    for (;;) {
+        ajson_sax_uring_reap(t);
+        if (s->state == AJSON_SAX_SLOT_READY) return;
+        ajson_sax_uring_enter(t, 1);
+    }
+}
+
+static void ajson_sax_uring_shutdown(ajson_sax_ingest_t *t) {
+    for (;;) {
+        ajson_sax_uring_reap(t);
+        if (!t->uring.in_flight) break;
+        ajson_sax_uring_enter(t, 1);
+    }
+    munmap(t->uring.sqes, t->uring.sqes_size);
+    if (t->uring.cq_ring != t->uring.sq_ring) munmap(t->uring.cq_ring, t->uring.cq_ring_size);
+    munmap(t->uring.sq_ring, t->uring.sq_ring_size);
+    close(t->uring.fd);
+}
+
+static bool ajson_sax_uring_init(ajson_sax_ingest_t *t) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    int fd = (int)syscall(__NR_io_uring_setup, t->depth, &p);
+    if (fd < 0) return false;   /* ENOSYS, EPERM under seccomp, ... */
+
+    t->uring.sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    t->uring.cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single && t->uring.cq_ring_size > t->uring.sq_ring_size)
+        t->uring.sq_ring_size = t->uring.cq_ring_size;
+    t->uring.sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+
+    void *sq = mmap(NULL, t->uring.sq_ring_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    void *cq = single ? sq : mmap(NULL, t->uring.cq_ring_size, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    void *sqes = mmap(NULL, t->uring.sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sq == MAP_FAILED || cq == MAP_FAILED || sqes == MAP_FAILED) {
+        if (sqes != MAP_FAILED) munmap(sqes, t->uring.sqes_size);
+        if (cq != MAP_FAILED && cq != sq) munmap(cq, t->uring.cq_ring_size);
+        if (sq != MAP_FAILED) munmap(sq, t->uring.sq_ring_size);
+        close(fd);
+        return false;
+    }
+
+    t->uring.fd = fd;
+    t->uring.sq_ring = sq;
+    t->uring.cq_ring = cq;
+    t->uring.sq_tail = (unsigned *)((char *)sq + p.sq_off.tail);
+    t->uring.sq_mask = (unsigned *)((char *)sq + p.sq_off.ring_mask);
+    t->uring.sq_array = (unsigned *)((char *)sq + p.sq_off.array);
+    t->uring.cq_head = (unsigned *)((char *)cq + p.cq_off.head);
+    t->uring.cq_tail = (unsigned *)((char *)cq + p.cq_off.tail);
+    t->uring.cq_mask = (unsigned *)((char *)cq + p.cq_off.ring_mask);
+    t->uring.cqes = (struct io_uring_cqe *)((char *)cq + p.cq_off.cqes);
+    t->uring.sqes = (struct io_uring_sqe *)sqes;
+    t->uring.queued = 0;
+    t->uring.in_flight = 0;
+
+    t->submit = ajson_sax_uring_submit;
+    t->flush = ajson_sax_uring_flush;
+    t->wait = ajson_sax_uring_wait;
+    t->shutdown = ajson_sax_uring_shutdown;
+    return true;
+}
+
+#endif /* AJSON_SAX_INGEST_HAVE_URING */
+
+/* ---------- Thread pool backend ---------- */
+
+static void *ajson_sax_ingest_worker(void *arg) {
+    ajson_sax_ingest_t *t = (ajson_sax_ingest_t *)arg;
+    pthread_mutex_lock(&t->mutex);
+    for (;;) {
+        while (!t->stop && t->queue_head == t->queue_tail)
+            pthread_cond_wait(&t->work, &t->mutex);
+        if (t->stop) break;
+        ajson_sax_ingest_slot_t *s = t->queue[t->queue_head++ % t->depth];
+        pthread_mutex_unlock(&t->mutex);
+
+        ssize_t r = ajson_sax_ingest_pread(s, 0);
+
+        pthread_mutex_lock(&t->mutex);
+        s->result = r;
+        s->state = AJSON_SAX_SLOT_READY;
+        pthread_cond_broadcast(&t->done);
+    }
+    pthread_mutex_unlock(&t->mutex);
+    return NULL;
+}
+
+static void ajson_sax_pool_submit(ajson_sax_ingest_t *t, ajson_sax_ingest_slot_t *s) {
+    if (!t->num_threads) {  /* No threads could be started: read now */
+        s->result = ajson_sax_ingest_pread(s, 0);
+        s->state = AJSON_SAX_SLOT_READY;
+        return;
+    }
+    pthread_mutex_lock(&t->mutex);
+    t->queue[t->queue_tail++ % t->depth] = s;
+    pthread_cond_signal(&t->work);
+    pthread_mutex_unlock(&t->mutex);
+}
+
+static void ajson_sax_pool_flush(ajson_sax_ingest_t *t) {
+    (void)t;
+}
+
+static void ajson_sax_pool_wait(ajson_sax_ingest_t *t, ajson_sax_ingest_slot_t *s) {
+    pthread_mutex_lock(&t->mutex);
+    while (s->state != AJSON_SAX_SLOT_READY)
+        pthread_cond_wait(&t->done, &t->mutex);
+    pthread_mutex_unlock(&t->mutex);
+}
+
+static void ajson_sax_pool_shutdown(ajson_sax_ingest_t *t) {
+    pthread_mutex_lock(&t->mutex);
+    t->stop = true;
+    pthread_cond_broadcast(&t->work);
+    pthread_mutex_unlock(&t->mutex);
+    for (unsigned i = 0; i < t->num_threads; i++) pthread_join(t->threads[i], NULL);
+
+    pthread_cond_destroy(&t->done);
+    pthread_cond_destroy(&t->work);
+    pthread_mutex_destroy(&t->mutex);
+    aml_free(t->queue);
+    aml_free(t->threads);
+}
+
+static void ajson_sax_pool_init(ajson_sax_ingest_t *t, unsigned threads) {
+    pthread_mutex_init(&t->mutex, NULL);
+    pthread_cond_init(&t->work, NULL);
+    pthread_cond_init(&t->done, NULL);
+    t->queue = (ajson_sax_ingest_slot_t **)aml_calloc(t->depth * sizeof(*t->queue));
+    t->queue_head = t->queue_tail = 0;
+    t->stop = false;
+    t->threads = (pthread_t *)aml_malloc(threads * sizeof(pthread_t));
+    t->num_threads = 0;
+    while (t->num_threads < threads &&
+           !pthread_create(t->threads + t->num_threads, NULL, ajson_sax_ingest_worker, t))
+        t->num_threads++;
+
+    t->submit = ajson_sax_pool_submit;
+    t->flush = ajson_sax_pool_flush;
+    t->wait = ajson_sax_pool_wait;
+    t->shutdown = ajson_sax_pool_shutdown;
+}
+
+/* ---------- Read-ahead ---------- */
+
+static int ajson_sax_ingest_open(ajson_sax_ingest_t *t, const char *path) {
+    int fd = -1;
+#ifdef O_DIRECT
+    if (t->direct) {
+        fd = open(path, O_RDONLY | O_CLOEXEC | O_DIRECT);
+        if (fd >= 0 || errno != EINVAL) return fd;
+    }
+#endif
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    return fd;
+}
+
+/* Give 's' the next piece to read.  Returns false once every file has
+   been handed out. */
+static bool ajson_sax_ingest_plan(ajson_sax_ingest_t *t, ajson_sax_ingest_slot_t *s) {
+    s->first = t->next_fd < 0;
+    if (s->first) {
+        if (t->next_file >= t->num_paths) return false;
+        struct stat st;
+        int fd = ajson_sax_ingest_open(t, t->paths[t->next_file]);
+        if (fd < 0 || fstat(fd, &st)) {
+            s->result = -errno;
+            if (fd >= 0) close(fd);
+            s->fd = -1;
+            s->file = t->next_file++;
+            s->last = true;
+            s->state = AJSON_SAX_SLOT_READY;
+            return true;
+        }
+        t->next_fd = fd;
+        t->next_offset = 0;
+        t->next_size = st.st_size;
+    }
+
+    s->fd = t->next_fd;
+    s->file = t->next_file;
+    s->offset = t->next_offset;
+    s->iov.iov_base = s->buf;
+    s->iov.iov_len = t->buffer_size;
+    s->want = t->next_size - s->offset < (off_t)t->buffer_size
+              ? (size_t)(t->next_size - s->offset) : t->buffer_size;
+    t->next_offset += (off_t)t->buffer_size;
+    s->last = t->next_offset >= t->next_size;
+    if (s->last) {
+        t->next_fd = -1;
+        t->next_file++;
+    }
+    if (!s->want) {     /* Empty file */
+        s->result = 0;
+        s->state = AJSON_SAX_SLOT_READY;
+        return true;
+    }
+    s->state = AJSON_SAX_SLOT_BUSY;
+    t->submit(t, s);
+    return true;
+}
+
+static void ajson_sax_ingest_fill(ajson_sax_ingest_t *t) {
+    while (t->issued - t->consumed < t->depth &&
+           ajson_sax_ingest_plan(t, t->slots + t->issued % t->depth))
+        t->issued++;
+    t->flush(t);
+}
+
+/* ---------- Driver ---------- */
+
+int ajson_sax_ingest(const char *const *paths, size_t num_paths,
+                     const ajson_sax_cb_t *initial_cb,
+                     const ajson_sax_ingest_file_cb_t *file_cb, void *arg,
+                     aml_pool_t *pool, unsigned flags,
+                     const ajson_sax_ingest_options_t *options) {
+    ajson_sax_ingest_options_t o = { 0, 0, 0, 0 };
+    if (options) o = *options;
+    if (!o.queue_depth) o.queue_depth = 8;
+    if (!o.buffer_size) o.buffer_size = 1 << 20;
+    o.buffer_size = (o.buffer_size + AJSON_SAX_INGEST_ALIGN - 1) & ~(size_t)(AJSON_SAX_INGEST_ALIGN - 1);
+    if (!o.threads) o.threads = o.queue_depth;
+
+    ajson_sax_ingest_t t;
+    memset(&t, 0, sizeof(t));
+    t.paths = paths;
+    t.num_paths = num_paths;
+    t.buffer_size = o.buffer_size;
+    t.depth = o.queue_depth;
+    t.direct = (o.flags & AJSON_SAX_INGEST_DIRECT) != 0;
+    t.next_fd = -1;
+    t.buffers = (char *)aligned_alloc(AJSON_SAX_INGEST_ALIGN, t.depth * t.buffer_size);
+    if (!t.buffers) {
+        errno = ENOMEM;
+        return AJSON_SAX_INGEST_IO_ERROR;
+    }
+    t.slots = (ajson_sax_ingest_slot_t *)aml_calloc(t.depth * sizeof(ajson_sax_ingest_slot_t));
+    for (unsigned i = 0; i < t.depth; i++) t.slots[i].buf = t.buffers + i * t.buffer_size;
+
+    bool uring = false;
+#ifdef AJSON_SAX_INGEST_HAVE_URING
+    if (!(o.flags & AJSON_SAX_INGEST_NO_URING)) uring = ajson_sax_uring_init(&t);
+#endif
+    if (!uring) ajson_sax_pool_init(&t, o.threads);
+
+    ajson_sax_stream_t *stream = NULL;
+    void *ctx = NULL;
+    int file_rc = 0, file_errno = 0, rc = 0;
+
+    ajson_sax_ingest_fill(&t);
+    while (t.consumed < t.issued) {
+        ajson_sax_ingest_slot_t *s = t.slots + t.consumed % t.depth;
+        t.wait(&t, s);
+
+        if (s->first) {
+            const char *path = paths[s->file];
+            ctx = file_cb && file_cb->on_begin_file
+                  ? file_cb->on_begin_file(arg, s->file, path) : NULL;
+            stream = ajson_sax_stream_init(initial_cb, pool, ctx, flags);
+            file_rc = 0;
+        }
+        /* A short read that did not reach the end of the file is finished here */
+        if (s->result >= 0 && (size_t)s->result < s->want)
+            s->result = ajson_sax_ingest_pread(s, (size_t)s->result);
+
+        if (!file_rc) {
+            if (s->result < 0) {
+                file_errno = (int)-s->result;
+                file_rc = AJSON_SAX_INGEST_IO_ERROR;
+            } else if (s->result > 0) {
+                file_rc = ajson_sax_stream_feed(stream, s->buf, (size_t)s->result);
+            }
+            if (!file_rc && s->last) file_rc = ajson_sax_stream_finish(stream);
+        }
+
+        if (s->last) {
+            if (s->fd >= 0) close(s->fd);
+            ajson_sax_stream_destroy(stream);
+            stream = NULL;
+            if (file_rc == AJSON_SAX_INGEST_IO_ERROR) errno = file_errno;
+            rc = file_cb && file_cb->on_end_file
+                 ? file_cb->on_end_file(arg, s->file, paths[s->file], ctx, file_rc)
+                 : file_rc;
+        }
+        s->state = AJSON_SAX_SLOT_FREE;
+        t.consumed++;
+        if (rc) break;
+        ajson_sax_ingest_fill(&t);
+    }
+
+    /* Stopped early: let the reads finish before closing their files */
+    t.shutdown(&t);
+    for (uint64_t i = t.consumed; i < t.issued; i++) {
+        ajson_sax_ingest_slot_t *s = t.slots + i % t.depth;
+        if (s->last && s->fd >= 0) close(s->fd);
+    }
+    if (t.next_fd >= 0) close(t.next_fd);
+
+    aml_free(t.slots);
+    free(t.buffers);
+    return rc;
+}
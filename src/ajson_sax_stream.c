@@ -0,0 +1,324 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#define _GNU_SOURCE /* memfd_create */
+
+#include "a-json-sax-library/ajson_sax_stream.h"
+#include "a-json-sax-library/ajson_sax_impl.h"
+#include "a-memory-library/aml_alloc.h"
+#include "a-memory-library/aml_buffer.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+struct ajson_sax_stream_s {
+    const ajson_sax_cb_t *initial_cb;
+    aml_pool_t *pool;
+    void *ctx;
+    unsigned flags;
+    int rc;                     /* Sticky result */
+    aml_buffer_t *bh;           /* Unconsumed input followed by a NUL */
+    size_t base;                /* Input offset of the first buffered byte */
+    size_t offset;              /* See ajson_sax_stream_offset */
+    size_t reserved;            /* Room handed out by ajson_sax_stream_reserve */
+    ajson_sax_resume_t resume;
+};
+
+/* One resumable instantiation per option combination, indexed by flags. */
+#define AJSON_SAX_STREAM_VARIANT(name, flags)                                  \
+    static int name(char *p, char *ep, const ajson_sax_cb_t *initial_cb,       \
+                    aml_pool_t *pool, void *ctx, ajson_sax_resume_t *resume) { \
+        return ajson_sax_parse_impl(p, ep, initial_cb, pool, ctx, NULL,        \
+                                    (flags), NULL, NULL, resume);              \
+    }
+
+AJSON_SAX_STREAM_VARIANT(ajson_sax_stream_parse, 0)
+AJSON_SAX_STREAM_VARIANT(ajson_sax_stream_parse_x, AJSON_SAX_DESTRUCTIVE)
+AJSON_SAX_STREAM_VARIANT(ajson_sax_stream_parse_d, AJSON_SAX_DECODE_STRINGS)
+AJSON_SAX_STREAM_VARIANT(ajson_sax_stream_parse_xd, AJSON_SAX_DESTRUCTIVE | AJSON_SAX_DECODE_STRINGS)
+AJSON_SAX_STREAM_VARIANT(ajson_sax_stream_parse_v, AJSON_SAX_VALIDATE_UTF8)
+AJSON_SAX_STREAM_VARIANT(ajson_sax_stream_parse_xv, AJSON_SAX_DESTRUCTIVE | AJSON_SAX_VALIDATE_UTF8)
+AJSON_SAX_STREAM_VARIANT(ajson_sax_stream_parse_dv, AJSON_SAX_DECODE_STRINGS |
+                                                    AJSON_SAX_VALIDATE_UTF8)
+AJSON_SAX_STREAM_VARIANT(ajson_sax_stream_parse_xdv, AJSON_SAX_DESTRUCTIVE |
+                                                     AJSON_SAX_DECODE_STRINGS |
+                                                     AJSON_SAX_VALIDATE_UTF8)
+
+typedef int (*ajson_sax_stream_variant_t)(char *p, char *ep, const ajson_sax_cb_t *initial_cb,
+                                          aml_pool_t *pool, void *ctx,
+                                          ajson_sax_resume_t *resume);
+
+static const ajson_sax_stream_variant_t ajson_sax_stream_variants[8] = {
+    ajson_sax_stream_parse,     ajson_sax_stream_parse_x,
+    ajson_sax_stream_parse_d,   ajson_sax_stream_parse_xd,
+    ajson_sax_stream_parse_v,   ajson_sax_stream_parse_xv,
+    ajson_sax_stream_parse_dv,  ajson_sax_stream_parse_xdv
+};
+
+ajson_sax_stream_t *ajson_sax_stream_init(const ajson_sax_cb_t *initial_cb,
+                                          aml_pool_t *pool, void *ctx,
+                                          unsigned flags) {
+    ajson_sax_stream_t *s = (ajson_sax_stream_t *)aml_malloc(sizeof(ajson_sax_stream_t));
+    s->initial_cb = initial_cb;
+    s->pool = pool;
+    s->ctx = ctx;
+    s->flags = flags & 7;
+    s->bh = aml_buffer_init(4096);
+    ajson_sax_stream_reset(s);
+    return s;
+}
+
+void ajson_sax_stream_reset(ajson_sax_stream_t *s) {
+    s->rc = 0;
+    s->base = 0;
+    s->offset = 0;
+    s->reserved = 0;
+    s->resume.state = AJSON_SAX_RESUME_START;
+    s->resume.final = false;
+    aml_buffer_set(s->bh, "", 1);
+}
+
+void ajson_sax_stream_destroy(ajson_sax_stream_t *s) {
+    if (!s) return;
+    aml_buffer_destroy(s->bh);
+    aml_free(s);
+}
+
+/* Run the parser over everything buffered, then drop what it consumed. */
+static int ajson_sax_stream_run(ajson_sax_stream_t *s) {
+    char *data = aml_buffer_data(s->bh);
+    size_t len = aml_buffer_length(s->bh) - 1; /* Less the NUL */
+
+    s->rc = ajson_sax_stream_variants[s->flags](data, data + len, s->initial_cb,
+                                                s->pool, s->ctx, &s->resume);
+    size_t used = s->resume.consumed;
+    s->offset = s->base + used;
+    if (s->resume.state == AJSON_SAX_RESUME_DONE || !used) return s->rc;
+
+    /* Keep the unfinished token (and the NUL) at the front */
+    memmove(data, data + used, len - used + 1);
+    aml_buffer_shrink_by(s->bh, used);
+    s->base += used;
+    return s->rc;
+}
+
+int ajson_sax_stream_feed(ajson_sax_stream_t *s, const char *data, size_t len) {
+    if (s->resume.state == AJSON_SAX_RESUME_DONE || !len) return s->rc;
+
+    aml_buffer_shrink_by(s->bh, 1);
+    aml_buffer_append(s->bh, data, len);
+    aml_buffer_appendc(s->bh, 0);
+    return ajson_sax_stream_run(s);
+}
+
+char *ajson_sax_stream_reserve(ajson_sax_stream_t *s, size_t len) {
+    /* The room replaces the NUL and leaves space for a new one */
+    aml_buffer_shrink_by(s->bh, 1);
+    s->reserved = len;
+    return (char *)aml_buffer_append_alloc(s->bh, len + 1);
+}
+
+int ajson_sax_stream_commit(ajson_sax_stream_t *s, size_t len) {
+    if (len > s->reserved) len = s->reserved;
+    aml_buffer_shrink_by(s->bh, s->reserved - len);
+    s->reserved = 0;
+    aml_buffer_end(s->bh)[-1] = 0;
+    if (s->resume.state == AJSON_SAX_RESUME_DONE) {
+        aml_buffer_shrink_by(s->bh, len);   /* Ignored, as in feed */
+        return s->rc;
+    }
+    if (!len) return s->rc;
+    return ajson_sax_stream_run(s);
+}
+
+int ajson_sax_stream_finish(ajson_sax_stream_t *s) {
+    if (s->resume.state == AJSON_SAX_RESUME_DONE) return s->rc;
+    s->resume.final = true;
+    return ajson_sax_stream_run(s);
+}
+
+bool ajson_sax_stream_done(const ajson_sax_stream_t *s) {
+    return s->resume.state == AJSON_SAX_RESUME_DONE;
+}
+
+size_t ajson_sax_stream_offset(const ajson_sax_stream_t *s) {
+    return s->offset;
+}
+
+/* Multi-document parsing runs on the resumable instantiations as well: a
+   final (non-suspending) parse records in 'consumed' where the document
+   ended, which is exactly where the next one starts. */
+int ajson_sax_parse_many(char *p, char *ep,
+                         const ajson_sax_cb_t *initial_cb,
+                         const ajson_sax_doc_cb_t *doc_cb,
+                         aml_pool_t *pool,
+                         void *ctx,
+                         char **end_at,
+                         unsigned flags) {
+    ajson_sax_stream_variant_t parse = ajson_sax_stream_variants[flags & 7];
+    ajson_sax_resume_t resume;
+    char *sp = p;
+    char *cut = NULL;   /* Where the parser put a NUL over a separator */
+    size_t index = 0;
+    int rc = 0;
+
+    for (;; index++) {
+        while (p < ep && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t' ||
+                          (p == cut && !*p)))
+            p++;
+        if (p >= ep) break;
+
+        if (doc_cb && doc_cb->on_begin_document &&
+            (rc = doc_cb->on_begin_document(ctx, index, (size_t)(p - sp))))
+            break;
+
+        resume.state = AJSON_SAX_RESUME_START;
+        resume.final = true;
+        /* Only a root number is terminated in place at the byte after it */
+        bool number = *p == '-' || (*p >= '0' && *p <= '9');
+        rc = parse(p, ep, initial_cb, pool, ctx, &resume);
+        p += resume.consumed;
+        if (rc) break;
+        cut = number && (flags & AJSON_SAX_DESTRUCTIVE) ? p : NULL;
+
+        if (doc_cb && doc_cb->on_end_document &&
+            (rc = doc_cb->on_end_document(ctx, index, (size_t)(p - sp))))
+            break;
+    }
+    if (end_at) *end_at = p;
+    return rc;
+}
+
+/* ---------- Reading from a file descriptor ---------- */
+
+struct ajson_sax_fd_reader_s {
+    int fd;
+    const ajson_sax_cb_t *initial_cb;
+    aml_pool_t *pool;
+    void *ctx;
+    ajson_sax_stream_variant_t parse;
+    int rc;                     /* Sticky result once done */
+    bool done;
+    char *ring;
+    size_t size;
+    bool mirrored;              /* ring[i] and ring[size + i] are the same byte */
+    size_t head;                /* First byte not yet consumed */
+    size_t tail;                /* End of the bytes read */
+    ajson_sax_resume_t resume;
+};
+
+/* Map 'size' bytes of a memfd twice, back to back, so that a run of bytes
+   wrapping past the end of the ring is also contiguous in memory. */
+static char *ajson_sax_ring_map(size_t size) {
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+    int fd = memfd_create("ajson_sax_ring", MFD_CLOEXEC);
+    if (fd < 0) return NULL;
+    char *base = NULL;
+    if (!ftruncate(fd, (off_t)size)) {
+        base = (char *)mmap(NULL, size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            base = NULL;
+        } else if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                        fd, 0) == MAP_FAILED ||
+                   mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                        fd, 0) == MAP_FAILED) {
+            munmap(base, size * 2);
+            base = NULL;
+        }
+    }
+    close(fd);  /* The mappings keep the memory */
+    return base;
+#else
+    (void)size;
+    return NULL;
+#endif
+}
+
+ajson_sax_fd_reader_t *ajson_sax_fd_reader_init(int fd, size_t ring_size,
+                                                const ajson_sax_cb_t *initial_cb,
+                                                aml_pool_t *pool, void *ctx,
+                                                unsigned flags) {
+    ajson_sax_fd_reader_t *r = (ajson_sax_fd_reader_t *)aml_zalloc(sizeof(*r));
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    if (!ring_size) ring_size = 1 << 20;
+    r->size = (ring_size + page - 1) / page * page;
+    r->ring = ajson_sax_ring_map(r->size);
+    r->mirrored = r->ring != NULL;
+    if (!r->mirrored) r->ring = (char *)aml_malloc(r->size);
+    r->fd = fd;
+    r->initial_cb = initial_cb;
+    r->pool = pool;
+    r->ctx = ctx;
+    r->parse = ajson_sax_stream_variants[flags & 7];
+    r->resume.state = AJSON_SAX_RESUME_START;
+    r->resume.final = false;
+    return r;
+}
+
+void ajson_sax_fd_reader_destroy(ajson_sax_fd_reader_t *r) {
+    if (!r) return;
+    if (r->mirrored) munmap(r->ring, r->size * 2);
+    else aml_free(r->ring);
+    aml_free(r);
+}
+
+int ajson_sax_fd_reader_pump(ajson_sax_fd_reader_t *r) {
+    while (!r->done) {
+        /* Without the mirror, slide the unconsumed bytes to the front once
+           less than half of the buffer is left at the end */
+        if (!r->mirrored && r->head && (r->size - r->tail) * 2 < r->size) {
+            memmove(r->ring, r->ring + r->head, r->tail - r->head);
+            r->tail -= r->head;
+            r->head = 0;
+        }
+        char *data = r->ring + (r->mirrored ? r->head % r->size : r->head);
+        size_t len = r->tail - r->head;
+        /* One byte stays free for the NUL */
+        size_t room = r->size - 1 - (r->mirrored ? len : r->tail);
+        if (!room) {
+            r->rc = AJSON_SAX_FD_TOO_LONG;
+            r->done = true;
+            break;
+        }
+
+        ssize_t n = read(r->fd, data + len, room);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return AJSON_SAX_FD_AGAIN;
+            r->rc = AJSON_SAX_FD_IO_ERROR;
+            r->done = true;
+            break;
+        }
+        if (!n) r->resume.final = true;
+        len += (size_t)n;
+        r->tail += (size_t)n;
+        data[len] = 0;
+
+        r->rc = r->parse(data, data + len, r->initial_cb, r->pool, r->ctx, &r->resume);
+        r->head += r->resume.consumed;
+        r->done = r->rc || r->resume.state == AJSON_SAX_RESUME_DONE;
+    }
+    return r->rc;
+}
+
+int ajson_sax_parse_fd(int fd, size_t ring_size,
+                       const ajson_sax_cb_t *initial_cb,
+                       aml_pool_t *pool, void *ctx, unsigned flags) {
+    ajson_sax_fd_reader_t *r = ajson_sax_fd_reader_init(fd, ring_size, initial_cb,
+                                                        pool, ctx, flags);
+    int rc;
+    while ((rc = ajson_sax_fd_reader_pump(r)) == AJSON_SAX_FD_AGAIN) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+            rc = AJSON_SAX_FD_IO_ERROR;
+            break;
+        }
+    }
+    int err = errno;
+    ajson_sax_fd_reader_destroy(r);
+    errno = err;
+    return rc;
+}
@@ -1,200 +1,309 @@
 // SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
 // SPDX-License-Identifier: Apache-2.0
 
+#define _GNU_SOURCE
+
 #include "a-json-sax-library/ajson_string_utils.h"
+#include "a-json-sax-library/ajson_scan.h"
+
+#include <errno.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
-void ajson_file_write_valid_utf8(FILE *out, const char *src, size_t len)
-{
-    size_t i = 0;
+/* Staging block for ajson_fd_write_valid_utf8 (page aligned). */
+#define AJSON_FD_WRITE_BLOCK (1024 * 1024)
+
+/* ========================================================================
+ * UTF-8 validation core
+ * ======================================================================== */
+
+/* Scalar validator: ASCII is skipped 8 bytes at a time and everything else
+   is checked one sequence at a time.  Returns the offset of the first
+   invalid (or truncated) sequence, or len. */
+static size_t utf8_valid_prefix_scalar(const unsigned char *s, size_t i, size_t len) {
+    const unsigned char *ep = s + len;
     while (i < len) {
-        unsigned char c = (unsigned char)src[i];
-        if (c < 0x80) {
-            fputc(c, out);
+        while (len - i >= 8 && !(ajson_load64((const char *)s + i) & AJSON_SWAR_HIGHS)) i += 8;
+        if (i >= len) break;
+        if (s[i] < 0x80) {
             i++;
+            continue;
+        }
+        int n = ajson_utf8_sequence_length(s + i, ep);
+        if (!n) return i;
+        i += n;
+    }
+    return len;
+}
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define AJSON_UTF8_SSSE3 1
+#include <tmmintrin.h>
+
+/* Error bits for the Keiser-Lemire lookup validator.  Each 16-entry table
+   is indexed by a nibble of the previous or current byte; a bit that
+   survives the AND of all three lookups is an error (except TWO_CONTS,
+   which is reconciled against the expected continuation positions). */
+#define U8_TOO_SHORT  (1 << 0)
+#define U8_TOO_LONG   (1 << 1)
+#define U8_OVERLONG_3 (1 << 2)
+#define U8_TOO_LARGE  (1 << 3)
+#define U8_SURROGATE  (1 << 4)
+#define U8_OVERLONG_2 (1 << 5)
+#define U8_TOO_LARGE_1000 (1 << 6)
+#define U8_OVERLONG_4 (1 << 6)
+#define U8_TWO_CONTS  ((char)(1 << 7)) /* sign bit: keeps the tables in char range */
+#define U8_CARRY (U8_TOO_SHORT | U8_TOO_LONG | U8_TWO_CONTS)
+
+__attribute__((target("ssse3")))
+static inline __m128i utf8_block_errors(__m128i in, __m128i prev_in) {
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+    const __m128i byte_1_high_tbl = _mm_setr_epi8(
+        U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG,
+        U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG,
+        U8_TWO_CONTS, U8_TWO_CONTS, U8_TWO_CONTS, U8_TWO_CONTS,
+        U8_TOO_SHORT | U8_OVERLONG_2,
+        U8_TOO_SHORT,
+        U8_TOO_SHORT | U8_OVERLONG_3 | U8_SURROGATE,
+        U8_TOO_SHORT | U8_TOO_LARGE | U8_TOO_LARGE_1000 | U8_OVERLONG_4);
+    const __m128i byte_1_low_tbl = _mm_setr_epi8(
+        U8_CARRY | U8_OVERLONG_3 | U8_OVERLONG_2 | U8_OVERLONG_4,
+        U8_CARRY | U8_OVERLONG_2,
+        U8_CARRY,
+        U8_CARRY,
+        U8_CARRY | U8_TOO_LARGE,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000 | U8_SURROGATE,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000);
+    const __m128i byte_2_high_tbl = _mm_setr_epi8(
+        U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT,
+        U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT,
+        U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_OVERLONG_3 | U8_TOO_LARGE_1000 | U8_OVERLONG_4,
+        U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_OVERLONG_3 | U8_TOO_LARGE,
+        U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_SURROGATE | U8_TOO_LARGE,
+        U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_SURROGATE | U8_TOO_LARGE,
+        U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT);
+
+    __m128i prev1 = _mm_alignr_epi8(in, prev_in, 15);
+    __m128i b1h = _mm_shuffle_epi8(byte_1_high_tbl,
+                                   _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibble));
+    __m128i b1l = _mm_shuffle_epi8(byte_1_low_tbl, _mm_and_si128(prev1, low_nibble));
+    __m128i b2h = _mm_shuffle_epi8(byte_2_high_tbl,
+                                   _mm_and_si128(_mm_srli_epi16(in, 4), low_nibble));
+    __m128i special = _mm_and_si128(_mm_and_si128(b1h, b1l), b2h);
+
+    /* Bytes that must be the 2nd/3rd continuation of a 3/4 byte sequence */
+    __m128i prev2 = _mm_alignr_epi8(in, prev_in, 14);
+    __m128i prev3 = _mm_alignr_epi8(in, prev_in, 13);
+    __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80)));
+    __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80)));
+    __m128i must23_80 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8((char)0x80));
+    return _mm_xor_si128(must23_80, special);
+}
+
+/* Validates 16 bytes at a time with the lookup algorithm, skipping pure
+   ASCII blocks with a single movemask.  When a block fails (or for the
+   tail) the scalar validator resumes from the start of the sequence that
+   straddles the last clean block boundary to pin down the exact offset. */
+__attribute__((target("ssse3")))
+static size_t utf8_valid_prefix_ssse3(const unsigned char *s, size_t len) {
+    const __m128i zero = _mm_setzero_si128();
+    /* Lead bytes in the last 1/2/3 positions that need more bytes */
+    const __m128i max_tail = _mm_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+    __m128i prev_in = zero;
+    __m128i prev_incomplete = zero;
+    size_t i = 0;
+
+    while (len - i >= 16) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(s + i));
+        if (!_mm_movemask_epi8(in)) {
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(prev_incomplete, zero)) != 0xFFFF) break;
+        } else {
+            __m128i err = utf8_block_errors(in, prev_in);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(err, zero)) != 0xFFFF) break;
+            prev_incomplete = _mm_subs_epu8(in, max_tail);
+        }
+        if (!_mm_movemask_epi8(in)) prev_incomplete = zero;
+        prev_in = in;
+        i += 16;
+    }
+
+    /* Back up to the lead byte of a sequence crossing into s[i] */
+    size_t r = i;
+    for (size_t k = 1; k <= 3 && k <= i; k++) {
+        unsigned char c = s[i - k];
+        if (c < 0x80) break;
+        if (c >= 0xC0) {
+            size_t need = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+            if (k < need) r = i - k;
+            break;
+        }
+    }
+    return utf8_valid_prefix_scalar(s, r, len);
+}
+
+static int utf8_has_ssse3 = -1;
+#endif
+
+size_t ajson_utf8_valid_prefix(const char *src, size_t len) {
+    const unsigned char *s = (const unsigned char *)src;
+#ifdef AJSON_UTF8_SSSE3
+    if (utf8_has_ssse3 < 0) utf8_has_ssse3 = __builtin_cpu_supports("ssse3") ? 1 : 0;
+    if (utf8_has_ssse3) return utf8_valid_prefix_ssse3(s, len);
+#endif
+    return utf8_valid_prefix_scalar(s, 0, len);
+}
+
+bool ajson_utf8_is_valid(const char *src, size_t len) {
+    return ajson_utf8_valid_prefix(src, len) == len;
+}
+
+/* ========================================================================
+ * UTF-8 repair (drop the first byte of every invalid sequence)
+ * ======================================================================== */
+
+#ifdef __GLIBC__
+#define AJSON_FWRITE fwrite_unlocked
+#else
+#define AJSON_FWRITE fwrite
+#endif
+
+void ajson_file_write_valid_utf8(FILE *out, const char *src, size_t len)
+{
+    /* Take the stream lock once for the whole call, not once per run. */
+    flockfile(out);
+    for (;;) {
+        size_t n = ajson_utf8_valid_prefix(src, len);
+        if (n) AJSON_FWRITE(src, 1, n, out);
+        if (n >= len) break;
+        src += n + 1;
+        len -= n + 1;
+    }
+    funlockfile(out);
+}
+
+static int fd_write_all(int fd, const char *p, size_t len) {
+    while (len) {
+        ssize_t w = write(fd, p, len);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
         }
-        else if ((c & 0xE0) == 0xC0 && (i+1) < len) {
-            unsigned char c2 = (unsigned char)src[i+1];
-            if ((c2 & 0xC0) == 0x80) {
-                fputc(c, out);
-                fputc(c2, out);
-                i += 2;
-            } else i++;
-        } else if ((c & 0xF0) == 0xE0 && (i+2) < len) {
-            unsigned char c2 = (unsigned char)src[i+1];
-            unsigned char c3 = (unsigned char)src[i+2];
-            if (((c2 & 0xC0) == 0x80) && ((c3 & 0xC0) == 0x80)) {
-                fputc(c, out);
-                fputc(c2, out);
-                fputc(c3, out);
-                i += 3;
-            } else i++;
-        } else if ((c & 0xF8) == 0xF0 && (i+3) < len) {
-            unsigned char c2 = (unsigned char)src[i+1];
-            unsigned char c3 = (unsigned char)src[i+2];
-            unsigned char c4 = (unsigned char)src[i+3];
-            if (((c2 & 0xC0) == 0x80) && ((c3 & 0xC0) == 0x80) && ((c4 & 0xC0) == 0x80)) {
-                fputc(c, out);
-                fputc(c2, out);
-                fputc(c3, out);
-                fputc(c4, out);
-                i += 4;
-            } else i++;
-        } else i++;
+        p += w;
+        len -= (size_t)w;
     }
+    return 0;
+}
+
+int ajson_fd_write_valid_utf8(int fd, const char *src, size_t len)
+{
+    /* Fast path: nothing to repair, write straight from the source. */
+    size_t n = ajson_utf8_valid_prefix(src, len);
+    if (n == len) return fd_write_all(fd, src, len);
+
+    size_t cap = AJSON_FD_WRITE_BLOCK;
+    if (cap > len) cap = (len + 4095) & ~(size_t)4095;
+    char *buf = (char *)aligned_alloc(4096, cap);
+    if (!buf) return -1;
+
+    char *wp = buf;
+    int rc = 0;
+    for (;;) {
+        /* Valid run of n bytes at src; gather it, passing whole blocks through */
+        while (n && !rc) {
+            size_t space = buf + cap - wp;
+            if (wp == buf && n >= cap) {
+                size_t direct = n - n % cap;
+                rc = fd_write_all(fd, src, direct);
+                src += direct;
+                len -= direct;
+                n -= direct;
+                continue;
+            }
+            size_t m = n < space ? n : space;
+            memcpy(wp, src, m);
+            wp += m;
+            src += m;
+            len -= m;
+            n -= m;
+            if (wp == buf + cap) {
+                rc = fd_write_all(fd, buf, cap);
+                wp = buf;
+            }
+        }
+        if (rc || !len) break;
+        src++; /* Drop the first byte of the invalid sequence */
+        len--;
+        n = ajson_utf8_valid_prefix(src, len);
+    }
+    if (!rc && wp > buf) rc = fd_write_all(fd, buf, wp - buf);
+    free(buf);
+    return rc;
 }
 
 char *ajson_copy_valid_utf8(char *dest, const char *src, size_t len)
 {
-    size_t i = 0;
     char *d = dest;
-    while (i < len) {
-        unsigned char c = (unsigned char)src[i];
-        if (c < 0x80) {
-            *d++ = c;
-            i++;
-        } else if ((c & 0xE0) == 0xC0 && (i + 1) < len) {
-            unsigned char c2 = (unsigned char)src[i + 1];
-            if ((c2 & 0xC0) == 0x80) {
-                *d++ = c; *d++ = c2; i += 2;
-            } else i++;
-        } else if ((c & 0xF0) == 0xE0 && (i + 2) < len) {
-            unsigned char c2 = (unsigned char)src[i + 1];
-            unsigned char c3 = (unsigned char)src[i + 2];
-            if (((c2 & 0xC0) == 0x80) && ((c3 & 0xC0) == 0x80)) {
-                *d++ = c; *d++ = c2; *d++ = c3; i += 3;
-            } else i++;
-        } else if ((c & 0xF8) == 0xF0 && (i + 3) < len) {
-            unsigned char c2 = (unsigned char)src[i + 1];
-            unsigned char c3 = (unsigned char)src[i + 2];
-            unsigned char c4 = (unsigned char)src[i + 3];
-            if (((c2 & 0xC0) == 0x80) && ((c3 & 0xC0) == 0x80) && ((c4 & 0xC0) == 0x80)) {
-                *d++ = c; *d++ = c2; *d++ = c3; *d++ = c4; i += 4;
-            } else i++;
-        } else i++;
+    for (;;) {
+        size_t n = ajson_utf8_valid_prefix(src, len);
+        memcpy(d, src, n);
+        d += n;
+        if (n >= len) return d;
+        src += n + 1;
+        len -= n + 1;
     }
-    return d;
 }
 
 void ajson_buffer_append_valid_utf8(aml_buffer_t *bh, const char *src, size_t len)
 {
-    size_t i = 0;
-    while (i < len) {
-        unsigned char c = (unsigned char)src[i];
-        if (c < 0x80) {
-            aml_buffer_appendc(bh, c);
-            i++;
-        } else if ((c & 0xE0) == 0xC0 && (i + 1) < len) {
-            unsigned char c2 = (unsigned char)src[i+1];
-            if ((c2 & 0xC0) == 0x80) {
-                aml_buffer_appendc(bh, c); aml_buffer_appendc(bh, c2); i += 2;
-            } else i++;
-        } else if ((c & 0xF0) == 0xE0 && (i + 2) < len) {
-            unsigned char c2 = (unsigned char)src[i+1];
-            unsigned char c3 = (unsigned char)src[i+2];
-            if (((c2 & 0xC0) == 0x80) && ((c3 & 0xC0) == 0x80)) {
-                aml_buffer_appendc(bh, c); aml_buffer_appendc(bh, c2); aml_buffer_appendc(bh, c3); i += 3;
-            } else i++;
-        } else if ((c & 0xF8) == 0xF0 && (i + 3) < len) {
-            unsigned char c2 = (unsigned char)src[i+1];
-            unsigned char c3 = (unsigned char)src[i+2];
-            unsigned char c4 = (unsigned char)src[i+3];
-            if (((c2 & 0xC0) == 0x80) && ((c3 & 0xC0) == 0x80) && ((c4 & 0xC0) == 0x80)) {
-                aml_buffer_appendc(bh, c); aml_buffer_appendc(bh, c2); aml_buffer_appendc(bh, c3); aml_buffer_appendc(bh, c4); i += 4;
-            } else i++;
-        } else i++;
-    }
+    /* Output never exceeds the input: reserve once, copy, give back the rest */
+    char *d = (char *)aml_buffer_append_alloc(bh, len);
+    char *e = ajson_copy_valid_utf8(d, src, len);
+    aml_buffer_shrink_by(bh, len - (size_t)(e - d));
 }
 
 size_t ajson_strip_invalid_utf8_inplace(char *str, size_t len)
 {
-    size_t in_i = 0;
-    size_t out_i = 0;
-    while (in_i < len) {
-        unsigned char c = (unsigned char)str[in_i];
-        if (c < 0x80) {
-            str[out_i++] = c;
-            in_i++;
-        } else if ((c & 0xE0) == 0xC0 && (in_i + 1) < len) {
-            unsigned char c2 = (unsigned char)str[in_i + 1];
-            if ((c2 & 0xC0) == 0x80) {
-                str[out_i++] = c; str[out_i++] = c2; in_i += 2;
-            } else in_i++;
-        } else if ((c & 0xF0) == 0xE0 && (in_i + 2) < len) {
-            unsigned char c2 = (unsigned char)str[in_i + 1];
-            unsigned char c3 = (unsigned char)str[in_i + 2];
-            if (((c2 & 0xC0) == 0x80) && ((c3 & 0xC0) == 0x80)) {
-                str[out_i++] = c; str[out_i++] = c2; str[out_i++] = c3; in_i += 3;
-            } else in_i++;
-        } else if ((c & 0xF8) == 0xF0 && (in_i + 3) < len) {
-            unsigned char c2 = (unsigned char)str[in_i + 1];
-            unsigned char c3 = (unsigned char)str[in_i + 2];
-            unsigned char c4 = (unsigned char)str[in_i + 3];
-            if (((c2 & 0xC0) == 0x80) && ((c3 & 0xC0) == 0x80) && ((c4 & 0xC0) == 0x80)) {
-                str[out_i++] = c; str[out_i++] = c2; str[out_i++] = c3; str[out_i++] = c4; in_i += 4;
-            } else in_i++;
-        } else in_i++;
+    char *d = str;
+    const char *src = str;
+    for (;;) {
+        size_t n = ajson_utf8_valid_prefix(src, len);
+        if (d != src) memmove(d, src, n);
+        d += n;
+        if (n >= len) return d - str;
+        src += n + 1;
+        len -= n + 1;
     }
-    return out_i;
 }
 
-static int unicode_to_utf8(char *dest, char **src) {
-    char *s = *src;
-    unsigned int ch;
-    int c = *s++;
-    if (c >= '0' && c <= '9') ch = c - '0';
-    else if (c >= 'A' && c <= 'F') ch = c - 'A' + 10;
-    else if (c >= 'a' && c <= 'f') ch = c - 'a' + 10;
-    else return -1;
-
-    c = *s++;
-    if (c >= '0' && c <= '9') ch = (ch << 4) + c - '0';
-    else if (c >= 'A' && c <= 'F') ch = (ch << 4) + c - 'A' + 10;
-    else if (c >= 'a' && c <= 'f') ch = (ch << 4) + c - 'a' + 10;
-    else return -1;
-
-    c = *s++;
-    if (c >= '0' && c <= '9') ch = (ch << 4) + c - '0';
-    else if (c >= 'A' && c <= 'F') ch = (ch << 4) + c - 'A' + 10;
-    else if (c >= 'a' && c <= 'f') ch = (ch << 4) + c - 'a' + 10;
-    else return -1;
-
-    c = *s++;
-    if (c >= '0' && c <= '9') ch = (ch << 4) + c - '0';
-    else if (c >= 'A' && c <= 'F') ch = (ch << 4) + c - 'A' + 10;
-    else if (c >= 'a' && c <= 'f') ch = (ch << 4) + c - 'a' + 10;
-    else return -1;
+/* Decodes the XXXX of \uXXXX (and a following low surrogate escape) at
+   *src.  On success writes UTF-8 to dest, advances *src and returns the
+   number of bytes written; returns -1 if the escape is malformed. */
+static int unicode_to_utf8(char *dest, const char **src, const char *ep) {
+    const char *s = *src;
+    if (ep - s < 4) return -1;
+    int v = ajson_hex4(s);
+    if (v < 0) return -1;
+    unsigned int ch = (unsigned int)v;
+    s += 4;
 
     if (ch >= 0xD800 && ch <= 0xDBFF) {
-        if (*s != '\\' || s[1] != 'u') return -1;
-        s += 2;
-        unsigned int ch2;
-        c = *s++;
-        if (c >= '0' && c <= '9') ch2 = c - '0';
-        else if (c >= 'A' && c <= 'F') ch2 = c - 'A' + 10;
-        else if (c >= 'a' && c <= 'f') ch2 = c - 'a' + 10;
-        else return -1;
-
-        c = *s++;
-        if (c >= '0' && c <= '9') ch2 = (ch2 << 4) + c - '0';
-        else if (c >= 'A' && c <= 'F') ch2 = (ch2 << 4) + c - 'A' + 10;
-        else if (c >= 'a' && c <= 'f') ch2 = (ch2 << 4) + c - 'a' + 10;
-        else return -1;
-
-        c = *s++;
-        if (c >= '0' && c <= '9') ch2 = (ch2 << 4) + c - '0';
-        else if (c >= 'A' && c <= 'F') ch2 = (ch2 << 4) + c - 'A' + 10;
-        else if (c >= 'a' && c <= 'f') ch2 = (ch2 << 4) + c - 'a' + 10;
-        else return -1;
-
-        c = *s++;
-        if (c >= '0' && c <= '9') ch2 = (ch2 << 4) + c - '0';
-        else if (c >= 'A' && c <= 'F') ch2 = (ch2 << 4) + c - 'A' + 10;
-        else if (c >= 'a' && c <= 'f') ch2 = (ch2 << 4) + c - 'a' + 10;
-        else return -1;
-
-        if (ch2 < 0xDC00 || ch2 > 0xDFFF) return -1;
-        ch = ((ch - 0xD800) << 10) + (ch2 - 0xDC00) + 0x10000;
+        if (ep - s < 6 || s[0] != '\\' || s[1] != 'u') return -1;
+        int v2 = ajson_hex4(s + 2);
+        if (v2 < 0xDC00 || v2 > 0xDFFF) return -1;
+        ch = ((ch - 0xD800) << 10) + ((unsigned int)v2 - 0xDC00) + 0x10000;
+        s += 6;
     }
 
     *src = s;
@@ -211,122 +320,143 @@ static int unicode_to_utf8(char *dest, char **src) {
         dest[2] = (ch & 0x3F) | 0x80;
         return 3;
     }
-    if (ch < 0x110000) {
-        dest[0] = (ch >> 18) | 0xF0;
-        dest[1] = ((ch >> 12) & 0x3F) | 0x80;
-        dest[2] = ((ch >> 6) & 0x3F) | 0x80;
-        dest[3] = (ch & 0x3F) | 0x80;
-        return 4;
+    dest[0] = (ch >> 18) | 0xF0;
+    dest[1] = ((ch >> 12) & 0x3F) | 0x80;
+    dest[2] = ((ch >> 6) & 0x3F) | 0x80;
+    dest[3] = (ch & 0x3F) | 0x80;
+    return 4;
+}
+
+/* Decodes [p, ep) into rp, where p points at the first backslash.  The
+   decoded form is never longer than the source, so rp may alias the input
+   (rp <= p); runs between escapes are moved in bulk.  Returns the end. */
+static char *_ajson_decode_run(char *rp, const char *p, const char *ep) {
+    while (p < ep) {
+        const char *bs = ajson_scan_backslash(p, ep);
+        if (bs > p) {
+            memmove(rp, p, bs - p);
+            rp += bs - p;
+        }
+        if (bs + 1 >= ep) break; /* done, or a dangling backslash */
+        p = bs + 2;
+        switch (bs[1]) {
+        case '\"': *rp++ = '\"'; break;
+        case '\\': *rp++ = '\\'; break;
+        case '/':  *rp++ = '/'; break;
+        case 'b':  *rp++ = 8; break;
+        case 'f':  *rp++ = 12; break;
+        case 'n':  *rp++ = 10; break;
+        case 'r':  *rp++ = 13; break;
+        case 't':  *rp++ = 9; break;
+        case 'u': {
+            int n = unicode_to_utf8(rp, &p, ep);
+            if (n < 0) {
+                /* Malformed: keep the escape (up to 6 bytes) literally */
+                size_t keep = (ep - bs) < 6 ? (size_t)(ep - bs) : 6;
+                memmove(rp, bs, keep);
+                rp += keep;
+                p = bs + keep;
+            } else rp += n;
+            break;
+        }
+        }
     }
-    return 0;
+    return rp;
 }
 
 static inline char *_ajson_decode(aml_pool_t *pool, char **eptr, char *s, char *p, size_t length) {
-    char *sp;
     char *res = (char *)aml_pool_alloc(pool, length + 1);
     size_t pos = p - s;
     memcpy(res, s, pos);
-    char *rp = res + pos;
-    char *ep = s + length;
-    while (p < ep) {
-        int ch = *p++;
-        if (ch != '\\') *rp++ = ch;
-        else {
-            ch = *p++;
-            switch (ch) {
-            case '\"': *rp++ = '\"'; break;
-            case '\\': *rp++ = '\\'; break;
-            case '/':  *rp++ = '/'; break;
-            case 'b':  *rp++ = 8; break;
-            case 'f':  *rp++ = 12; break;
-            case 'n':  *rp++ = 10; break;
-            case 'r':  *rp++ = 13; break;
-            case 't':  *rp++ = 9; break;
-            case 'u':
-                sp = p - 2;
-                ch = unicode_to_utf8(rp, &p);
-                if (ch == -1) {
-                    p = sp;
-                    *rp++ = *p++; *rp++ = *p++; *rp++ = *p++;
-                    *rp++ = *p++; *rp++ = *p++; *rp++ = *p++;
-                } else rp += ch;
-                break;
-            }
-        }
-    }
+    char *rp = _ajson_decode_run(res + pos, p, s + length);
     *rp = 0;
     *eptr = rp;
     return res;
 }
 
-char *_ajson_encode(aml_pool_t *pool, char *s, char *p, size_t length) {
-    char *res = (char *)aml_pool_alloc(pool, (length * 6) + 3);
-    char *wp = res;
-    memcpy(res, s, p - s);
-    wp += (p - s);
-    char *ep = s + length;
+/* Exact encoded size of [p, ep), counting from the first byte to escape. */
+static size_t ajson_encoded_size(const char *p, const char *ep) {
+    size_t extra = 0;
+    const char *sp = p;
     while (p < ep) {
-        switch (*p) {
-        case '\"': *wp++ = '\\'; *wp++ = '\"'; p++; break;
-        case '\\': *wp++ = '\\'; *wp++ = '\\'; p++; break;
-        case '/':  *wp++ = '\\'; *wp++ = '/';  p++; break;
-        case '\b': *wp++ = '\\'; *wp++ = 'b';  p++; break;
-        case '\f': *wp++ = '\\'; *wp++ = 'f';  p++; break;
-        case '\n': *wp++ = '\\'; *wp++ = 'n';  p++; break;
-        case '\r': *wp++ = '\\'; *wp++ = 'r';  p++; break;
-        case '\t': *wp++ = '\\'; *wp++ = 't';  p++; break;
-        default:
-            if ((unsigned char)(*p) < 0x20) {
-                sprintf(wp, "\\u%04X", (unsigned char)(*p));
-                wp += 6;
-                p++;
-            } else {
-                *wp++ = *p++;
-            }
-            break;
-        }
+        p = ajson_scan_escape(p, ep);
+        if (p == ep) break;
+        extra += ajson_escape_extra((unsigned char)*p);
+        p++;
     }
+    return (ep - sp) + extra;
+}
+
+/* Encodes [p, ep) into 'wp', copying clean runs in bulk.  'wp' must have
+   room for ajson_encoded_size(p, ep) bytes.  Returns the new end. */
+static char *ajson_encode_into(char *wp, const char *p, const char *ep) {
+    while (p < ep) {
+        const char *e = ajson_scan_escape(p, ep);
+        memcpy(wp, p, e - p);
+        wp += e - p;
+        if (e == ep) break;
+        wp = ajson_write_escape(wp, (unsigned char)*e);
+        p = e + 1;
+    }
+    return wp;
+}
+
+char *_ajson_encode(aml_pool_t *pool, char *s, char *p, size_t length) {
+    char *ep = s + length;
+    size_t len = (p - s) + ajson_encoded_size(p, ep);
+    char *res = (char *)aml_pool_alloc(pool, len + 1);
+    memcpy(res, s, p - s);
+    char *wp = ajson_encode_into(res + (p - s), p, ep);
     *wp = 0;
     return res;
 }
 
 char *ajson_encode(aml_pool_t *pool, char *s, size_t length) {
-    char *p = s;
     char *ep = s + length;
-    while (p < ep) {
-        unsigned char ch = (unsigned char)*p;
-        if (ch < 0x20 || ch == '\"' || ch == '\\' || ch == '/' || ch == 0)
-           return _ajson_encode(pool, s, p, length);
-        p++;
+    char *p = (char *)ajson_scan_escape(s, ep);
+    if (p == ep) return s;
+    return _ajson_encode(pool, s, p, length);
+}
+
+void ajson_buffer_append_encoded(aml_buffer_t *bh, const char *s, size_t length) {
+    const char *ep = s + length;
+    const char *p = ajson_scan_escape(s, ep);
+    if (p == ep) {
+        aml_buffer_append(bh, s, length);
+        return;
     }
-    return s;
+    size_t len = (p - s) + ajson_encoded_size(p, ep);
+    char *wp = (char *)aml_buffer_append_alloc(bh, len);
+    memcpy(wp, s, p - s);
+    ajson_encode_into(wp + (p - s), p, ep);
 }
 
 char *ajson_decode(aml_pool_t *pool, char *s, size_t length) {
-    char *p = s;
-    char *ep = p + length;
-    for (;;) {
-        if (p == ep) return s;
-        else if (*p == '\\') break;
-        p++;
-    }
+    char *ep = s + length;
+    char *p = (char *)ajson_scan_backslash(s, ep);
+    if (p == ep) return s;
     char *eptr = NULL;
     return _ajson_decode(pool, &eptr, s, p, length);
 }
 
 char *ajson_decode2(size_t *rlen, aml_pool_t *pool, char *s, size_t length) {
-    char *p = s;
-    char *ep = p + length;
-    for (;;) {
-        if (p == ep) {
-            *rlen = length;
-            return s;
-        }
-        else if (*p == '\\') break;
-        p++;
+    char *ep = s + length;
+    char *p = (char *)ajson_scan_backslash(s, ep);
+    if (p == ep) {
+        *rlen = length;
+        return s;
     }
     char *eptr = NULL;
     char *r = _ajson_decode(pool, &eptr, s, p, length);
     *rlen = eptr - r;
     return r;
 }
+
+size_t ajson_decode_inplace(char *s, size_t length) {
+    char *ep = s + length;
+    char *p = (char *)ajson_scan_backslash(s, ep);
+    if (p == ep) return length;
+    char *rp = _ajson_decode_run(p, p, ep);
+    if (rp < ep) *rp = 0;
+    return rp - s;
+}
@@ -0,0 +1,334 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#include "a-json-sax-library/ajson_validate.h"
+#include "a-json-sax-library/ajson_sax_impl.h"
+#include "a-json-sax-library/ajson_scan.h"
+#include "a-json-sax-library/ajson_string_utils.h"
+
+#include <string.h>
+
+/* Unlike the parser there is no NUL at 'ep' to stop on, so every read is
+   checked against it.  Helpers return the position after what they
+   matched, or NULL with '*err' at the offending byte. */
+
+#define AJSON_VALIDATE_OBJECT 1
+#define AJSON_VALIDATE_ARRAY  2
+
+/* The byte at which the bad escape at p goes wrong */
+static const char *ajson_validate_bad_escape(const char *p, const char *ep) {
+    p++;
+    if (p >= ep || *p != 'u') return p;
+    p++;
+    for (int i = 0; i < 4 && p < ep && ajson_hex_values[(unsigned char)*p] >= 0; i++) p++;
+    return p;
+}
+
+/* True if [p, ep) is a UTF-8 sequence that is fine so far but cut short */
+static bool ajson_validate_utf8_cut(const unsigned char *p, const unsigned char *ep) {
+    size_t n = (size_t)(ep - p);
+    unsigned char c = p[0];
+    size_t need = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+    if (c < 0xC2 || c > 0xF4 || n >= need) return false;
+    if (n > 1) {
+        unsigned char lo = c == 0xE0 ? 0xA0 : c == 0xF0 ? 0x90 : 0x80;
+        unsigned char hi = c == 0xED ? 0x9F : c == 0xF4 ? 0x8F : 0xBF;
+        if (p[1] < lo || p[1] > hi) return false;
+        if (n > 2 && (p[2] & 0xC0) != 0x80) return false;
+    }
+    return true;
+}
+
+/* The string body starting just after the opening quote */
+static inline const char *ajson_validate_string(const char *p, const char *ep,
+                                                const char **err) {
+    for (;;) {
+        p = ajson_scan_string_strict(p, ep);
+        if (AJSON_UNLIKELY(p >= ep)) break;
+        unsigned char c = (unsigned char)*p;
+        if (AJSON_LIKELY(c == '\"')) return p + 1;
+        if (c == '\\') {
+            int n = ajson_escape_length(p, ep);
+            if (!n) {
+                p = ajson_validate_bad_escape(p, ep);
+                break;
+            }
+            p += n;
+        } else if (c < 0x20) {
+            break;
+        } else {
+            /* Non-ASCII: find the end of the run and check all of it at
+               once rather than a sequence at a time. */
+            const char *q = ajson_scan_string_ctrl(p, ep);
+            size_t ok = ajson_utf8_valid_prefix(p, (size_t)(q - p));
+            if (ok < (size_t)(q - p)) {
+                p += ok;
+                if (q == ep && ajson_validate_utf8_cut((const unsigned char *)p,
+                                                       (const unsigned char *)ep))
+                    p = ep;
+                break;
+            }
+            p = q;
+        }
+    }
+    *err = p;
+    return NULL;
+}
+
+/* Gaps between tokens are short: a vector scan does not pay for itself */
+static inline const char *ajson_validate_space(const char *p, const char *ep) {
+    while (p < ep && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    return p;
+}
+
+static inline const char *ajson_validate_digits(const char *p, const char *ep) {
+    while (p < ep && *p >= '0' && *p <= '9') p++;
+    return p;
+}
+
+/* -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? */
+static inline const char *ajson_validate_number(const char *p, const char *ep,
+                                                const char **err) {
+    if (*p == '-') p++;
+    if (p >= ep) goto bad;
+    if (*p == '0') p++;
+    else if (*p >= '1' && *p <= '9') p = ajson_validate_digits(p + 1, ep);
+    else goto bad;
+
+    if (p < ep && *p == '.') {
+        p++;
+        if (p >= ep || *p < '0' || *p > '9') goto bad;
+        p = ajson_validate_digits(p + 1, ep);
+    }
+    if (p < ep && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < ep && (*p == '+' || *p == '-')) p++;
+        if (p >= ep || *p < '0' || *p > '9') goto bad;
+        p = ajson_validate_digits(p + 1, ep);
+    }
+    return p;
+
+bad:
+    *err = p;
+    return NULL;
+}
+
+static inline const char *ajson_validate_literal(const char *p, const char *ep,
+                                                 const char *lit, size_t n,
+                                                 const char **err) {
+    if (AJSON_LIKELY((size_t)(ep - p) >= n && !memcmp(p, lit, n))) return p + n;
+    while (p < ep && *p == *lit) {
+        p++;
+        lit++;
+    }
+    *err = p;
+    return NULL;
+}
+
+/* UTF-8 is checked this far ahead of the fast walk */
+#define AJSON_VALIDATE_CHUNK (16 * 1024)
+
+/* The fast walk's strings: non-ASCII bytes are skipped here and checked
+   in bulk by ajson_validate_utf8_ahead. */
+static inline const char *ajson_validate_string_fast(const char *p, const char *ep) {
+    for (;;) {
+        p = ajson_scan_string_ctrl(p, ep);
+        if (AJSON_UNLIKELY(p >= ep)) return NULL;
+        if (AJSON_LIKELY(*p == '\"')) return p + 1;
+        if (*p != '\\') return NULL;
+        int n = ajson_escape_length(p, ep);
+        if (!n) return NULL;
+        p += n;
+    }
+}
+
+/* Make sure everything before 'p' has been checked as UTF-8.  A sequence
+   cut by the end of a chunk is checked again, whole, with the next one. */
+static inline bool ajson_validate_utf8_ahead(const char **checked, const char *p,
+                                             const char *ep) {
+    while (*checked < p) {
+        size_t n = (size_t)(ep - *checked);
+        if (n > AJSON_VALIDATE_CHUNK) n = AJSON_VALIDATE_CHUNK;
+        size_t ok = ajson_utf8_valid_prefix(*checked, n);
+        if (ok < n && (*checked + n == ep || n - ok > 3)) return false;
+        *checked += ok;
+    }
+    return true;
+}
+
+/* The walk over [p, p+len).  'precise' is a constant: the precise form
+   checks UTF-8 as it goes and finds the error offset; the fast form
+   checks UTF-8 a chunk at a time and only says yes or no.
+
+   With 'dst' (also constant, or NULL) the walk minifies: the tokens
+   between runs of whitespace are moved to 'dst' and '*out_len' is set.
+   'dst' may be 'p' itself, since the output never passes the input read
+   so far.  UTF-8 is then checked up to p before anything is written, so
+   the fast form never checks bytes that have been overwritten. */
+static inline __attribute__((always_inline)) bool ajson_validate_impl(
+                    const char *p, size_t len, size_t *error_offset, const bool precise,
+                    char *dst, size_t *out_len) {
+    const bool minify = dst != NULL;
+    const char *const start = p;
+    const char *const ep = p + len;
+    const char *err = ep;
+    const char *utf8_checked = p;
+    const char *run = p;      /* Start of the input not yet moved to d */
+    char *d = dst;
+    unsigned char stack[AJSON_SAX_MAX_STACK_DEPTH];
+    int depth = 0;
+
+    /* Move [run, p) to d */
+    #define FLUSH() do { \
+        if (!precise && !ajson_validate_utf8_ahead(&utf8_checked, p, ep)) return false; \
+        if (d != run) memmove(d, run, (size_t)(p - run)); \
+        d += p - run; \
+    } while (0)
+
+    /* Skip whitespace, leaving it out of the output */
+    #define SPACE() do { \
+        const char *sq = ajson_validate_space(p, ep); \
+        if (minify && sq != p) { \
+            FLUSH(); \
+            run = sq; \
+        } \
+        p = sq; \
+    } while (0)
+
+    /* Whole strings, key or value */
+    #define STRING() do { \
+        if (precise) { \
+            p = ajson_validate_string(p + 1, ep, &err); \
+            if (!p) goto fail; \
+        } else { \
+            p = ajson_validate_string_fast(p + 1, ep); \
+            if (!p || !ajson_validate_utf8_ahead(&utf8_checked, p, ep)) return false; \
+        } \
+    } while (0)
+
+    /* Each state leaves p on the next unread byte */
+value:
+    SPACE();
+    if (p >= ep) goto fail_at_end;
+    switch (*p) {
+    case '\"':
+        STRING();
+        goto after_value;
+    case '{':
+        if (depth >= AJSON_SAX_MAX_STACK_DEPTH - 1) goto fail_here;
+        stack[++depth] = AJSON_VALIDATE_OBJECT;
+        p++;
+        SPACE();
+        if (p < ep && *p == '}') {
+            depth--;
+            p++;
+            goto after_value;
+        }
+        goto key;
+    case '[':
+        if (depth >= AJSON_SAX_MAX_STACK_DEPTH - 1) goto fail_here;
+        stack[++depth] = AJSON_VALIDATE_ARRAY;
+        p++;
+        SPACE();
+        if (p < ep && *p == ']') {
+            depth--;
+            p++;
+            goto after_value;
+        }
+        goto value;
+    case '-':
+    case '0':
+    case AJSON_NATURAL_NUMBER_CASE:
+        p = ajson_validate_number(p, ep, &err);
+        if (!p) goto fail;
+        goto after_value;
+    case 't':
+        p = ajson_validate_literal(p, ep, "true", 4, &err);
+        if (!p) goto fail;
+        goto after_value;
+    case 'f':
+        p = ajson_validate_literal(p, ep, "false", 5, &err);
+        if (!p) goto fail;
+        goto after_value;
+    case 'n':
+        p = ajson_validate_literal(p, ep, "null", 4, &err);
+        if (!p) goto fail;
+        goto after_value;
+    default:
+        goto fail_here;
+    }
+
+key:
+    if (p >= ep) goto fail_at_end;
+    if (*p != '\"') goto fail_here;
+    STRING();
+    SPACE();
+    if (p >= ep) goto fail_at_end;
+    if (*p != ':') goto fail_here;
+    p++;
+    goto value;
+
+after_value:
+    SPACE();
+    if (depth == 0) {
+        if (p < ep) goto fail_here;
+        if (minify) {
+            FLUSH();
+            *out_len = (size_t)(d - dst);
+        }
+        return true;
+    }
+    if (p >= ep) goto fail_at_end;
+    if (*p == ',') {
+        p++;
+        SPACE();
+        if (stack[depth] == AJSON_VALIDATE_OBJECT) goto key;
+        goto value;
+    }
+    if (*p == (stack[depth] == AJSON_VALIDATE_OBJECT ? '}' : ']')) {
+        depth--;
+        p++;
+        goto after_value;
+    }
+    goto fail_here;
+
+fail_at_end:
+    err = ep;
+    goto fail;
+fail_here:
+    err = p;
+fail:
+    if (error_offset) *error_offset = (size_t)(err - start);
+    return false;
+
+    #undef STRING
+    #undef SPACE
+    #undef FLUSH
+}
+
+bool ajson_validate(const char *p, size_t len, size_t *error_offset) {
+    /* Errors are rare: the fast walk answers, and only a failure is walked
+       again to find where it is. */
+    if (AJSON_LIKELY(ajson_validate_impl(p, len, NULL, false, NULL, NULL))) return true;
+    return ajson_validate_impl(p, len, error_offset, true, NULL, NULL);
+}
+
+bool ajson_minify(char *dst, const char *src, size_t len, size_t *out_len,
+                  size_t *error_offset) {
+    size_t n = 0;
+    if (AJSON_LIKELY(ajson_validate_impl(src, len, NULL, false, dst, &n))) {
+        if (out_len) *out_len = n;
+        return true;
+    }
+    return ajson_validate_impl(src, len, error_offset, true, NULL, NULL);
+}
+
+bool ajson_minify_in_place(char *p, size_t len, size_t *out_len, size_t *error_offset) {
+    /* The input is overwritten as it goes, so a failure cannot be walked
+       again: the precise form is the only walk. */
+    size_t n = 0;
+    if (!ajson_validate_impl(p, len, error_offset, true, p, &n)) return false;
+    if (out_len) *out_len = n;
+    return true;
+}
+
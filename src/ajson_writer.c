@@ -0,0 +1,292 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#include "a-json-sax-library/ajson_writer.h"
+#include "a-json-sax-library/ajson_number.h"
+#include "a-memory-library/aml_alloc.h"
+#include "a-json-sax-library/ajson_scan.h"
+
+#include <string.h>
+
+/* How much to reserve at the end of an aml_buffer_t at a time. */
+#define AJSON_WRITER_BUFFER_RESERVE (16 * 1024)
+
+/* Smallest block a callback writer will accept (must hold any single
+   number or escape sequence). */
+#define AJSON_WRITER_MIN_BLOCK 64
+
+struct ajson_writer_s {
+    char *buf;                   /* Start of the current block */
+    char *wp;                    /* Write position */
+    char *ep;                    /* End of the current block */
+    aml_buffer_t *bh;            /* Buffer sink (NULL for callback sinks) */
+    ajson_writer_flush_cb flush; /* Callback sink */
+    void *arg;
+    size_t block_size;
+    int error;                   /* Sticky flush error */
+    bool need_comma;             /* A value was written at this level */
+};
+
+static const char ajson_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/* ========================================================================
+ * Block management
+ * ======================================================================== */
+
+/* Hand the filled part of the block to the callback sink. */
+static void writer_emit(ajson_writer_t *w) {
+    size_t len = w->wp - w->buf;
+    if (len && !w->error) w->error = w->flush(w->arg, w->buf, len);
+    w->wp = w->buf;
+}
+
+/* Give back whatever part of the aml_buffer_t reservation is unused. */
+static void writer_trim(ajson_writer_t *w) {
+    if (w->buf) aml_buffer_shrink_by(w->bh, w->ep - w->wp);
+    w->buf = w->wp = w->ep = NULL;
+}
+
+static void writer_grow(ajson_writer_t *w, size_t n) {
+    if (w->bh) {
+        writer_trim(w);
+        size_t r = n > w->block_size ? n : w->block_size;
+        w->buf = w->wp = (char *)aml_buffer_append_alloc(w->bh, r);
+        w->ep = w->buf + r;
+    } else {
+        writer_emit(w);
+    }
+}
+
+static inline void writer_reserve(ajson_writer_t *w, size_t n) {
+    if (AJSON_UNLIKELY((size_t)(w->ep - w->wp) < n)) writer_grow(w, n);
+}
+
+static void writer_write(ajson_writer_t *w, const char *s, size_t len) {
+    size_t space = w->ep - w->wp;
+    if (AJSON_LIKELY(space >= len)) {
+        memcpy(w->wp, s, len);
+        w->wp += len;
+        return;
+    }
+    if (w->bh) {
+        writer_grow(w, len);
+        memcpy(w->wp, s, len);
+        w->wp += len;
+        return;
+    }
+    /* Callback sink: top off the block, then pass large runs straight through */
+    memcpy(w->wp, s, space);
+    w->wp += space;
+    s += space;
+    len -= space;
+    writer_emit(w);
+    if (len >= w->block_size) {
+        if (!w->error) w->error = w->flush(w->arg, s, len);
+        return;
+    }
+    memcpy(w->wp, s, len);
+    w->wp += len;
+}
+
+/* Copy clean runs in bulk and expand only the bytes that need escaping. */
+static void writer_escaped(ajson_writer_t *w, const char *s, size_t len) {
+    const char *p = s;
+    const char *ep = s + len;
+    while (p < ep) {
+        const char *e = ajson_scan_escape(p, ep);
+        if (e > p) writer_write(w, p, e - p);
+        if (e == ep) break;
+
+        writer_reserve(w, 6);
+        w->wp = ajson_write_escape(w->wp, (unsigned char)*e);
+        p = e + 1;
+    }
+}
+
+/* Reserve room for a value of up to 'n' bytes plus a separating comma. */
+static inline void writer_value(ajson_writer_t *w, size_t n) {
+    writer_reserve(w, n + 1);
+    if (w->need_comma) *w->wp++ = ',';
+    w->need_comma = true;
+}
+
+/* ========================================================================
+ * Lifecycle
+ * ======================================================================== */
+
+ajson_writer_t *ajson_writer_init(aml_buffer_t *bh) {
+    ajson_writer_t *w = (ajson_writer_t *)aml_malloc(sizeof(ajson_writer_t));
+    w->buf = w->wp = w->ep = NULL;
+    w->bh = bh;
+    w->flush = NULL;
+    w->arg = NULL;
+    w->block_size = AJSON_WRITER_BUFFER_RESERVE;
+    w->error = 0;
+    w->need_comma = false;
+    return w;
+}
+
+ajson_writer_t *ajson_writer_init_cb(ajson_writer_flush_cb flush, void *arg,
+                                     size_t block_size) {
+    if (!block_size) block_size = AJSON_WRITER_BLOCK_SIZE;
+    if (block_size < AJSON_WRITER_MIN_BLOCK) block_size = AJSON_WRITER_MIN_BLOCK;
+
+    ajson_writer_t *w = (ajson_writer_t *)aml_malloc(sizeof(ajson_writer_t));
+    w->buf = w->wp = (char *)aml_malloc(block_size);
+    w->ep = w->buf + block_size;
+    w->bh = NULL;
+    w->flush = flush;
+    w->arg = arg;
+    w->block_size = block_size;
+    w->error = 0;
+    w->need_comma = false;
+    return w;
+}
+
+int ajson_writer_flush(ajson_writer_t *w) {
+    if (w->bh) writer_trim(w);
+    else writer_emit(w);
+    return w->error;
+}
+
+int ajson_writer_destroy(ajson_writer_t *w) {
+    int rc = ajson_writer_flush(w);
+    if (!w->bh) aml_free(w->buf);
+    aml_free(w);
+    return rc;
+}
+
+int ajson_writer_error(ajson_writer_t *w) {
+    return w->error;
+}
+
+/* ========================================================================
+ * Structure
+ * ======================================================================== */
+
+void ajson_writer_start_object(ajson_writer_t *w) {
+    writer_value(w, 1);
+    *w->wp++ = '{';
+    w->need_comma = false;
+}
+
+void ajson_writer_end_object(ajson_writer_t *w) {
+    writer_reserve(w, 1);
+    *w->wp++ = '}';
+    w->need_comma = true;
+}
+
+void ajson_writer_start_array(ajson_writer_t *w) {
+    writer_value(w, 1);
+    *w->wp++ = '[';
+    w->need_comma = false;
+}
+
+void ajson_writer_end_array(ajson_writer_t *w) {
+    writer_reserve(w, 1);
+    *w->wp++ = ']';
+    w->need_comma = true;
+}
+
+void ajson_writer_key(ajson_writer_t *w, const char *key, size_t len) {
+    writer_value(w, 1);
+    *w->wp++ = '\"';
+    writer_escaped(w, key, len);
+    writer_reserve(w, 2);
+    *w->wp++ = '\"';
+    *w->wp++ = ':';
+    w->need_comma = false;
+}
+
+/* ========================================================================
+ * Values
+ * ======================================================================== */
+
+void ajson_writer_string(ajson_writer_t *w, const char *s, size_t len) {
+    writer_value(w, 1);
+    *w->wp++ = '\"';
+    writer_escaped(w, s, len);
+    writer_reserve(w, 1);
+    *w->wp++ = '\"';
+}
+
+/* Writes the digits of 'v' ending just before 'end'; returns the start. */
+static inline char *writer_format_u64(char *end, uint64_t v) {
+    char *p = end;
+    while (v >= 100) {
+        unsigned idx = (unsigned)(v % 100) * 2;
+        v /= 100;
+        p -= 2;
+        p[0] = ajson_digit_pairs[idx];
+        p[1] = ajson_digit_pairs[idx + 1];
+    }
+    if (v >= 10) {
+        p -= 2;
+        p[0] = ajson_digit_pairs[v * 2];
+        p[1] = ajson_digit_pairs[v * 2 + 1];
+    } else {
+        *--p = (char)('0' + v);
+    }
+    return p;
+}
+
+void ajson_writer_uint(ajson_writer_t *w, uint64_t v) {
+    char tmp[24];
+    char *end = tmp + sizeof(tmp);
+    char *p = writer_format_u64(end, v);
+    writer_value(w, end - p);
+    memcpy(w->wp, p, end - p);
+    w->wp += end - p;
+}
+
+void ajson_writer_int(ajson_writer_t *w, int64_t v) {
+    char tmp[24];
+    char *end = tmp + sizeof(tmp);
+    char *p;
+    if (v < 0) {
+        p = writer_format_u64(end, (uint64_t)0 - (uint64_t)v);
+        *--p = '-';
+    } else {
+        p = writer_format_u64(end, (uint64_t)v);
+    }
+    writer_value(w, end - p);
+    memcpy(w->wp, p, end - p);
+    w->wp += end - p;
+}
+
+void ajson_writer_double(ajson_writer_t *w, double v) {
+    writer_value(w, AJSON_DOUBLE_MAX_LEN);
+    w->wp += ajson_format_double(w->wp, v);
+}
+
+void ajson_writer_bool(ajson_writer_t *w, bool v) {
+    writer_value(w, 5);
+    if (v) {
+        memcpy(w->wp, "true", 4);
+        w->wp += 4;
+    } else {
+        memcpy(w->wp, "false", 5);
+        w->wp += 5;
+    }
+}
+
+void ajson_writer_null(ajson_writer_t *w) {
+    writer_value(w, 4);
+    memcpy(w->wp, "null", 4);
+    w->wp += 4;
+}
+
+void ajson_writer_raw(ajson_writer_t *w, const char *json, size_t len) {
+    writer_value(w, 0);
+    writer_write(w, json, len);
+}
@@ -0,0 +1,275 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "a-json-sax-library/ajson_bind.h"
+#include "a-memory-library/aml_pool.h"
+
+#include "the-macro-library/macro_test.h"
+
+/* ---------- Bound Types ---------- */
+
+typedef struct {
+    char *city;
+    int zip;
+} address_t;
+
+typedef struct {
+    int id;
+    int64_t big;
+    uint64_t ubig;
+    double score;
+    bool active;
+    char *name;
+    address_t home;
+    int *tags;
+    size_t num_tags;
+    char **aliases;
+    size_t num_aliases;
+    address_t *past;
+    size_t num_past;
+} user_t;
+
+static const ajson_bind_field_t address_fields[] = {
+    AJSON_BIND_FIELD(address_t, city, AJSON_BIND_STRING),
+    AJSON_BIND_NAMED("postal_code", address_t, zip, AJSON_BIND_INT),
+};
+static const ajson_bind_desc_t address_desc = AJSON_BIND_DESC(address_t, address_fields);
+
+static const ajson_bind_field_t user_fields[] = {
+    AJSON_BIND_FIELD(user_t, id, AJSON_BIND_INT),
+    AJSON_BIND_FIELD(user_t, big, AJSON_BIND_INT64),
+    AJSON_BIND_FIELD(user_t, ubig, AJSON_BIND_UINT64),
+    AJSON_BIND_FIELD(user_t, score, AJSON_BIND_DOUBLE),
+    AJSON_BIND_FIELD(user_t, active, AJSON_BIND_BOOL),
+    AJSON_BIND_FIELD(user_t, name, AJSON_BIND_STRING),
+    AJSON_BIND_OBJECT_FIELD(user_t, home, &address_desc),
+    AJSON_BIND_ARRAY_FIELD(user_t, tags, num_tags, AJSON_BIND_INT),
+    AJSON_BIND_ARRAY_FIELD(user_t, aliases, num_aliases, AJSON_BIND_STRING),
+    AJSON_BIND_OBJECT_ARRAY_FIELD(user_t, past, num_past, &address_desc),
+};
+static const ajson_bind_desc_t user_desc = AJSON_BIND_DESC(user_t, user_fields);
+
+static const char *user_json =
+    "{\"id\": 42, \"big\": -9223372036854775808, \"ubig\": 18446744073709551615,"
+    " \"score\": 2.5e1, \"active\": true, \"name\": \"Ann \\\"A\\\" Lee\","
+    " \"unknown\": {\"deep\": [1, {\"x\": [true]}], \"id\": 7},"
+    " \"home\": {\"city\": \"Paris\", \"postal_code\": 75001},"
+    " \"tags\": [1, -2, 3, 4, 5, 6, 7, 8, 9, 10],"
+    " \"aliases\": [\"a\", null, \"\\u00e9\"],"
+    " \"past\": [{\"city\": \"Oslo\"}, {\"postal_code\": 1}, {}]}";
+
+static int bind_text(const ajson_bind_t *b, void *out, const char *json,
+                     aml_pool_t *pool, unsigned flags) {
+    char *p = aml_pool_strdup(pool, json);
+    char *error_at = NULL;
+    return ajson_bind_parse(b, out, p, p + strlen(p), pool, &error_at, flags);
+}
+
+static void check_user(const user_t *u) {
+    MACRO_ASSERT_EQ_INT(u->id, 42);
+    MACRO_ASSERT_TRUE(u->big == INT64_MIN);
+    MACRO_ASSERT_TRUE(u->ubig == UINT64_MAX);
+    MACRO_ASSERT_NEAR(u->score, 25.0, 1e-9);
+    MACRO_ASSERT_TRUE(u->active);
+    MACRO_ASSERT_STREQ(u->name, "Ann \"A\" Lee");
+    MACRO_ASSERT_STREQ(u->home.city, "Paris");
+    MACRO_ASSERT_EQ_INT(u->home.zip, 75001);
+
+    MACRO_ASSERT_EQ_SZ(u->num_tags, 10);
+    MACRO_ASSERT_EQ_INT(u->tags[1], -2);
+    MACRO_ASSERT_EQ_INT(u->tags[9], 10);
+
+    MACRO_ASSERT_EQ_SZ(u->num_aliases, 3);
+    MACRO_ASSERT_STREQ(u->aliases[0], "a");
+    MACRO_ASSERT_TRUE(u->aliases[1] == NULL);
+    MACRO_ASSERT_STREQ(u->aliases[2], "\xc3\xa9");
+
+    MACRO_ASSERT_EQ_SZ(u->num_past, 3);
+    MACRO_ASSERT_STREQ(u->past[0].city, "Oslo");
+    MACRO_ASSERT_TRUE(u->past[1].city == NULL);
+    MACRO_ASSERT_EQ_INT(u->past[1].zip, 1);
+    MACRO_ASSERT_EQ_INT(u->past[2].zip, 0);
+}
+
+MACRO_TEST(bind_struct) {
+    ajson_bind_t *b = ajson_bind_init(&user_desc);
+    aml_pool_t *pool = aml_pool_init(1024);
+
+    user_t u;
+    memset(&u, 0, sizeof(u));
+    MACRO_ASSERT_EQ_INT(bind_text(b, &u, user_json, pool, 0), 0);
+    check_user(&u);
+
+    aml_pool_destroy(pool);
+    ajson_bind_destroy(b);
+}
+
+MACRO_TEST(bind_destructive_aliases_input) {
+    ajson_bind_t *b = ajson_bind_init(&user_desc);
+    aml_pool_t *pool = aml_pool_init(1024);
+
+    char *p = aml_pool_strdup(pool, user_json);
+    char *ep = p + strlen(p);
+    user_t u;
+    memset(&u, 0, sizeof(u));
+    MACRO_ASSERT_EQ_INT(ajson_bind_parse(b, &u, p, ep, pool, NULL,
+                                         AJSON_SAX_DESTRUCTIVE | AJSON_SAX_VALIDATE_UTF8), 0);
+    check_user(&u);
+    MACRO_ASSERT_TRUE(u.name > p && u.name < ep);
+    MACRO_ASSERT_TRUE(u.home.city > p && u.home.city < ep);
+
+    aml_pool_destroy(pool);
+    ajson_bind_destroy(b);
+}
+
+MACRO_TEST(bind_missing_null_and_repeated) {
+    ajson_bind_t *b = ajson_bind_init(&user_desc);
+    aml_pool_t *pool = aml_pool_init(1024);
+
+    user_t u;
+    memset(&u, 0, sizeof(u));
+    u.id = 5;
+    u.score = 1.5;
+    MACRO_ASSERT_EQ_INT(bind_text(b, &u, "{\"id\": null, \"name\": \"x\", \"name\": \"y\","
+                                         " \"tags\": null, \"home\": null}", pool, 0), 0);
+    MACRO_ASSERT_EQ_INT(u.id, 5);
+    MACRO_ASSERT_NEAR(u.score, 1.5, 0);
+    MACRO_ASSERT_STREQ(u.name, "y");
+    MACRO_ASSERT_TRUE(u.tags == NULL);
+    MACRO_ASSERT_TRUE(u.home.city == NULL);
+
+    aml_pool_destroy(pool);
+    ajson_bind_destroy(b);
+}
+
+MACRO_TEST(bind_mismatch) {
+    ajson_bind_t *b = ajson_bind_init(&user_desc);
+    aml_pool_t *pool = aml_pool_init(1024);
+    const char *bad[] = {
+        "{\"id\": \"1\"}",
+        "{\"id\": 1.5}",
+        "{\"id\": 2147483648}",
+        "{\"big\": 9223372036854775808}",
+        "{\"ubig\": -1}",
+        "{\"ubig\": 18446744073709551616}",
+        "{\"active\": 1}",
+        "{\"name\": 1}",
+        "{\"home\": 1}",
+        "{\"home\": []}",
+        "{\"tags\": 1}",
+        "{\"tags\": [\"1\"]}",
+        "{\"tags\": [[1]]}",
+        "{\"past\": [1]}",
+        "[1]",
+        "1",
+    };
+
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        user_t u;
+        memset(&u, 0, sizeof(u));
+        int rc = bind_text(b, &u, bad[i], pool, 0);
+        if (rc != AJSON_BIND_MISMATCH) fprintf(stderr, "case %zu: %s\n", i, bad[i]);
+        MACRO_ASSERT_EQ_INT(rc, AJSON_BIND_MISMATCH);
+    }
+
+    user_t u;
+    memset(&u, 0, sizeof(u));
+    MACRO_ASSERT_EQ_INT(bind_text(b, &u, "{\"id\": 1,}", pool, 0), -1);
+    MACRO_ASSERT_EQ_INT(bind_text(b, &u, "{\"id\": -2147483648}", pool, 0), 0);
+    MACRO_ASSERT_EQ_INT(u.id, INT32_MIN);
+
+    aml_pool_destroy(pool);
+    ajson_bind_destroy(b);
+}
+
+/* A self-referencing descriptor */
+typedef struct node_s {
+    int value;
+    struct node_s *children;
+    size_t num_children;
+} node_t;
+
+static const ajson_bind_desc_t node_desc;
+static const ajson_bind_field_t node_fields[] = {
+    AJSON_BIND_FIELD(node_t, value, AJSON_BIND_INT),
+    AJSON_BIND_OBJECT_ARRAY_FIELD(node_t, children, num_children, &node_desc),
+};
+static const ajson_bind_desc_t node_desc = AJSON_BIND_DESC(node_t, node_fields);
+
+static int node_sum(const node_t *n) {
+    int s = n->value;
+    for (size_t i = 0; i < n->num_children; i++) s += node_sum(n->children + i);
+    return s;
+}
+
+MACRO_TEST(bind_recursive) {
+    ajson_bind_t *b = ajson_bind_init(&node_desc);
+    aml_pool_t *pool = aml_pool_init(1024);
+
+    node_t root;
+    memset(&root, 0, sizeof(root));
+    MACRO_ASSERT_EQ_INT(bind_text(b, &root,
+        "{\"value\": 1, \"children\": [{\"value\": 2},"
+        " {\"value\": 3, \"children\": [{\"value\": 4}, {\"value\": 5}]}]}", pool, 0), 0);
+    MACRO_ASSERT_EQ_SZ(root.num_children, 2);
+    MACRO_ASSERT_EQ_SZ(root.children[1].num_children, 2);
+    MACRO_ASSERT_EQ_INT(node_sum(&root), 15);
+
+    aml_pool_destroy(pool);
+    ajson_bind_destroy(b);
+}
+
+/* Many fields: every key must hash to its own member */
+typedef struct {
+    int v[40];
+} wide_t;
+
+MACRO_TEST(bind_many_fields) {
+    static char names[40][8];
+    ajson_bind_field_t fields[40];
+    for (int i = 0; i < 40; i++) {
+        snprintf(names[i], sizeof(names[i]), "f%d", i);
+        ajson_bind_field_t f = { names[i], offsetof(wide_t, v) + i * sizeof(int),
+                                 AJSON_BIND_INT, NULL, 0 };
+        fields[i] = f;
+    }
+    ajson_bind_desc_t desc = { fields, 40, sizeof(wide_t) };
+    ajson_bind_t *b = ajson_bind_init(&desc);
+    aml_pool_t *pool = aml_pool_init(1024);
+
+    char json[1024];
+    size_t n = 0;
+    json[n++] = '{';
+    for (int i = 39; i >= 0; i--)
+        n += snprintf(json + n, sizeof(json) - n, "\"f%d\": %d%s", i, i * 3, i ? ", " : "}");
+
+    wide_t w;
+    memset(&w, 0, sizeof(w));
+    MACRO_ASSERT_EQ_INT(bind_text(b, &w, json, pool, 0), 0);
+    for (int i = 0; i < 40; i++) MACRO_ASSERT_EQ_INT(w.v[i], i * 3);
+
+    aml_pool_destroy(pool);
+    ajson_bind_destroy(b);
+}
+
+/* ---------- Register ---------- */
+
+int main(void) {
+    macro_test_case tests[16];
+    size_t test_count = 0;
+
+    MACRO_ADD(tests, bind_struct);
+    MACRO_ADD(tests, bind_destructive_aliases_input);
+    MACRO_ADD(tests, bind_missing_null_and_repeated);
+    MACRO_ADD(tests, bind_mismatch);
+    MACRO_ADD(tests, bind_recursive);
+    MACRO_ADD(tests, bind_many_fields);
+
+    macro_run_all("ajson_bind", tests, test_count);
+    return 0;
+}
@@ -0,0 +1,264 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "a-json-sax-library/ajson_bind.h"
+#include "a-json-sax-library/ajson_sax.h"
+#include "a-memory-library/aml_pool.h"
+
+/* Generated at build time from test_ajson_gen_schema.json */
+#include "test_ajson_gen_schema.h"
+
+#include "the-macro-library/macro_test.h"
+
+/* The same types bound at run time, to compare against */
+static const ajson_bind_field_t point_fields[] = {
+    AJSON_BIND_FIELD(point_t, x, AJSON_BIND_DOUBLE),
+    AJSON_BIND_FIELD(point_t, y, AJSON_BIND_DOUBLE),
+};
+static const ajson_bind_desc_t point_desc = AJSON_BIND_DESC(point_t, point_fields);
+
+static const ajson_bind_desc_t order_desc;
+static const ajson_bind_field_t order_fields[] = {
+    AJSON_BIND_FIELD(order_t, id, AJSON_BIND_INT64),
+    AJSON_BIND_FIELD(order_t, symbol, AJSON_BIND_STRING),
+    AJSON_BIND_FIELD(order_t, qty, AJSON_BIND_INT),
+    AJSON_BIND_FIELD(order_t, fill, AJSON_BIND_UINT64),
+    AJSON_BIND_FIELD(order_t, open, AJSON_BIND_BOOL),
+    AJSON_BIND_FIELD(order_t, side, AJSON_BIND_STRING),
+    AJSON_BIND_FIELD(order_t, size, AJSON_BIND_DOUBLE),
+    AJSON_BIND_FIELD(order_t, sort, AJSON_BIND_INT),
+    AJSON_BIND_NAMED("first-name", order_t, first_name, AJSON_BIND_STRING),
+    AJSON_BIND_NAMED("caf\xc3\xa9", order_t, caf__, AJSON_BIND_INT),
+    AJSON_BIND_OBJECT_FIELD(order_t, at, &point_desc),
+    AJSON_BIND_OBJECT_ARRAY_FIELD(order_t, path, num_path, &point_desc),
+    AJSON_BIND_ARRAY_FIELD(order_t, tags, num_tags, AJSON_BIND_STRING),
+    AJSON_BIND_ARRAY_FIELD(order_t, lots, num_lots, AJSON_BIND_INT),
+    AJSON_BIND_OBJECT_ARRAY_FIELD(order_t, children, num_children, &order_desc),
+};
+static const ajson_bind_desc_t order_desc = AJSON_BIND_DESC(order_t, order_fields);
+
+static bool str_equal(const char *a, const char *b) {
+    return a == b || (a && b && !strcmp(a, b));
+}
+
+static bool point_equal(const point_t *a, const point_t *b) {
+    return a->x == b->x && a->y == b->y;
+}
+
+static bool order_equal(const order_t *a, const order_t *b) {
+    if (a->id != b->id || a->qty != b->qty || a->fill != b->fill || a->open != b->open ||
+        a->size != b->size || a->sort != b->sort || a->caf__ != b->caf__ ||
+        !str_equal(a->symbol, b->symbol) || !str_equal(a->side, b->side) ||
+        !str_equal(a->first_name, b->first_name) || !point_equal(&a->at, &b->at) ||
+        a->num_path != b->num_path || a->num_tags != b->num_tags ||
+        a->num_lots != b->num_lots || a->num_children != b->num_children)
+        return false;
+    for (size_t i = 0; i < a->num_path; i++)
+        if (!point_equal(a->path + i, b->path + i)) return false;
+    for (size_t i = 0; i < a->num_tags; i++)
+        if (!str_equal(a->tags[i], b->tags[i])) return false;
+    for (size_t i = 0; i < a->num_lots; i++)
+        if (a->lots[i] != b->lots[i]) return false;
+    for (size_t i = 0; i < a->num_children; i++)
+        if (!order_equal(a->children + i, b->children + i)) return false;
+    return true;
+}
+
+static const char *order_json =
+    "{ \"id\": -9007199254740993, \"symbol\": \"AB\\u0043\", \"qty\": 100,"
+    "  \"fill\": 18446744073709551615, \"open\": false, \"side\": \"buy\","
+    "  \"size\": 1.25e2, \"sort\": -3, \"first-name\": \"Zo\\u00eb\", \"caf\\u00e9\": 7,"
+    "  \"extra\": [ {\"a\": [1, 2.5e-3, \"x\", true, null]}, {} ],"
+    "  \"at\": {\"x\": 1.5, \"y\": -0.0, \"z\": 9},"
+    "  \"path\": [ {\"x\": 1}, null, {\"y\": 123456789012345678901234567890} ],"
+    "  \"tags\": [\"a\", \"b\\n\", null], \"lots\": [], \"sid\": \"x\","
+    "  \"children\": [ {\"id\": 1, \"lots\": [5, 6]}, {\"id\": 2, \"children\": [{\"id\": 3}]} ] }";
+
+MACRO_TEST(gen_order) {
+    aml_pool_t *pool = aml_pool_init(1024);
+    char *p = aml_pool_strdup(pool, order_json);
+
+    order_t o;
+    memset(&o, 0, sizeof(o));
+    MACRO_ASSERT_EQ_INT(order_parse(&o, p, p + strlen(p), pool, NULL, 0), 0);
+    MACRO_ASSERT_TRUE(o.id == -9007199254740993LL);
+    MACRO_ASSERT_STREQ(o.symbol, "ABC");
+    MACRO_ASSERT_EQ_INT(o.qty, 100);
+    MACRO_ASSERT_TRUE(o.fill == UINT64_MAX);
+    MACRO_ASSERT_FALSE(o.open);
+    MACRO_ASSERT_STREQ(o.side, "buy");
+    MACRO_ASSERT_NEAR(o.size, 125.0, 0);
+    MACRO_ASSERT_EQ_INT(o.sort, -3);
+    MACRO_ASSERT_STREQ(o.first_name, "Zo\xc3\xab");
+    MACRO_ASSERT_EQ_INT(o.caf__, 7);
+    MACRO_ASSERT_NEAR(o.at.x, 1.5, 0);
+    MACRO_ASSERT_EQ_SZ(o.num_path, 3);
+    MACRO_ASSERT_NEAR(o.path[1].x, 0, 0);
+    MACRO_ASSERT_NEAR(o.path[2].y, 1.2345678901234568e29, 1e14);
+    MACRO_ASSERT_EQ_SZ(o.num_tags, 3);
+    MACRO_ASSERT_STREQ(o.tags[1], "b\n");
+    MACRO_ASSERT_TRUE(o.tags[2] == NULL);
+    MACRO_ASSERT_EQ_SZ(o.num_lots, 0);
+    MACRO_ASSERT_EQ_SZ(o.num_children, 2);
+    MACRO_ASSERT_EQ_SZ(o.children[0].num_lots, 2);
+    MACRO_ASSERT_EQ_INT(o.children[0].lots[1], 6);
+    MACRO_ASSERT_TRUE(o.children[1].children[0].id == 3);
+
+    /* The input is left as it was */
+    MACRO_ASSERT_STREQ(p, order_json);
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(gen_matches_bind) {
+    const char *docs[] = {
+        order_json,
+        "{}",
+        "{\"qty\": null, \"at\": null, \"tags\": null, \"children\": []}",
+        "{\"id\": 0, \"size\": -0.5, \"size\": 3, \"lots\": [-2147483648, 2147483647]}",
+        "{\"size\": 0.1, \"at\": {\"x\": 1e300, \"y\": 2.2250738585072014e-308}}",
+        "{\"tags\": [\"\\ud83d\\ude00\", \"\\\\\\/\"], \"side\": \"\"}",
+    };
+    ajson_bind_t *b = ajson_bind_init(&order_desc);
+    aml_pool_t *pool = aml_pool_init(1024);
+
+    for (size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+        for (unsigned flags = 0; flags <= AJSON_SAX_DESTRUCTIVE; flags++) {
+            char *p1 = aml_pool_strdup(pool, docs[i]);
+            char *p2 = aml_pool_strdup(pool, docs[i]);
+            size_t n = strlen(docs[i]);
+            order_t g, r;
+            memset(&g, 0, sizeof(g));
+            memset(&r, 0, sizeof(r));
+            MACRO_ASSERT_EQ_INT(order_parse(&g, p1, p1 + n, pool, NULL, flags), 0);
+            MACRO_ASSERT_EQ_INT(ajson_bind_parse(b, &r, p2, p2 + n, pool, NULL, flags), 0);
+            if (!order_equal(&g, &r)) fprintf(stderr, "doc %zu differs\n", i);
+            MACRO_ASSERT_TRUE(order_equal(&g, &r));
+        }
+    }
+    aml_pool_destroy(pool);
+    ajson_bind_destroy(b);
+}
+
+/* Syntax errors (also in skipped values) are reported as the parser would */
+MACRO_TEST(gen_syntax_errors) {
+    const char *bad[] = {
+        "", " ", "{", "{\"id\"}", "{\"id\" 1}", "{\"id\": 1,}", "{\"id\": 1 \"qty\": 2}",
+        "{\"id\": 01}", "{\"size\": 1.}", "{\"size\": .5}", "{\"size\": 1e}", "{\"size\": -}",
+        "{\"x\": [1, 2,]}", "{\"x\": {\"a\" 1}}", "{\"x\": tru}", "{\"x\": nul}",
+        "{\"x\": \"abc}", "{\"x\": [}", "{\"x\": +1}", "{\"x\": 1.e5}", "{\"x\": [01]}",
+        "{\"tags\": [\"a\" \"b\"]}", "{\"at\": {\"x\": 1,}}",
+        "{\"children\": [{\"id\": 1]}",
+    };
+    aml_pool_t *pool = aml_pool_init(1024);
+
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        char *p = aml_pool_strdup(pool, bad[i]);
+        size_t n = strlen(p);
+        order_t o;
+        memset(&o, 0, sizeof(o));
+        char *error_at = NULL;
+        int rc = order_parse(&o, p, p + n, pool, &error_at, 0);
+        if (rc != -1) fprintf(stderr, "case %zu: %s\n", i, bad[i]);
+        MACRO_ASSERT_EQ_INT(rc, -1);
+        MACRO_ASSERT_TRUE(error_at >= p && error_at <= p + n);
+
+        static const ajson_sax_cb_t none = { 0 };
+        MACRO_ASSERT_EQ_INT(ajson_sax_parse(p, p + n, &none, pool, NULL, NULL), -1);
+    }
+
+    /* Only whitespace may follow the object */
+    order_t o;
+    char *p = aml_pool_strdup(pool, "{} \n{}");
+    MACRO_ASSERT_EQ_INT(order_parse(&o, p, p + strlen(p), pool, NULL, 0), -1);
+    p = aml_pool_strdup(pool, "{}]");
+    MACRO_ASSERT_EQ_INT(order_parse(&o, p, p + strlen(p), pool, NULL, 0), -1);
+    p = aml_pool_strdup(pool, " {} \n");
+    MACRO_ASSERT_EQ_INT(order_parse(&o, p, p + strlen(p), pool, NULL, 0), 0);
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(gen_mismatch) {
+    const char *bad[] = {
+        "{\"id\": \"1\"}", "{\"id\": 1.5}", "{\"id\": 1e2}", "{\"id\": 9223372036854775808}",
+        "{\"qty\": 2147483648}", "{\"qty\": -2147483649}", "{\"fill\": -1}",
+        "{\"fill\": 18446744073709551616}", "{\"open\": 0}", "{\"side\": 1}",
+        "{\"size\": \"1\"}", "{\"at\": 1}", "{\"at\": []}", "{\"tags\": \"a\"}",
+        "{\"tags\": [1]}", "{\"lots\": [true]}", "{\"children\": [[]]}", "[]", "1", "null",
+    };
+    aml_pool_t *pool = aml_pool_init(1024);
+
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        char *p = aml_pool_strdup(pool, bad[i]);
+        order_t o;
+        memset(&o, 0, sizeof(o));
+        int rc = order_parse(&o, p, p + strlen(p), pool, NULL, 0);
+        if (rc != AJSON_BIND_MISMATCH) fprintf(stderr, "case %zu: %s\n", i, bad[i]);
+        MACRO_ASSERT_EQ_INT(rc, AJSON_BIND_MISMATCH);
+    }
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(gen_destructive_and_empty) {
+    aml_pool_t *pool = aml_pool_init(1024);
+    char *p = aml_pool_strdup(pool, "{\"symbol\": \"a\\tb\", \"tags\": [\"x\"]}");
+    char *ep = p + strlen(p);
+
+    order_t o;
+    memset(&o, 0, sizeof(o));
+    MACRO_ASSERT_EQ_INT(order_parse(&o, p, ep, pool, NULL, AJSON_SAX_DESTRUCTIVE), 0);
+    MACRO_ASSERT_STREQ(o.symbol, "a\tb");
+    MACRO_ASSERT_TRUE(o.symbol > p && o.symbol < ep);
+    MACRO_ASSERT_TRUE(o.tags[0] > p && o.tags[0] < ep);
+
+    empty_t e;
+    p = aml_pool_strdup(pool, "{\"a\": {\"b\": [1, {}]}, \"c\": \"d\"}");
+    MACRO_ASSERT_EQ_INT(empty_parse(&e, p, p + strlen(p), pool, NULL, 0), 0);
+    aml_pool_destroy(pool);
+}
+
+/* ---------- Register ---------- */
+
+/* Keys that map to the same C name, keywords and num_ clashes */
+MACRO_TEST(gen_member_names) {
+    aml_pool_t *pool = aml_pool_init(1024);
+    char *p = aml_pool_strdup(pool,
+        "{\"first-name\": 1, \"first_name\": 2, \"first.name\": 3, \"int\": 4,"
+        " \"for\": true, \"class\": 5, \"ids\": [6, 7], \"num_ids\": 8,"
+        " \"num_lot\": 9, \"lot\": [10]}");
+
+    names_t n;
+    memset(&n, 0, sizeof(n));
+    MACRO_ASSERT_EQ_INT(names_parse(&n, p, p + strlen(p), pool, NULL, 0), 0);
+    MACRO_ASSERT_EQ_INT(n.first_name, 1);
+    MACRO_ASSERT_EQ_INT(n.first_name_2, 2);
+    MACRO_ASSERT_EQ_INT(n.first_name_3, 3);
+    MACRO_ASSERT_EQ_INT(n.int_, 4);
+    MACRO_ASSERT_TRUE(n.for_);
+    MACRO_ASSERT_EQ_INT(n.class_, 5);
+    MACRO_ASSERT_EQ_SZ(n.num_ids, 2);
+    MACRO_ASSERT_EQ_INT(n.ids[1], 7);
+    MACRO_ASSERT_EQ_INT(n.num_ids_2, 8);
+    MACRO_ASSERT_EQ_INT(n.num_lot, 9);
+    MACRO_ASSERT_EQ_SZ(n.num_lot_2, 1);
+    MACRO_ASSERT_EQ_INT(n.lot_2[0], 10);
+    aml_pool_destroy(pool);
+}
+
+int main(void) {
+    macro_test_case tests[16];
+    size_t test_count = 0;
+
+    MACRO_ADD(tests, gen_order);
+    MACRO_ADD(tests, gen_matches_bind);
+    MACRO_ADD(tests, gen_syntax_errors);
+    MACRO_ADD(tests, gen_mismatch);
+    MACRO_ADD(tests, gen_destructive_and_empty);
+    MACRO_ADD(tests, gen_member_names);
+
+    macro_run_all("ajson_gen", tests, test_count);
+    return 0;
+}
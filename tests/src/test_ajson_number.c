@@ -0,0 +1,207 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#include <locale.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "a-json-sax-library/ajson_number.h"
+
+#include "the-macro-library/macro_test.h"
+
+static const char *format(char *buf, double v) {
+    size_t n = ajson_format_double(buf, v);
+    MACRO_ASSERT_TRUE(n <= AJSON_DOUBLE_MAX_LEN);
+    buf[n] = 0;
+    return buf;
+}
+
+static double from_bits(uint64_t bits) {
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static uint64_t next_random(uint64_t *s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+
+/* Fewest significant digits printf needs to round-trip 'v' */
+static int reference_digits(double v) {
+    char buf[64];
+    for (int prec = 1; prec < 17; prec++) {
+        snprintf(buf, sizeof(buf), "%.*e", prec - 1, v);
+        if (strtod(buf, NULL) == v) return prec;
+    }
+    return 17;
+}
+
+static int significant_digits(const char *s) {
+    const char *p = s;
+    if (*p == '-') p++;
+    while (*p == '0' || *p == '.') p++;
+    int n = 0, trailing = 0;
+    for (; *p && *p != 'e'; p++) {
+        if (*p == '.') continue;
+        n++;
+        trailing = *p == '0' ? trailing + 1 : 0;
+    }
+    return n - trailing;
+}
+
+/* Reads back exactly, is valid JSON and is no longer than printf's
+   shortest round-trip */
+static void check_shortest(double v) {
+    char buf[AJSON_DOUBLE_MAX_LEN + 1];
+    format(buf, v);
+    char *end;
+    double back = strtod(buf, &end);
+    MACRO_ASSERT_TRUE(*end == 0);
+    MACRO_ASSERT_TRUE(memcmp(&back, &v, sizeof(v)) == 0);
+    MACRO_ASSERT_TRUE(buf[0] != '.' && buf[0] != '+' && strchr(buf, ',') == NULL);
+    MACRO_ASSERT_TRUE(v == 0 || significant_digits(buf) <= reference_digits(v));
+}
+
+/* ---------- Layout ---------- */
+
+MACRO_TEST(format_double_layout) {
+    static const struct {
+        double v;
+        const char *text;
+    } cases[] = {
+        { 0.0, "0" },
+        { -0.0, "-0" },
+        { 1.0, "1" },
+        { -2.5, "-2.5" },
+        { 0.1, "0.1" },
+        { 0.3, "0.3" },
+        { 0.1 + 0.2, "0.30000000000000004" },
+        { 123.456, "123.456" },
+        { 1e-4, "0.0001" },
+        { 1.5e-5, "1.5e-05" },
+        { 1e16, "10000000000000000" },
+        { 1e17, "1e+17" },
+        { 9007199254740993.0, "9007199254740992" },
+        { 1e300, "1e+300" },
+        { 1e23, "1e+23" },
+        { 5e-324, "5e-324" },
+        { 2.2250738585072014e-308, "2.2250738585072014e-308" },
+        { -2.2250738585072014e-308, "-2.2250738585072014e-308" },
+        { 1.7976931348623157e308, "1.7976931348623157e+308" },
+        { 1.0 / 0.0, "null" },
+        { -1.0 / 0.0, "null" },
+        { 0.0 / 0.0, "null" },
+    };
+    char buf[AJSON_DOUBLE_MAX_LEN + 1];
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+        MACRO_ASSERT_STREQ(format(buf, cases[i].v), cases[i].text);
+}
+
+/* ---------- Shortest round-trip ---------- */
+
+MACRO_TEST(format_double_powers_of_ten_and_two) {
+    for (int e = -323; e <= 308; e++) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "1e%d", e);
+        check_shortest(strtod(buf, NULL));
+    }
+    for (int e = -1074; e <= 1023; e++) {
+        double v = 1.0;
+        for (int i = 0; i < e; i++) v *= 2;
+        for (int i = 0; i > e; i--) v /= 2;
+        check_shortest(v);
+        check_shortest(-v);
+    }
+}
+
+MACRO_TEST(format_double_random_bits) {
+    uint64_t s = 0x9e3779b97f4a7c15ull;
+    for (int i = 0; i < 50000; i++) {
+        double v = from_bits(next_random(&s));
+        if (v != v || v - v != 0) continue;
+        check_shortest(v);
+    }
+    /* Subnormals and short decimals */
+    for (int i = 0; i < 5000; i++) {
+        check_shortest(from_bits(next_random(&s) & ((1ull << 52) - 1)));
+        check_shortest((double)(next_random(&s) % 1000000) / 1000);
+    }
+}
+
+/* ---------- Parsing ---------- */
+
+static void check_parse(const char *text) {
+    double want = strtod(text, NULL), got = ajson_parse_double(text, strlen(text));
+    if (memcmp(&want, &got, sizeof(want))) fprintf(stderr, "'%s': %.17g\n", text, got);
+    MACRO_ASSERT_TRUE(memcmp(&want, &got, sizeof(want)) == 0);
+}
+
+MACRO_TEST(parse_double_matches_strtod) {
+    static const char *texts[] = {
+        "0", "-0", "1", "-1", "0.5", "0.1", "0.3", "123.456", "1e5", "1E+5", "2e-3",
+        "-0.0e0", "9007199254740992", "9007199254740993", "9007199254740995",
+        "1e22", "1e23", "1.7976931348623157e308", "1e309", "-1e400", "5e-324",
+        "2.4703282292062328e-324", "1e-400", "0.000000000000000000000000001",
+        "12345678901234567890", "1234567890123456789012345678901234567890e-20",
+        "0.1e1", "100000000000000000000000e-3", "3.141592653589793238462643383279",
+    };
+    for (size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); i++) check_parse(texts[i]);
+
+    uint64_t s = 0x2545f4914f6cdd1dull;
+    char buf[64];
+    for (int i = 0; i < 20000; i++) {
+        double v = from_bits(next_random(&s));
+        if (v != v || v - v != 0) continue;
+        snprintf(buf, sizeof(buf), "%.*e", (int)(next_random(&s) % 17), v);
+        check_parse(buf);
+        snprintf(buf, sizeof(buf), "%.*f", (int)(next_random(&s) % 8),
+                 (double)(int64_t)(next_random(&s) % 2000000001) / 1000 - 1000000);
+        check_parse(buf);
+    }
+}
+
+/* Not followed by a NUL: only 'len' bytes are read */
+MACRO_TEST(parse_double_stops_at_len) {
+    MACRO_ASSERT_TRUE(ajson_parse_double("2.5]", 3) == 2.5);
+    MACRO_ASSERT_TRUE(ajson_parse_double("-1e2,", 4) == -100);
+}
+
+/* ---------- Locale ---------- */
+
+MACRO_TEST(number_ignores_locale) {
+    static const char *names[] = { "de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8",
+                                   "fr_FR.utf8", "ru_RU.UTF-8", "de_DE" };
+    const char *found = NULL;
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]) && !found; i++)
+        found = setlocale(LC_NUMERIC, names[i]);
+    if (!found) return; /* No locale with a ',' decimal point installed */
+
+    char buf[AJSON_DOUBLE_MAX_LEN + 1];
+    MACRO_ASSERT_STREQ(format(buf, 2.5), "2.5");
+    MACRO_ASSERT_STREQ(format(buf, -1.25e-7), "-1.25e-07");
+    MACRO_ASSERT_TRUE(ajson_parse_double("2.5", 3) == 2.5);
+    MACRO_ASSERT_TRUE(ajson_parse_double("0.30000000000000004", 19) == 0.1 + 0.2);
+    setlocale(LC_NUMERIC, "C");
+}
+
+/* -------- register & run -------- */
+
+int main(void) {
+    macro_test_case tests[64];
+    size_t test_count = 0;
+
+    MACRO_ADD(tests, format_double_layout);
+    MACRO_ADD(tests, format_double_powers_of_ten_and_two);
+    MACRO_ADD(tests, format_double_random_bits);
+    MACRO_ADD(tests, parse_double_matches_strtod);
+    MACRO_ADD(tests, parse_double_stops_at_len);
+    MACRO_ADD(tests, number_ignores_locale);
+
+    macro_run_all("ajson_number", tests, test_count);
+    return 0;
+}
@@ -6,8 +6,10 @@
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
+#include <sys/uio.h>
 
 #include "a-json-sax-library/ajson_sax.h"
+#include "a-json-sax-library/ajson_sax_impl.h"
 #include "a-memory-library/aml_pool.h"
 #include "a-memory-library/aml_buffer.h"
 
@@ -457,6 +459,12 @@ MACRO_TEST(sax_root_scalars) {
     char j5[] = "123   ";
     MACRO_ASSERT_EQ_INT(ajson_sax_parse(j5, j5+strlen(j5), &stats_handlers, pool, &st, NULL), 0);
 
+    /* A root number ends at whitespace; anything else after it is an error */
+    char j6[] = "1,2";
+    char j7[] = "]";
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse(j6, j6+strlen(j6), &stats_handlers, pool, &st, NULL), -1);
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse(j7, j7+strlen(j7), &stats_handlers, pool, &st, NULL), -1);
+
     aml_pool_destroy(pool);
 }
 
@@ -592,6 +600,399 @@ MACRO_TEST(sax_error_reporting) {
     aml_pool_destroy(pool);
 }
 
+/* ---------- 15) Escape Flag and Parser-side Decoding ---------- */
+
+typedef struct {
+    char vals[4][32];
+    bool escaped[4];
+    int count;
+} escape_ctx_t;
+
+static int esc_on_str(void *ctx, ajson_sax_t *sax, const char *val, size_t len) {
+    escape_ctx_t *e = (escape_ctx_t *)ctx;
+    if (e->count < 4 && len < sizeof(e->vals[0])) {
+        memcpy(e->vals[e->count], val, len);
+        e->vals[e->count][len] = 0;
+        e->escaped[e->count] = sax->has_escapes;
+    }
+    e->count++;
+    return 0;
+}
+static const ajson_sax_cb_t esc_handlers = { .on_key = esc_on_str, .on_string = esc_on_str };
+
+MACRO_TEST(sax_has_escapes_flag) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    /* Escaped backslash right before the closing quote must still close it */
+    char json[] = "{\"plain\": \"a\\\\\\\\\"}";
+
+    escape_ctx_t e = {0};
+    int rc = ajson_sax_parse(json, json + strlen(json), &esc_handlers, pool, &e, NULL);
+
+    MACRO_ASSERT_EQ_INT(rc, 0);
+    MACRO_ASSERT_EQ_INT(e.count, 2);
+    MACRO_ASSERT_STREQ(e.vals[0], "plain");
+    MACRO_ASSERT_FALSE(e.escaped[0]);
+    MACRO_ASSERT_STREQ(e.vals[1], "a\\\\\\\\");
+    MACRO_ASSERT_TRUE(e.escaped[1]);
+
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(sax_decode_strings_option) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    const char *src = "{\"k\\u00e9y\": [\"line\\nbreak\", \"plain\", \"q\\\"q\"]}";
+
+    /* Non-destructive: decoded copies, input left intact */
+    char *json = strdup(src);
+    escape_ctx_t e = {0};
+    int rc = ajson_sax_parse_ex(json, json + strlen(json), &esc_handlers, pool, &e, NULL,
+                                AJSON_SAX_DECODE_STRINGS);
+    MACRO_ASSERT_EQ_INT(rc, 0);
+    MACRO_ASSERT_EQ_INT(e.count, 4);
+    MACRO_ASSERT_STREQ(e.vals[0], "k\xC3\xA9y");
+    MACRO_ASSERT_STREQ(e.vals[1], "line\nbreak");
+    MACRO_ASSERT_STREQ(e.vals[2], "plain");
+    MACRO_ASSERT_FALSE(e.escaped[2]);
+    MACRO_ASSERT_STREQ(e.vals[3], "q\"q");
+    MACRO_ASSERT_STREQ(json, src);
+    free(json);
+
+    /* Destructive: decoded in place inside the input buffer */
+    json = strdup(src);
+    memset(&e, 0, sizeof(e));
+    rc = ajson_sax_parse_ex(json, json + strlen(json), &esc_handlers, pool, &e, NULL,
+                            AJSON_SAX_DESTRUCTIVE | AJSON_SAX_DECODE_STRINGS);
+    MACRO_ASSERT_EQ_INT(rc, 0);
+    MACRO_ASSERT_EQ_INT(e.count, 4);
+    MACRO_ASSERT_STREQ(e.vals[0], "k\xC3\xA9y");
+    MACRO_ASSERT_STREQ(e.vals[1], "line\nbreak");
+    MACRO_ASSERT_STREQ(e.vals[3], "q\"q");
+    MACRO_ASSERT_STREQ(json + 2, "k\xC3\xA9y");
+    free(json);
+
+    aml_pool_destroy(pool);
+}
+
+/* A key must be closed before 'ep', and only whitespace may separate it
+   from its ':' (the baseline parser skipped any bytes up to the colon). */
+MACRO_TEST(sax_key_grammar) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    ajson_sax_cb_t empty_cb = {0};
+    static const struct {
+        const char *json;
+        int rc;
+    } cases[] = {
+        { "{\"a\" x : 1}", -1 },
+        { "{\"a\"x:1}", -1 },
+        { "{\"a\" 1}", -1 },
+        { "{\"a\",:1}", -1 },
+        { "{\"ab", -1 },            /* Unterminated key at 'ep' */
+        { "{\"a\\\"", -1 },        /* Escaped quote, still open */
+        { "{\"a\\", -1 },           /* Cut inside an escape */
+        { "{\"a\" \t:\n1}", 0 },
+        { "{\"a\":1}", 0 },
+    };
+
+    for (unsigned flags = 0; flags < 8; flags++) {
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+            char *buf = strdup(cases[i].json);
+            int rc = ajson_sax_parse_ex(buf, buf + strlen(buf), &empty_cb, pool, NULL, NULL, flags);
+            if (rc != cases[i].rc) printf("flags %u: '%s' gave %d\n", flags, cases[i].json, rc);
+            MACRO_ASSERT_EQ_INT(rc, cases[i].rc);
+            free(buf);
+            aml_pool_clear(pool);
+        }
+    }
+
+    aml_pool_destroy(pool);
+}
+
+/* [p, ep) holds exactly one value: a container still open at 'ep' and
+   anything but whitespace after the root are errors, whatever the root is
+   (the baseline parser only checked what followed a root number). */
+MACRO_TEST(sax_root_grammar) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    ajson_sax_cb_t empty_cb = {0};
+    static const struct {
+        const char *json;
+        int rc;
+        size_t err;
+    } cases[] = {
+        { "[[]", -1, 3 },
+        { "{\"a\":1", -1, 6 },
+        { "{\"a\":[", -1, 6 },
+        { "{}garbage", -1, 2 },
+        { "\"abc\"zz", -1, 5 },
+        { "1zz", -1, 1 },
+        { "1 zz", -1, 2 },
+        { "[1]]", -1, 3 },
+        { "true false", -1, 5 },
+        { "{} \n{}", -1, 4 },
+        { "[1,2]  \n", 0, 0 },
+        { "\"abc\" \t", 0, 0 },
+        { "1 \r\n", 0, 0 },
+        { " null ", 0, 0 },
+    };
+
+    for (unsigned flags = 0; flags < 8; flags++) {
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+            char *buf = strdup(cases[i].json);
+            char *err = NULL;
+            int rc = ajson_sax_parse_ex(buf, buf + strlen(buf), &empty_cb, pool, NULL, &err, flags);
+            if (rc != cases[i].rc) printf("flags %u: '%s' gave %d\n", flags, cases[i].json, rc);
+            MACRO_ASSERT_EQ_INT(rc, cases[i].rc);
+            if (rc) MACRO_ASSERT_EQ_SZ((size_t)(err - buf), cases[i].err);
+            free(buf);
+            aml_pool_clear(pool);
+        }
+    }
+
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(sax_validate_utf8_option) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    ajson_sax_cb_t empty_cb = {0};
+    char *err = NULL;
+
+    /* Multi-byte sequences and all escape forms pass */
+    char ok[] = "{\"k\xC3\xA9y\":[\"\xE2\x82\xAC\xF0\x9F\x98\x80\",\"a\\n\\u00e9\\\"\"]}";
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_ex(ok, ok + strlen(ok), &empty_cb, pool, NULL, &err,
+                                           AJSON_SAX_VALIDATE_UTF8), 0);
+
+    /* Raw control character: accepted by default, rejected when validating */
+    char ctl[] = "[\"ab\x01c\"]";
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse(ctl, ctl + strlen(ctl), &empty_cb, pool, NULL, NULL), 0);
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_ex(ctl, ctl + strlen(ctl), &empty_cb, pool, NULL, &err,
+                                           AJSON_SAX_VALIDATE_UTF8), -1);
+    MACRO_ASSERT_EQ_SZ((size_t)(err - ctl), 4);
+
+    /* Overlong encoding in a key, surrogate in a value, truncated sequence */
+    char overlong[] = "{\"x\xC0\xAF\":1}";
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_ex(overlong, overlong + strlen(overlong), &empty_cb,
+                                           pool, NULL, &err, AJSON_SAX_VALIDATE_UTF8), -1);
+    MACRO_ASSERT_EQ_SZ((size_t)(err - overlong), 3);
+
+    char surrogate[] = "[\"ok\",\"\xED\xA0\x80\"]";
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_ex(surrogate, surrogate + strlen(surrogate), &empty_cb,
+                                           pool, NULL, &err, AJSON_SAX_VALIDATE_UTF8), -1);
+    MACRO_ASSERT_EQ_SZ((size_t)(err - surrogate), 7);
+
+    char truncated[] = "[\"\xE2\x82\"]";
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_ex(truncated, truncated + strlen(truncated), &empty_cb,
+                                           pool, NULL, &err, AJSON_SAX_VALIDATE_UTF8), -1);
+    MACRO_ASSERT_EQ_SZ((size_t)(err - truncated), 2);
+
+    /* Malformed escapes */
+    char bad_esc[] = "[\"a\\qb\"]";
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_ex(bad_esc, bad_esc + strlen(bad_esc), &empty_cb,
+                                           pool, NULL, &err, AJSON_SAX_VALIDATE_UTF8), -1);
+    MACRO_ASSERT_EQ_SZ((size_t)(err - bad_esc), 3);
+
+    char bad_hex[] = "[\"\\u12G4\"]";
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_ex(bad_hex, bad_hex + strlen(bad_hex), &empty_cb,
+                                           pool, NULL, &err, AJSON_SAX_VALIDATE_UTF8), -1);
+    MACRO_ASSERT_EQ_SZ((size_t)(err - bad_hex), 2);
+
+    /* Validation composes with in-place decoding */
+    char both[] = "[\"caf\\u00e9 \xE2\x82\xAC\"]";
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_ex(both, both + strlen(both), &empty_cb, pool, NULL, &err,
+                                           AJSON_SAX_VALIDATE_UTF8 | AJSON_SAX_DECODE_STRINGS |
+                                           AJSON_SAX_DESTRUCTIVE), 0);
+
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(sax_parse_stats) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    char json[] = "{\"special\": {\"v\": 100, \"s\": \"a\\nb\"}, "
+                  "\"normal\": {\"v\": 200}, \"list\": [true, null, \"long string\", [1.5]]}";
+    size_t len = strlen(json);
+
+    unified_ctx_t c = {0};
+    ajson_sax_stats_t st;
+    int rc = ajson_sax_parse_stats(json, json + len, &u_root_handlers, pool, &c, NULL,
+                                   AJSON_SAX_TIME_CALLBACKS, &st);
+
+    MACRO_ASSERT_EQ_INT(rc, 0);
+    MACRO_ASSERT_EQ_INT(c.user_num, 100);
+    MACRO_ASSERT_EQ_SZ(st.bytes, len);
+    MACRO_ASSERT_EQ_SZ(st.objects, 3);
+    MACRO_ASSERT_EQ_SZ(st.arrays, 2);
+    MACRO_ASSERT_EQ_SZ(st.keys, 6);
+    MACRO_ASSERT_EQ_SZ(st.strings, 2);
+    MACRO_ASSERT_EQ_SZ(st.numbers, 3);
+    MACRO_ASSERT_EQ_SZ(st.bools, 1);
+    MACRO_ASSERT_EQ_SZ(st.nulls, 1);
+    MACRO_ASSERT_EQ_SZ(st.escaped_strings, 1);
+    MACRO_ASSERT_EQ_SZ(st.longest_string, strlen("long string"));
+    MACRO_ASSERT_EQ_INT(st.max_depth, 3);
+    MACRO_ASSERT_EQ_SZ(st.handler_pushes, 1);
+    MACRO_ASSERT_EQ_SZ(st.handler_pops, 1);
+    MACRO_ASSERT_TRUE(st.pool_bytes >= sizeof(sax_handler_node_t));
+    MACRO_ASSERT_TRUE(st.total_ns >= st.callback_ns);
+
+    /* Without the timing option no clock is read */
+    rc = ajson_sax_parse_stats(json, json + len, &u_root_handlers, pool, &c, NULL, 0, &st);
+    MACRO_ASSERT_EQ_INT(rc, 0);
+    MACRO_ASSERT_EQ_SZ(st.objects, 3);
+    MACRO_ASSERT_TRUE(st.total_ns == 0 && st.callback_ns == 0);
+
+    /* On failure 'bytes' stops at the error */
+    char bad[] = "[1, 2, {\"a\": x}]";
+    char *err = NULL;
+    rc = ajson_sax_parse_stats(bad, bad + strlen(bad), &u_root_handlers, pool, &c, &err, 0, &st);
+    MACRO_ASSERT_EQ_INT(rc, -1);
+    MACRO_ASSERT_EQ_SZ(st.bytes, (size_t)(err - bad));
+    MACRO_ASSERT_EQ_SZ(st.numbers, 2);
+    MACRO_ASSERT_EQ_SZ(st.keys, 1);
+
+    aml_pool_destroy(pool);
+}
+
+/* ---------- Specialized Parsers ---------- */
+
+AJSON_SAX_DEFINE_PARSER(stats_parse_static, stats_handlers)
+AJSON_SAX_DEFINE_PARSER(unified_parse_static, u_root_handlers)
+AJSON_SAX_DEFINE_PARSER_EX(esc_parse_static, esc_handlers,
+                           AJSON_SAX_DESTRUCTIVE | AJSON_SAX_DECODE_STRINGS)
+
+MACRO_TEST(sax_static_parser_matches_dynamic) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+
+    /* Every callback present */
+    char json[] = "{\"s\":\"hello\", \"n\": [1, -2.5e3, 0], \"b\": false, \"z\": null, \"o\": {}}";
+    stats_ctx_t a, b;
+    reset_stats(&a);
+    reset_stats(&b);
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse(json, json + strlen(json), &stats_handlers, pool, &a, NULL), 0);
+    MACRO_ASSERT_EQ_INT(stats_parse_static(json, json + strlen(json), pool, &b, NULL), 0);
+    MACRO_ASSERT_TRUE(memcmp(&a, &b, sizeof(a)) == 0);
+
+    /* Errors are reported the same way */
+    char bad[] = "{\"a\": [1, 2,]}";
+    char *err_a = NULL, *err_b = NULL;
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse(bad, bad + strlen(bad), &stats_handlers, pool, &a, &err_a), -1);
+    MACRO_ASSERT_EQ_INT(stats_parse_static(bad, bad + strlen(bad), pool, &b, &err_b), -1);
+    MACRO_ASSERT_TRUE(err_a == err_b);
+
+    /* Handlers pushed at run time take over from the static table */
+    char nested[] = "{\"special\": {\"v\": 100}, \"normal\": {\"v\": 200}}";
+    unified_ctx_t c = {0};
+    MACRO_ASSERT_EQ_INT(unified_parse_static(nested, nested + strlen(nested), pool, &c, NULL), 0);
+    MACRO_ASSERT_EQ_INT(c.user_num, 100);
+    MACRO_ASSERT_EQ_INT(c.root_num, 200);
+
+    /* Options are honored */
+    char esc[] = "[\"line\\nbreak\", \"plain\"]";
+    escape_ctx_t e = {0};
+    MACRO_ASSERT_EQ_INT(esc_parse_static(esc, esc + strlen(esc), pool, &e, NULL), 0);
+    MACRO_ASSERT_EQ_INT(e.count, 2);
+    MACRO_ASSERT_STREQ(e.vals[0], "line\nbreak");
+    MACRO_ASSERT_TRUE(e.escaped[0]);
+    MACRO_ASSERT_STREQ(e.vals[1], "plain");
+
+    aml_pool_destroy(pool);
+}
+
+/* ---------- Batches ---------- */
+
+MACRO_TEST(sax_parse_batch) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    static const char *const texts[] = {
+        "{\"a\": [1, 2], \"b\": \"x\"}", "[true, null]", "{\"a\" 1}", "\"s\"", "[]",
+        "{\"k\": {\"n\": [1, 2, 3]}}",
+    };
+    enum { N = sizeof(texts) / sizeof(texts[0]) };
+
+    /* Each document in its own allocation and without a shared ctx */
+    struct iovec docs[N];
+    stats_ctx_t st[N];
+    void *ctxs[N];
+    int status[N];
+    char *errors[N];
+    for (size_t i = 0; i < N; i++) {
+        docs[i].iov_base = strdup(texts[i]);
+        docs[i].iov_len = strlen(texts[i]);
+        reset_stats(&st[i]);
+        ctxs[i] = &st[i];
+    }
+
+    size_t failed = ajson_sax_parse_batch(docs, N, &stats_handlers, pool, ctxs,
+                                          status, errors, 0);
+    MACRO_ASSERT_EQ_SZ(failed, 1);
+    for (size_t i = 0; i < N; i++) {
+        stats_ctx_t one;
+        reset_stats(&one);
+        char *copy = strdup(texts[i]);
+        int rc = ajson_sax_parse(copy, copy + strlen(copy), &stats_handlers, pool, &one, NULL);
+        MACRO_ASSERT_EQ_INT(status[i], rc);
+        MACRO_ASSERT_TRUE(memcmp(&st[i], &one, sizeof(one)) == 0);
+        free(copy);
+    }
+    MACRO_ASSERT_EQ_INT(status[2], -1);
+    MACRO_ASSERT_TRUE(errors[2] == (char *)docs[2].iov_base + 5);
+    MACRO_ASSERT_TRUE(errors[0] == NULL && errors[5] == NULL);
+    MACRO_ASSERT_EQ_INT(st[5].num_count, 3);
+
+    /* Callback results are reported per document; the batch goes on */
+    char abort_doc[] = "{\"ok\": 1, \"abort\": 0}";
+    struct iovec two[2] = { { abort_doc, strlen(abort_doc) }, { docs[1].iov_base, docs[1].iov_len } };
+    failed = ajson_sax_parse_batch(two, 2, &abort_h, pool, NULL, status, NULL, 0);
+    MACRO_ASSERT_EQ_SZ(failed, 1);
+    MACRO_ASSERT_EQ_INT(status[0], 42);
+    MACRO_ASSERT_EQ_INT(status[1], 0);
+
+    MACRO_ASSERT_EQ_SZ(ajson_sax_parse_batch(docs, 0, &stats_handlers, pool, NULL, status, NULL, 0), 0);
+
+    for (size_t i = 0; i < N; i++) free(docs[i].iov_base);
+    aml_pool_destroy(pool);
+}
+
+/* ---------- Reusable Parser ---------- */
+
+MACRO_TEST(sax_reusable_parser) {
+    ajson_sax_parser_t *ps = ajson_sax_parser_init(&u_root_handlers, 0, 0);
+    aml_pool_t *pool = ajson_sax_parser_pool(ps);
+
+    /* The pushed handlers come from the pool, which each parse clears */
+    char nested[] = "{\"special\": {\"v\": 100}, \"normal\": {\"v\": 200}}";
+    size_t used = 0;
+    for (int i = 0; i < 1000; i++) {
+        unified_ctx_t c = {0};
+        MACRO_ASSERT_EQ_INT(ajson_sax_parser_parse(ps, nested, nested + strlen(nested), &c, NULL), 0);
+        MACRO_ASSERT_EQ_INT(c.user_num, 100);
+        MACRO_ASSERT_EQ_INT(c.root_num, 200);
+        if (i == 0) used = aml_pool_used(pool);
+        MACRO_ASSERT_EQ_SZ(aml_pool_used(pool), used);
+    }
+    MACRO_ASSERT_TRUE(used >= sizeof(sax_handler_node_t));
+    ajson_sax_parser_reset(ps);
+    MACRO_ASSERT_EQ_SZ(aml_pool_used(pool), 0);
+
+    /* A failed document does not affect the next one */
+    char bad[] = "{\"a\": [1, 2,]}";
+    char *err = NULL;
+    unified_ctx_t c = {0};
+    MACRO_ASSERT_EQ_INT(ajson_sax_parser_parse(ps, bad, bad + strlen(bad), &c, &err), -1);
+    MACRO_ASSERT_TRUE(err == bad + 13);
+    MACRO_ASSERT_EQ_INT(ajson_sax_parser_parse(ps, nested, nested + strlen(nested), &c, NULL), 0);
+    MACRO_ASSERT_EQ_INT(c.user_num, 100);
+    ajson_sax_parser_destroy(ps);
+
+    /* Options are fixed at init */
+    ps = ajson_sax_parser_init(&esc_handlers, AJSON_SAX_DECODE_STRINGS, 256);
+    for (int i = 0; i < 3; i++) {
+        char esc[] = "[\"line\\nbreak\", \"plain\"]";
+        escape_ctx_t e = {0};
+        MACRO_ASSERT_EQ_INT(ajson_sax_parser_parse(ps, esc, esc + strlen(esc), &e, NULL), 0);
+        MACRO_ASSERT_EQ_INT(e.count, 2);
+        MACRO_ASSERT_STREQ(e.vals[0], "line\nbreak");
+        MACRO_ASSERT_STREQ(e.vals[1], "plain");
+    }
+    ajson_sax_parser_destroy(ps);
+}
+
 /* ---------- Register ---------- */
 
 int main(void) {
@@ -626,6 +1027,16 @@ int main(void) {
 
     MACRO_ADD(tests, sax_error_reporting);
 
+    MACRO_ADD(tests, sax_has_escapes_flag);
+    MACRO_ADD(tests, sax_decode_strings_option);
+    MACRO_ADD(tests, sax_key_grammar);
+    MACRO_ADD(tests, sax_root_grammar);
+    MACRO_ADD(tests, sax_validate_utf8_option);
+    MACRO_ADD(tests, sax_parse_stats);
+    MACRO_ADD(tests, sax_static_parser_matches_dynamic);
+    MACRO_ADD(tests, sax_parse_batch);
+    MACRO_ADD(tests, sax_reusable_parser);
+
     macro_run_all("ajson_sax", tests, test_count);
     return 0;
 }
@@ -0,0 +1,267 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+// tests/test_ajson_sax_coro.cpp
+#include <coroutine>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+#include "a-json-sax-library/ajson_sax_coro.hpp"
+
+#include "the-macro-library/macro_test.h"
+
+/* ---------- Handlers and Documents ---------- */
+
+struct summer {
+    long sum = 0;
+    int keys = 0;
+    void on_number(std::string_view v) { sum += std::strtol(std::string(v).c_str(), nullptr, 10); }
+    void on_key(std::string_view) { keys++; }
+};
+
+/* Document i: {"id": i, "values": [0, 1, ..., i % 50], "name": "doc-i"} */
+static std::string make_doc(int i) {
+    std::string d = "{\"id\": " + std::to_string(i) + ", \"values\": [";
+    for (int v = 0; v <= i % 50; v++) {
+        if (v) d += ", ";
+        d += std::to_string(v);
+    }
+    d += "], \"name\": \"doc-" + std::to_string(i) + "\"}";
+    return d;
+}
+
+static long expected_sum(int i) {
+    long n = i % 50;
+    return i + n * (n + 1) / 2;
+}
+
+/* ---------- Local Event Loop ---------- */
+
+/* Runs ready coroutines in FIFO order, one step each */
+struct loop {
+    std::deque<std::coroutine_handle<>> ready;
+    size_t steps = 0;
+
+    void run() {
+        while (!ready.empty()) {
+            std::coroutine_handle<> h = ready.front();
+            ready.pop_front();
+            steps++;
+            h.resume();
+        }
+    }
+};
+
+/* Delivers a document in small pieces, one per loop turn */
+struct piece_source {
+    loop *l;
+    std::string doc;
+    size_t pos = 0;
+    size_t piece = 1;
+
+    struct awaiter {
+        piece_source *s;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { s->l->ready.push_back(h); }
+        std::string_view await_resume() {
+            size_t n = std::min(s->piece, s->doc.size() - s->pos);
+            std::string_view v(s->doc.data() + s->pos, n);
+            s->pos += n;
+            return v;
+        }
+    };
+    awaiter read() { return awaiter{this}; }
+};
+
+MACRO_TEST(coro_interleaved_parses) {
+    const int N = 2000;
+    loop l;
+    std::vector<piece_source> sources(N);
+    std::vector<summer> handlers(N);
+    std::vector<ajson::task<int>> tasks;
+    tasks.reserve(N);
+
+    for (int i = 0; i < N; i++) {
+        sources[i].l = &l;
+        sources[i].doc = make_doc(i);
+        sources[i].piece = 1 + i % 7;
+        tasks.push_back(ajson::async_parse(sources[i], handlers[i]));
+    }
+
+    /* Every task is parked on its first read before the loop runs */
+    for (int i = 0; i < N; i++) MACRO_ASSERT_FALSE(tasks[i].done());
+    l.run();
+
+    for (int i = 0; i < N; i++) {
+        MACRO_ASSERT_TRUE(tasks[i].done());
+        MACRO_ASSERT_EQ_INT(tasks[i].result(), 0);
+        MACRO_ASSERT_EQ_INT(handlers[i].sum, expected_sum(i));
+        MACRO_ASSERT_EQ_INT(handlers[i].keys, 3);
+    }
+    /* Interleaved: far more loop steps than tasks */
+    MACRO_ASSERT_TRUE(l.steps > (size_t)N * 10);
+}
+
+MACRO_TEST(coro_errors_and_end_of_input) {
+    loop l;
+    summer h1, h2;
+    piece_source bad{&l, "{\"a\": [1, 2,]}", 0, 3};
+    piece_source cut{&l, "{\"a\": [1, 2", 0, 4};
+
+    ajson::task<int> t1 = ajson::async_parse(bad, h1);
+    ajson::task<int> t2 = ajson::async_parse(cut, h2);
+    l.run();
+    MACRO_ASSERT_EQ_INT(t1.result(), -1);
+    MACRO_ASSERT_EQ_INT(t2.result(), -1); /* Ends (empty read) mid-document */
+    MACRO_ASSERT_EQ_INT(h2.sum, 3);       /* '2' is delivered once input ends */
+}
+
+/* A coroutine awaiting a parse, with a stream kept for its offset */
+static ajson::task<int> parse_two(piece_source &src, summer &h, size_t *first_end) {
+    ajson::stream<summer> s(h);
+    int rc = co_await ajson::async_parse(src, s);
+    *first_end = s.offset();
+    co_return rc;
+}
+
+MACRO_TEST(coro_nested_await) {
+    loop l;
+    summer h;
+    size_t end = 0;
+    piece_source src{&l, "{\"x\": 5} trailing", 0, 2};
+
+    ajson::task<int> t = parse_two(src, h, &end);
+    l.run();
+    MACRO_ASSERT_TRUE(t.done());
+    MACRO_ASSERT_EQ_INT(t.result(), 0);
+    MACRO_ASSERT_EQ_INT(h.sum, 5);
+    MACRO_ASSERT_EQ_SZ(end, 8);
+}
+
+/* ---------- epoll Reactor ---------- */
+
+#ifdef __linux__
+
+struct reactor {
+    int ep = epoll_create1(0);
+    ~reactor() { close(ep); }
+
+    void wait_readable(int fd, std::coroutine_handle<> h) {
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLONESHOT;
+        ev.data.ptr = h.address();
+        if (epoll_ctl(ep, EPOLL_CTL_MOD, fd, &ev) && errno == ENOENT)
+            epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    /* Resume whatever became readable; returns how many */
+    int poll(int timeout_ms) {
+        epoll_event evs[64];
+        int n = epoll_wait(ep, evs, 64, timeout_ms);
+        for (int i = 0; i < n; i++)
+            std::coroutine_handle<>::from_address(evs[i].data.ptr).resume();
+        return n > 0 ? n : 0;
+    }
+};
+
+/* Reads a non-blocking pipe, suspending on EAGAIN */
+struct fd_source {
+    reactor *r;
+    int fd;
+    char buf[16];
+
+    struct awaiter {
+        fd_source *s;
+        ssize_t n = -1;
+        bool await_ready() {
+            n = ::read(s->fd, s->buf, sizeof(s->buf));
+            return n >= 0 || errno != EAGAIN;
+        }
+        void await_suspend(std::coroutine_handle<> h) { s->r->wait_readable(s->fd, h); }
+        std::string_view await_resume() {
+            if (n < 0) n = ::read(s->fd, s->buf, sizeof(s->buf));
+            return std::string_view(s->buf, n > 0 ? (size_t)n : 0);
+        }
+    };
+    awaiter read() { return awaiter{this}; }
+};
+
+MACRO_TEST(coro_epoll_pipes) {
+    const int N = 32;
+    reactor r;
+    int rd[N], wr[N];
+    std::string docs[N];
+    size_t sent[N];
+    std::vector<fd_source> sources(N);
+    std::vector<summer> handlers(N);
+    std::vector<ajson::task<int>> tasks;
+    tasks.reserve(N);
+
+    for (int i = 0; i < N; i++) {
+        int fds[2];
+        MACRO_ASSERT_EQ_INT(pipe(fds), 0);
+        rd[i] = fds[0];
+        wr[i] = fds[1];
+        fcntl(rd[i], F_SETFL, fcntl(rd[i], F_GETFL) | O_NONBLOCK);
+        docs[i] = make_doc(i * 7);
+        sent[i] = 0;
+        sources[i].r = &r;
+        sources[i].fd = rd[i];
+        tasks.push_back(ajson::async_parse(sources[i], handlers[i]));
+    }
+
+    /* The writer side trickles 5 bytes per pipe per round */
+    for (bool more = true; more;) {
+        more = false;
+        for (int i = 0; i < N; i++) {
+            if (wr[i] < 0) continue;
+            size_t n = std::min<size_t>(5, docs[i].size() - sent[i]);
+            if (n) MACRO_ASSERT_EQ_INT(write(wr[i], docs[i].data() + sent[i], n), (ssize_t)n);
+            sent[i] += n;
+            if (sent[i] == docs[i].size()) {
+                close(wr[i]);
+                wr[i] = -1;
+            }
+            more = true;
+        }
+        while (r.poll(0)) {}
+    }
+    for (int spins = 0; spins < 100 && r.poll(10); spins++) {}
+
+    for (int i = 0; i < N; i++) {
+        MACRO_ASSERT_TRUE(tasks[i].done());
+        MACRO_ASSERT_EQ_INT(tasks[i].result(), 0);
+        MACRO_ASSERT_EQ_INT(handlers[i].sum, expected_sum(i * 7));
+        close(rd[i]);
+    }
+}
+
+#endif
+
+/* ---------- Register ---------- */
+
+int main(void) {
+    macro_test_case tests[16];
+    size_t test_count = 0;
+
+    MACRO_ADD(tests, coro_interleaved_parses);
+    MACRO_ADD(tests, coro_errors_and_end_of_input);
+    MACRO_ADD(tests, coro_nested_await);
+#ifdef __linux__
+    MACRO_ADD(tests, coro_epoll_pipes);
+#endif
+
+    macro_run_all("ajson_sax_coro", tests, test_count);
+    return 0;
+}
@@ -0,0 +1,213 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+// tests/test_ajson_sax_cpp.cpp
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "a-json-sax-library/ajson_sax.hpp"
+#include "a-memory-library/aml_pool.h"
+
+#include "the-macro-library/macro_test.h"
+
+/* ---------- Handlers ---------- */
+
+/* Every event, in every accepted form */
+struct recorder {
+    std::string log;
+    int max_depth = 0;
+
+    void on_null() { log += "n "; }
+    int on_bool(bool v) { log += v ? "t " : "f "; return 0; }
+    void on_number(std::string_view v) { log += "#"; log += v; log += ' '; }
+    void on_string(ajson::sax &sax, std::string_view v) {
+        log += sax.has_escapes() ? "e:" : "s:";
+        log += v;
+        log += ' ';
+    }
+    int on_key(std::string_view k) { log += k; log += ": "; return 0; }
+    void on_start_object(ajson::sax &sax) {
+        log += "{ ";
+        if (sax.depth() > max_depth) max_depth = sax.depth();
+    }
+    void on_end_object() { log += "} "; }
+    void on_start_array() { log += "[ "; }
+    void on_end_array() { log += "] "; }
+};
+
+struct numbers_only {
+    std::vector<std::string> seen;
+    void on_number(std::string_view v) { seen.emplace_back(v); }
+};
+
+struct empty_handler {};
+
+struct abort_on_key {
+    int on_key(std::string_view k) { return k == "stop" ? 42 : 0; }
+};
+
+/* Scoped push: 'user' objects go to a sub-handler */
+struct user_handler {
+    int numbers = 0;
+    int ends = 0;
+    void on_number(std::string_view) { numbers++; }
+    void on_end_object() { ends++; }
+};
+
+struct root_handler {
+    user_handler user;
+    std::string key;
+    int root_numbers = 0;
+    int root_ends = 0;
+
+    void on_key(std::string_view k) { key = k; }
+    void on_number(std::string_view) { root_numbers++; }
+    void on_start_object(ajson::sax &sax) {
+        if (key == "user") sax.push(user);
+    }
+    void on_end_object() { root_ends++; }
+};
+
+/* Pushes for arrays too, and nests a push inside a pushed handler */
+struct leaf_handler {
+    int strings = 0;
+    void on_string(std::string_view) { strings++; }
+};
+
+struct list_handler {
+    leaf_handler leaf;
+    int numbers = 0;
+    void on_number(std::string_view) { numbers++; }
+    void on_start_array(ajson::sax &sax) { sax.push(leaf); }
+};
+
+struct outer_handler {
+    list_handler list;
+    int strings = 0;
+    void on_string(std::string_view) { strings++; }
+    void on_start_array(ajson::sax &sax) {
+        if (sax.depth() == 1) sax.push(list);
+    }
+};
+
+/* ---------- Tests ---------- */
+
+MACRO_TEST(cpp_all_events) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    char json[] = "{\"a\": [1, -2.5, true, false, null], \"s\": \"x\\ty\", \"o\": {\"p\": \"q\"}}";
+
+    recorder r;
+    MACRO_ASSERT_EQ_INT(ajson::sax_parse(json, json + strlen(json), r, pool), 0);
+    MACRO_ASSERT_STREQ(r.log.c_str(),
+        "{ a: [ #1 #-2.5 t f n ] s: e:x\\ty o: { p: s:q } } ");
+    MACRO_ASSERT_EQ_INT(r.max_depth, 1); /* Start events report the depth of the container */
+
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(cpp_optional_members) {
+    char json[] = "[{\"k\": [1, 2]}, \"s\", 3, null]";
+
+    numbers_only n;
+    MACRO_ASSERT_EQ_INT(ajson::sax_parse(json, json + strlen(json), n), 0);
+    MACRO_ASSERT_EQ_SZ(n.seen.size(), 3);
+    MACRO_ASSERT_STREQ(n.seen[2].c_str(), "3");
+
+    char json2[] = "{\"a\": {\"b\": [true]}}";
+    empty_handler e;
+    MACRO_ASSERT_EQ_INT(ajson::sax_parse(json2, json2 + strlen(json2), e), 0);
+}
+
+MACRO_TEST(cpp_errors_and_abort) {
+    char bad[] = "{\"a\": [1, 2,]}";
+    char *err = nullptr, *c_err = nullptr;
+    empty_handler e;
+    static const ajson_sax_cb_t none = {};
+    MACRO_ASSERT_EQ_INT(ajson::sax_parse(bad, bad + strlen(bad), e, nullptr, &err), -1);
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse(bad, bad + strlen(bad), &none, nullptr, nullptr, &c_err), -1);
+    MACRO_ASSERT_TRUE(err != nullptr && err == c_err);
+
+    char json[] = "{\"go\": 1, \"stop\": 2}";
+    abort_on_key a;
+    MACRO_ASSERT_EQ_INT(ajson::sax_parse(json, json + strlen(json), a), 42);
+}
+
+MACRO_TEST(cpp_scoped_push) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    char json[] = "{\"user\": {\"id\": 1, \"nested\": {\"x\": 2}}, \"n\": 3, \"other\": {\"y\": 4}}";
+
+    root_handler r;
+    MACRO_ASSERT_EQ_INT(ajson::sax_parse(json, json + strlen(json), r, pool), 0);
+    MACRO_ASSERT_EQ_INT(r.user.numbers, 2);
+    MACRO_ASSERT_EQ_INT(r.user.ends, 2);    /* 'nested' and the user object itself */
+    MACRO_ASSERT_EQ_INT(r.root_numbers, 2); /* 'n' and 'y': control came back */
+    MACRO_ASSERT_EQ_INT(r.root_ends, 2);    /* 'other' and the root object */
+
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(cpp_nested_push_without_pool) {
+    char json[] = "[\"a\", [1, [\"b\", \"c\"], 2, [\"d\"]], \"e\"]";
+
+    /* No pool given: the first push creates one, released by sax_parse */
+    outer_handler o;
+    MACRO_ASSERT_EQ_INT(ajson::sax_parse(json, json + strlen(json), o), 0);
+    MACRO_ASSERT_EQ_INT(o.strings, 2);
+    MACRO_ASSERT_EQ_INT(o.list.numbers, 2);
+    MACRO_ASSERT_EQ_INT(o.list.leaf.strings, 3);
+}
+
+MACRO_TEST(cpp_flags) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    char json[] = "[\"line\\nbreak\", \"plain\"]";
+
+    recorder r;
+    int rc = ajson::sax_parse_ex<AJSON_SAX_DESTRUCTIVE | AJSON_SAX_DECODE_STRINGS>(
+        json, json + strlen(json), r, pool);
+    MACRO_ASSERT_EQ_INT(rc, 0);
+    MACRO_ASSERT_STREQ(r.log.c_str(), "[ e:line\nbreak s:plain ] ");
+
+    char bad[] = "[\"\xC3\x28\"]";
+    char *err = nullptr;
+    rc = ajson::sax_parse_ex<AJSON_SAX_VALIDATE_UTF8>(bad, bad + strlen(bad), r, pool, &err);
+    MACRO_ASSERT_EQ_INT(rc, -1);
+    MACRO_ASSERT_TRUE(err == bad + 2);
+
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(cpp_decode_without_pool) {
+    /* No pool given: decoded copies go in one created for the parse */
+    char json[] = "[\"a\\nb\", {\"k\\u00e9\": \"plain\"}]";
+    recorder r;
+    int rc = ajson::sax_parse_ex<AJSON_SAX_DECODE_STRINGS>(json, json + strlen(json), r);
+    MACRO_ASSERT_EQ_INT(rc, 0);
+    MACRO_ASSERT_STREQ(r.log.c_str(), "[ e:a\nb { k\xC3\xA9: s:plain } ] ");
+
+    r.log.clear();
+    char again[] = "[\"a\\nb\"]";
+    rc = ajson::sax_parse_ex<AJSON_SAX_DECODE_STRINGS | AJSON_SAX_VALIDATE_UTF8>(
+        again, again + strlen(again), r);
+    MACRO_ASSERT_EQ_INT(rc, 0);
+    MACRO_ASSERT_STREQ(r.log.c_str(), "[ e:a\nb ] ");
+}
+
+/* ---------- Register ---------- */
+
+int main(void) {
+    macro_test_case tests[16];
+    size_t test_count = 0;
+
+    MACRO_ADD(tests, cpp_all_events);
+    MACRO_ADD(tests, cpp_optional_members);
+    MACRO_ADD(tests, cpp_errors_and_abort);
+    MACRO_ADD(tests, cpp_scoped_push);
+    MACRO_ADD(tests, cpp_nested_push_without_pool);
+    MACRO_ADD(tests, cpp_flags);
+    MACRO_ADD(tests, cpp_decode_without_pool);
+
+    macro_run_all("ajson_sax_cpp", tests, test_count);
+    return 0;
+}
@@ -0,0 +1,227 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "a-json-sax-library/ajson_sax_decompress.h"
+#include "a-memory-library/aml_buffer.h"
+#include "a-memory-library/aml_pool.h"
+
+#include "the-macro-library/macro_test.h"
+
+#ifdef AJSON_SAX_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef AJSON_SAX_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#if defined(AJSON_SAX_HAVE_ZLIB) || defined(AJSON_SAX_HAVE_ZSTD)
+
+static int sum_number(void *ctx, ajson_sax_t *sax, const char *v, size_t len) {
+    (void)sax;
+    (void)len;
+    *(long long *)ctx += atoll(v);
+    return 0;
+}
+
+static const ajson_sax_cb_t sum_handlers = { .on_number = sum_number };
+
+/* An array of 1..n, several decompression blocks long */
+static void make_doc(aml_buffer_t *bh, int n) {
+    aml_buffer_clear(bh);
+    aml_buffer_appendc(bh, '[');
+    for (int i = 1; i <= n; i++) aml_buffer_appendf(bh, "%s%d", i > 1 ? ",\n" : "", i);
+    aml_buffer_appends(bh, "]\n");
+}
+
+/* The fd readers go through a temporary file */
+static int temp_fd(const void *data, size_t len) {
+    char path[] = "/tmp/ajson_decompress_XXXXXX";
+    int fd = mkstemp(path);
+    MACRO_ASSERT_TRUE(fd >= 0);
+    unlink(path);
+    MACRO_ASSERT_TRUE(write(fd, data, len) == (ssize_t)len);
+    lseek(fd, 0, SEEK_SET);
+    return fd;
+}
+
+#endif
+
+/* ---------- gzip ---------- */
+
+#ifdef AJSON_SAX_HAVE_ZLIB
+
+/* windowBits 15 + 16 writes a gzip header, plain 15 a zlib one */
+static void deflate_to(aml_buffer_t *out, const char *data, size_t len, int window_bits) {
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    MACRO_ASSERT_EQ_INT(deflateInit2(&z, 6, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY), Z_OK);
+    size_t bound = deflateBound(&z, len);
+    size_t at = aml_buffer_length(out);
+    unsigned char *dst = (unsigned char *)aml_buffer_append_alloc(out, bound);
+    z.next_in = (Bytef *)data;
+    z.avail_in = (uInt)len;
+    z.next_out = dst;
+    z.avail_out = (uInt)bound;
+    MACRO_ASSERT_EQ_INT(deflate(&z, Z_FINISH), Z_STREAM_END);
+    aml_buffer_resize(out, at + z.total_out);
+    deflateEnd(&z);
+}
+
+MACRO_TEST(gzip_parse) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    aml_buffer_t *doc = aml_buffer_init(1 << 16);
+    aml_buffer_t *gz = aml_buffer_init(1 << 16);
+    make_doc(doc, 100000);
+    long long expect = 100000LL * 100001 / 2;
+
+    for (int zlib = 0; zlib < 2; zlib++) {
+        aml_buffer_clear(gz);
+        deflate_to(gz, aml_buffer_data(doc), aml_buffer_length(doc), zlib ? 15 : 15 + 16);
+
+        long long sum = 0;
+        MACRO_ASSERT_EQ_INT(ajson_sax_parse_gzip(aml_buffer_data(gz), aml_buffer_length(gz),
+                                                 &sum_handlers, pool, &sum, 0), 0);
+        MACRO_ASSERT_TRUE(sum == expect);
+
+        sum = 0;
+        int fd = temp_fd(aml_buffer_data(gz), aml_buffer_length(gz));
+        MACRO_ASSERT_EQ_INT(ajson_sax_parse_gzip_fd(fd, &sum_handlers, pool, &sum,
+                                                    AJSON_SAX_DESTRUCTIVE), 0);
+        MACRO_ASSERT_TRUE(sum == expect);
+        close(fd);
+    }
+
+    /* Concatenated members form one stream */
+    aml_buffer_clear(gz);
+    deflate_to(gz, "[1, 2", 5, 15 + 16);
+    deflate_to(gz, ", 3]", 4, 15 + 16);
+    long long sum = 0;
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_gzip(aml_buffer_data(gz), aml_buffer_length(gz),
+                                             &sum_handlers, pool, &sum, 0), 0);
+    MACRO_ASSERT_TRUE(sum == 6);
+
+    aml_buffer_destroy(gz);
+    aml_buffer_destroy(doc);
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(gzip_errors) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    aml_buffer_t *doc = aml_buffer_init(1 << 16);
+    aml_buffer_t *gz = aml_buffer_init(1 << 16);
+    long long sum = 0;
+
+    /* Truncated and corrupt data */
+    make_doc(doc, 20000);
+    deflate_to(gz, aml_buffer_data(doc), aml_buffer_length(doc), 15 + 16);
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_gzip(aml_buffer_data(gz), aml_buffer_length(gz) / 2,
+                                             &sum_handlers, pool, &sum, 0),
+                        AJSON_SAX_DECOMPRESS_ERROR);
+    aml_buffer_data(gz)[0] = 0;
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_gzip(aml_buffer_data(gz), aml_buffer_length(gz),
+                                             &sum_handlers, pool, &sum, 0),
+                        AJSON_SAX_DECOMPRESS_ERROR);
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_gzip("", 0, &sum_handlers, pool, &sum, 0),
+                        AJSON_SAX_DECOMPRESS_ERROR);
+
+    /* Syntax errors come from the parser */
+    aml_buffer_clear(gz);
+    deflate_to(gz, "[1, }", 5, 15 + 16);
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_gzip(aml_buffer_data(gz), aml_buffer_length(gz),
+                                             &sum_handlers, pool, &sum, 0), -1);
+
+    /* Decompression stops at the end of the document */
+    aml_buffer_clear(gz);
+    deflate_to(gz, "[5]", 3, 15 + 16);
+    aml_buffer_appends(gz, "not gzip");
+    sum = 0;
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_gzip(aml_buffer_data(gz), aml_buffer_length(gz),
+                                             &sum_handlers, pool, &sum, 0), 0);
+    MACRO_ASSERT_TRUE(sum == 5);
+
+    aml_buffer_destroy(gz);
+    aml_buffer_destroy(doc);
+    aml_pool_destroy(pool);
+}
+
+#endif /* AJSON_SAX_HAVE_ZLIB */
+
+/* ---------- zstd ---------- */
+
+#ifdef AJSON_SAX_HAVE_ZSTD
+
+static void zstd_to(aml_buffer_t *out, const char *data, size_t len) {
+    size_t bound = ZSTD_compressBound(len);
+    size_t at = aml_buffer_length(out);
+    void *dst = aml_buffer_append_alloc(out, bound);
+    size_t n = ZSTD_compress(dst, bound, data, len, 3);
+    MACRO_ASSERT_FALSE(ZSTD_isError(n));
+    aml_buffer_resize(out, at + n);
+}
+
+MACRO_TEST(zstd_parse) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    aml_buffer_t *doc = aml_buffer_init(1 << 16);
+    aml_buffer_t *zs = aml_buffer_init(1 << 16);
+    make_doc(doc, 100000);
+    long long expect = 100000LL * 100001 / 2;
+
+    zstd_to(zs, aml_buffer_data(doc), aml_buffer_length(doc));
+    long long sum = 0;
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_zstd(aml_buffer_data(zs), aml_buffer_length(zs),
+                                             &sum_handlers, pool, &sum, 0), 0);
+    MACRO_ASSERT_TRUE(sum == expect);
+
+    sum = 0;
+    int fd = temp_fd(aml_buffer_data(zs), aml_buffer_length(zs));
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_zstd_fd(fd, &sum_handlers, pool, &sum,
+                                                AJSON_SAX_DESTRUCTIVE), 0);
+    MACRO_ASSERT_TRUE(sum == expect);
+    close(fd);
+
+    /* Several frames form one stream */
+    aml_buffer_clear(zs);
+    zstd_to(zs, "[1, 2", 5);
+    zstd_to(zs, ", 3]", 4);
+    sum = 0;
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_zstd(aml_buffer_data(zs), aml_buffer_length(zs),
+                                             &sum_handlers, pool, &sum, 0), 0);
+    MACRO_ASSERT_TRUE(sum == 6);
+
+    /* Truncated */
+    aml_buffer_clear(zs);
+    zstd_to(zs, aml_buffer_data(doc), aml_buffer_length(doc));
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_zstd(aml_buffer_data(zs), aml_buffer_length(zs) / 2,
+                                             &sum_handlers, pool, &sum, 0),
+                        AJSON_SAX_DECOMPRESS_ERROR);
+
+    aml_buffer_destroy(zs);
+    aml_buffer_destroy(doc);
+    aml_pool_destroy(pool);
+}
+
+#endif /* AJSON_SAX_HAVE_ZSTD */
+
+/* ---------- Register ---------- */
+
+int main(void) {
+    macro_test_case tests[8];
+    size_t test_count = 0;
+
+#ifdef AJSON_SAX_HAVE_ZLIB
+    MACRO_ADD(tests, gzip_parse);
+    MACRO_ADD(tests, gzip_errors);
+#endif
+#ifdef AJSON_SAX_HAVE_ZSTD
+    MACRO_ADD(tests, zstd_parse);
+#endif
+
+    macro_run_all("ajson_sax_decompress", tests, test_count);
+    return 0;
+}
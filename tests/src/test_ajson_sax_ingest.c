@@ -0,0 +1,191 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "a-json-sax-library/ajson_sax_ingest.h"
+#include "a-memory-library/aml_buffer.h"
+#include "a-memory-library/aml_pool.h"
+
+#include "the-macro-library/macro_test.h"
+
+/* Each file sums its numbers and counts its strings */
+typedef struct {
+    long long sum;
+    size_t strings;
+    size_t string_bytes;
+} file_ctx_t;
+
+typedef struct {
+    file_ctx_t files[8];
+    int rc[8];
+    int err[8];
+    size_t ended;
+    size_t stop_after;      /* on_end_file returns 5 after this many files */
+} run_ctx_t;
+
+static int sum_number(void *ctx, ajson_sax_t *sax, const char *v, size_t len) {
+    (void)sax;
+    (void)len;
+    ((file_ctx_t *)ctx)->sum += atoll(v);
+    return 0;
+}
+
+static int count_string(void *ctx, ajson_sax_t *sax, const char *v, size_t len) {
+    (void)sax;
+    (void)v;
+    ((file_ctx_t *)ctx)->strings++;
+    ((file_ctx_t *)ctx)->string_bytes += len;
+    return 0;
+}
+
+static const ajson_sax_cb_t sum_handlers = {
+    .on_number = sum_number, .on_string = count_string
+};
+
+static const ajson_sax_cb_t no_handlers = {0};
+
+static void *begin_file(void *arg, size_t index, const char *path) {
+    (void)path;
+    return ((run_ctx_t *)arg)->files + index;
+}
+
+static int end_file(void *arg, size_t index, const char *path, void *ctx, int rc) {
+    run_ctx_t *r = (run_ctx_t *)arg;
+    (void)path;
+    MACRO_ASSERT_TRUE(ctx == r->files + index);
+    MACRO_ASSERT_EQ_SZ(index, r->ended);
+    r->rc[index] = rc;
+    r->err[index] = rc == AJSON_SAX_INGEST_IO_ERROR ? errno : 0;
+    r->ended++;
+    return r->stop_after && r->ended == r->stop_after ? 5 : 0;
+}
+
+static const ajson_sax_ingest_file_cb_t file_handlers = { begin_file, end_file };
+
+static void write_file(const char *path, const char *data, size_t len) {
+    FILE *f = fopen(path, "wb");
+    MACRO_ASSERT_TRUE(f != NULL);
+    MACRO_ASSERT_EQ_SZ(fwrite(data, 1, len, f), len);
+    fclose(f);
+}
+
+/* Three files larger, smaller and much larger than a 4 KiB read */
+MACRO_TEST(ingest_files) {
+    char dir[] = "/tmp/ajson_ingest_XXXXXX";
+    MACRO_ASSERT_TRUE(mkdtemp(dir) != NULL);
+    char paths[3][64];
+    const char *list[3];
+    for (int i = 0; i < 3; i++) {
+        snprintf(paths[i], sizeof(paths[i]), "%s/%d.json", dir, i);
+        list[i] = paths[i];
+    }
+
+    aml_buffer_t *bh = aml_buffer_init(1 << 16);
+    aml_buffer_appends(bh, "[");
+    for (int i = 1; i <= 2000; i++) aml_buffer_appendf(bh, "%s%d", i > 1 ? ", " : "", i);
+    aml_buffer_appends(bh, "]\n");
+    write_file(paths[0], aml_buffer_data(bh), aml_buffer_length(bh));
+
+    write_file(paths[1], "{\"a\": -7, \"b\": \"x\"}", 19);
+
+    aml_buffer_clear(bh);
+    aml_buffer_appends(bh, "{\"big\": \"");
+    for (int i = 0; i < 30000; i++) aml_buffer_appendc(bh, (char)('a' + i % 26));
+    aml_buffer_appends(bh, "\", \"n\": 42}");
+    write_file(paths[2], aml_buffer_data(bh), aml_buffer_length(bh));
+
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    for (unsigned backend = 0; backend < 2; backend++) {
+        ajson_sax_ingest_options_t o = { 3, 4096, 2, backend ? AJSON_SAX_INGEST_NO_URING : 0 };
+        run_ctx_t r;
+        memset(&r, 0, sizeof(r));
+        MACRO_ASSERT_EQ_INT(ajson_sax_ingest(list, 3, &sum_handlers, &file_handlers, &r,
+                                             pool, 0, &o), 0);
+        MACRO_ASSERT_EQ_SZ(r.ended, 3);
+        MACRO_ASSERT_TRUE(r.files[0].sum == 2000LL * 2001 / 2);
+        MACRO_ASSERT_TRUE(r.files[1].sum == -7);
+        MACRO_ASSERT_EQ_SZ(r.files[1].strings, 1);
+        MACRO_ASSERT_TRUE(r.files[2].sum == 42);
+        MACRO_ASSERT_EQ_SZ(r.files[2].string_bytes, 30000);
+        for (int i = 0; i < 3; i++) MACRO_ASSERT_EQ_INT(r.rc[i], 0);
+    }
+
+    /* Defaults, and O_DIRECT where it is available */
+    ajson_sax_ingest_options_t direct = { 0, 0, 0, AJSON_SAX_INGEST_DIRECT };
+    run_ctx_t r;
+    memset(&r, 0, sizeof(r));
+    MACRO_ASSERT_EQ_INT(ajson_sax_ingest(list, 3, &sum_handlers, &file_handlers, &r,
+                                         pool, AJSON_SAX_DESTRUCTIVE, &direct), 0);
+    MACRO_ASSERT_TRUE(r.files[0].sum == 2000LL * 2001 / 2);
+    MACRO_ASSERT_EQ_SZ(r.files[2].string_bytes, 30000);
+
+    for (int i = 0; i < 3; i++) unlink(paths[i]);
+    rmdir(dir);
+    aml_pool_destroy(pool);
+    aml_buffer_destroy(bh);
+}
+
+MACRO_TEST(ingest_errors) {
+    char dir[] = "/tmp/ajson_ingest_XXXXXX";
+    MACRO_ASSERT_TRUE(mkdtemp(dir) != NULL);
+    char paths[5][64];
+    const char *list[5];
+    for (int i = 0; i < 5; i++) {
+        snprintf(paths[i], sizeof(paths[i]), "%s/%d.json", dir, i);
+        list[i] = paths[i];
+    }
+    write_file(paths[0], "[1, 2]", 6);
+    /* paths[1] does not exist */
+    write_file(paths[2], "[1, }", 5);
+    write_file(paths[3], "", 0);
+    write_file(paths[4], "3", 1);
+
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    for (unsigned backend = 0; backend < 2; backend++) {
+        ajson_sax_ingest_options_t o = { 2, 4096, 1, backend ? AJSON_SAX_INGEST_NO_URING : 0 };
+        run_ctx_t r;
+        memset(&r, 0, sizeof(r));
+        MACRO_ASSERT_EQ_INT(ajson_sax_ingest(list, 5, &sum_handlers, &file_handlers, &r,
+                                             pool, 0, &o), 0);
+        MACRO_ASSERT_EQ_SZ(r.ended, 5);
+        MACRO_ASSERT_EQ_INT(r.rc[0], 0);
+        MACRO_ASSERT_EQ_INT(r.rc[1], AJSON_SAX_INGEST_IO_ERROR);
+        MACRO_ASSERT_EQ_INT(r.err[1], ENOENT);
+        MACRO_ASSERT_EQ_INT(r.rc[2], -1);
+        MACRO_ASSERT_EQ_INT(r.rc[3], -1);
+        MACRO_ASSERT_EQ_INT(r.rc[4], 0);
+        MACRO_ASSERT_TRUE(r.files[4].sum == 3);
+
+        /* on_end_file stops the run */
+        memset(&r, 0, sizeof(r));
+        r.stop_after = 2;
+        MACRO_ASSERT_EQ_INT(ajson_sax_ingest(list, 5, &sum_handlers, &file_handlers, &r,
+                                             pool, 0, &o), 5);
+        MACRO_ASSERT_EQ_SZ(r.ended, 2);
+
+        /* Without file callbacks the first failure is returned */
+        MACRO_ASSERT_EQ_INT(ajson_sax_ingest(list + 2, 3, &no_handlers, NULL, NULL, pool, 0, &o), -1);
+    }
+
+    for (int i = 0; i < 5; i++) unlink(paths[i]);
+    rmdir(dir);
+    aml_pool_destroy(pool);
+}
+
+/* ---------- Register ---------- */
+
+int main(void) {
+    macro_test_case tests[8];
+    size_t test_count = 0;
+
+    MACRO_ADD(tests, ingest_files);
+    MACRO_ADD(tests, ingest_errors);
+
+    macro_run_all("ajson_sax_ingest", tests, test_count);
+    return 0;
+}
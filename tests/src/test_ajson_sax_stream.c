@@ -0,0 +1,651 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "a-json-sax-library/ajson_sax.h"
+#include "a-json-sax-library/ajson_sax_stream.h"
+#include "a-memory-library/aml_buffer.h"
+#include "a-memory-library/aml_pool.h"
+
+#include "the-macro-library/macro_test.h"
+
+/* Logs every event so a chunked parse can be compared to a one-shot one */
+typedef struct {
+    aml_buffer_t *log;
+} log_ctx_t;
+
+static int log_text(log_ctx_t *c, const char *tag, const char *v, size_t len) {
+    aml_buffer_appends(c->log, tag);
+    aml_buffer_append(c->log, v, len);
+    aml_buffer_appendc(c->log, ' ');
+    return 0;
+}
+
+static int log_null(void *ctx, ajson_sax_t *sax) {
+    (void)sax;
+    return log_text((log_ctx_t *)ctx, "null", "", 0);
+}
+static int log_bool(void *ctx, ajson_sax_t *sax, bool v) {
+    (void)sax;
+    return log_text((log_ctx_t *)ctx, v ? "true" : "false", "", 0);
+}
+static int log_number(void *ctx, ajson_sax_t *sax, const char *v, size_t len) {
+    (void)sax;
+    return log_text((log_ctx_t *)ctx, "#", v, len);
+}
+static int log_string(void *ctx, ajson_sax_t *sax, const char *v, size_t len) {
+    return log_text((log_ctx_t *)ctx, sax->has_escapes ? "e:" : "s:", v, len);
+}
+static int log_key(void *ctx, ajson_sax_t *sax, const char *v, size_t len) {
+    (void)sax;
+    return log_text((log_ctx_t *)ctx, "k:", v, len);
+}
+static int log_start_object(void *ctx, ajson_sax_t *sax) {
+    (void)sax;
+    return log_text((log_ctx_t *)ctx, "{", "", 0);
+}
+static int log_end_object(void *ctx, ajson_sax_t *sax) {
+    (void)sax;
+    return log_text((log_ctx_t *)ctx, "}", "", 0);
+}
+static int log_start_array(void *ctx, ajson_sax_t *sax) {
+    (void)sax;
+    return log_text((log_ctx_t *)ctx, "[", "", 0);
+}
+static int log_end_array(void *ctx, ajson_sax_t *sax) {
+    (void)sax;
+    return log_text((log_ctx_t *)ctx, "]", "", 0);
+}
+
+static const ajson_sax_cb_t log_handlers = {
+    .on_null = log_null, .on_bool = log_bool,
+    .on_number = log_number, .on_string = log_string, .on_key = log_key,
+    .on_start_object = log_start_object, .on_end_object = log_end_object,
+    .on_start_array = log_start_array, .on_end_array = log_end_array
+};
+
+/* Pushed handlers survive suspension: values under "inner" are tagged */
+static int inner_number(void *ctx, ajson_sax_t *sax, const char *v, size_t len) {
+    (void)sax;
+    return log_text((log_ctx_t *)ctx, "inner#", v, len);
+}
+static int inner_end(void *ctx, ajson_sax_t *sax) {
+    ajson_sax_try_pop(sax);
+    return log_end_object(ctx, sax);
+}
+static const ajson_sax_cb_t inner_handlers = {
+    .on_number = inner_number, .on_end_object = inner_end
+};
+static int push_start(void *ctx, ajson_sax_t *sax) {
+    if (sax->current_depth == 1) ajson_sax_push(sax, &inner_handlers);
+    return log_start_object(ctx, sax);
+}
+static const ajson_sax_cb_t push_handlers = {
+    .on_number = log_number, .on_key = log_key,
+    .on_start_object = push_start, .on_end_object = log_end_object
+};
+
+/* ---------- Helpers ---------- */
+
+/* One-shot result: event log, return code and error offset */
+static int parse_once(const char *json, const ajson_sax_cb_t *cb, unsigned flags,
+                      aml_pool_t *pool, aml_buffer_t *log, size_t *err_off) {
+    size_t len = strlen(json);
+    char *copy = (char *)malloc(len + 1);
+    memcpy(copy, json, len + 1);
+    log_ctx_t ctx = { log };
+    char *err = NULL;
+    aml_buffer_clear(log);
+    int rc = ajson_sax_parse_ex(copy, copy + len, cb, pool, &ctx, &err, flags);
+    *err_off = err ? (size_t)(err - copy) : 0;
+    free(copy);
+    return rc;
+}
+
+/* Feed 'json' in pieces of 'chunk' bytes, then finish */
+static int parse_chunked(const char *json, size_t chunk, const ajson_sax_cb_t *cb,
+                         unsigned flags, aml_pool_t *pool, aml_buffer_t *log,
+                         size_t *offset) {
+    size_t len = strlen(json);
+    log_ctx_t ctx = { log };
+    aml_buffer_clear(log);
+    ajson_sax_stream_t *s = ajson_sax_stream_init(cb, pool, &ctx, flags);
+    int rc = 0;
+    for (size_t i = 0; i < len && !rc && !ajson_sax_stream_done(s); i += chunk) {
+        size_t n = len - i < chunk ? len - i : chunk;
+        rc = ajson_sax_stream_feed(s, json + i, n);
+    }
+    if (!rc) rc = ajson_sax_stream_finish(s);
+    *offset = ajson_sax_stream_offset(s);
+    ajson_sax_stream_destroy(s);
+    return rc;
+}
+
+/* Every chunk size must give exactly the one-shot events and result */
+static void check_all_chunkings(const char *json, const ajson_sax_cb_t *cb, unsigned flags) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    aml_buffer_t *want = aml_buffer_init(256);
+    aml_buffer_t *got = aml_buffer_init(256);
+    size_t err_off, offset;
+
+    int want_rc = parse_once(json, cb, flags, pool, want, &err_off);
+    for (size_t chunk = 1; chunk <= strlen(json); chunk++) {
+        aml_pool_clear(pool);
+        int rc = parse_chunked(json, chunk, cb, flags, pool, got, &offset);
+        if (rc != want_rc || strcmp(aml_buffer_data(got), aml_buffer_data(want))) {
+            fprintf(stderr, "chunk %zu of '%s':\n  want %d '%s'\n  got  %d '%s'\n", chunk,
+                    json, want_rc, aml_buffer_data(want), rc, aml_buffer_data(got));
+        }
+        MACRO_ASSERT_EQ_INT(rc, want_rc);
+        MACRO_ASSERT_STREQ(aml_buffer_data(got), aml_buffer_data(want));
+        if (want_rc == -1) MACRO_ASSERT_EQ_SZ(offset, err_off);
+    }
+
+    aml_buffer_destroy(got);
+    aml_buffer_destroy(want);
+    aml_pool_destroy(pool);
+}
+
+/* ---------- Tests ---------- */
+
+MACRO_TEST(stream_matches_one_shot) {
+    static const char *docs[] = {
+        "{\"a\": [1, -2.5e+10, 0, -0, 0.125, 1E3], \"b\": {\"c\": true, \"d\": false},"
+        " \"e\": null, \"f\": \"plain\", \"g\": \"esc\\\"aped\\u00e9\"}",
+        "[\"x\", [[], {}], {\"k\": [null, true, false]}, -12, \"\"]",
+        "  \n\t{ \"spaced\" \t:\n  [ 1 ,\n 2 ] , \"z\" : { } }  ",
+        "{\"unicode\": \"\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80\", \"n\": 314159265358979}",
+        "\"root string\"",
+        "true",
+        "null",
+        "[1,2,3]",
+        "[1, 2]  \n",
+        "\"abc\" \t",
+        "12 ",
+    };
+    for (size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+        check_all_chunkings(docs[i], &log_handlers, 0);
+        check_all_chunkings(docs[i], &log_handlers, AJSON_SAX_DECODE_STRINGS);
+        check_all_chunkings(docs[i], &log_handlers,
+                            AJSON_SAX_DESTRUCTIVE | AJSON_SAX_DECODE_STRINGS |
+                            AJSON_SAX_VALIDATE_UTF8);
+    }
+}
+
+MACRO_TEST(stream_errors_match_one_shot) {
+    static const char *bad[] = {
+        "{\"a\": [1, 2,]}",
+        "{\"a\" 1}",
+        "[tru]",
+        "{\"a\": 01}",
+        "[1 2]",
+        "{\"a\": \"x\xC3\x28\"}",
+        "[[]",
+        "{\"a\": 1",
+        "[1, {}",
+        "\"abc",
+        "1zz",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        check_all_chunkings(bad[i], &log_handlers, 0);
+        check_all_chunkings(bad[i], &log_handlers, AJSON_SAX_VALIDATE_UTF8);
+    }
+}
+
+/* A stream ends the document at its last byte and leaves what follows to
+   the caller; a one-shot parse rejects the same bytes right there. */
+MACRO_TEST(stream_trailing_bytes) {
+    static const char *docs[] = {
+        "{}garbage",
+        "\"abc\"zz",
+        "[1]]",
+        "truex",
+        "{\"a\": [1]}{}",
+    };
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    aml_buffer_t *want = aml_buffer_init(64);
+    aml_buffer_t *got = aml_buffer_init(64);
+    size_t err_off, offset;
+
+    for (size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+        MACRO_ASSERT_EQ_INT(parse_once(docs[i], &log_handlers, 0, pool, want, &err_off), -1);
+        for (size_t chunk = 1; chunk <= strlen(docs[i]); chunk++) {
+            aml_pool_clear(pool);
+            MACRO_ASSERT_EQ_INT(parse_chunked(docs[i], chunk, &log_handlers, 0, pool, got,
+                                              &offset), 0);
+            MACRO_ASSERT_STREQ(aml_buffer_data(got), aml_buffer_data(want));
+            MACRO_ASSERT_EQ_SZ(offset, err_off);
+        }
+    }
+
+    aml_buffer_destroy(got);
+    aml_buffer_destroy(want);
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(stream_pushed_handlers) {
+    check_all_chunkings("{\"a\": 1, \"inner\": {\"x\": 2, \"y\": {\"z\": 3}}, \"b\": 4}",
+                        &push_handlers, 0);
+}
+
+MACRO_TEST(stream_end_of_input) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    aml_buffer_t *log = aml_buffer_init(64);
+    log_ctx_t ctx = { log };
+
+    /* A root number is only complete at the end of input */
+    ajson_sax_stream_t *s = ajson_sax_stream_init(&log_handlers, pool, &ctx, 0);
+    MACRO_ASSERT_EQ_INT(ajson_sax_stream_feed(s, "12", 2), 0);
+    MACRO_ASSERT_EQ_INT(ajson_sax_stream_feed(s, "34", 2), 0);
+    MACRO_ASSERT_FALSE(ajson_sax_stream_done(s));
+    MACRO_ASSERT_EQ_INT(ajson_sax_stream_finish(s), 0);
+    MACRO_ASSERT_TRUE(ajson_sax_stream_done(s));
+    MACRO_ASSERT_STREQ(aml_buffer_data(log), "#1234 ");
+
+    /* Unfinished documents fail at the end */
+    ajson_sax_stream_reset(s);
+    aml_buffer_clear(log);
+    MACRO_ASSERT_EQ_INT(ajson_sax_stream_feed(s, "[1, {\"a\"", 8), 0);
+    MACRO_ASSERT_EQ_SZ(ajson_sax_stream_offset(s), 8);
+    MACRO_ASSERT_EQ_INT(ajson_sax_stream_finish(s), -1);
+    MACRO_ASSERT_STREQ(aml_buffer_data(log), "[ #1 { k:a ");
+
+    /* Nothing at all is an error too */
+    ajson_sax_stream_reset(s);
+    MACRO_ASSERT_EQ_INT(ajson_sax_stream_finish(s), -1);
+
+    ajson_sax_stream_destroy(s);
+    aml_buffer_destroy(log);
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(stream_back_to_back_documents) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    aml_buffer_t *log = aml_buffer_init(64);
+    log_ctx_t ctx = { log };
+    const char *input = "{\"a\": 1}{\"b\": [2]}";
+
+    ajson_sax_stream_t *s = ajson_sax_stream_init(&log_handlers, pool, &ctx, 0);
+    MACRO_ASSERT_EQ_INT(ajson_sax_stream_feed(s, input, 4), 0);
+    MACRO_ASSERT_EQ_INT(ajson_sax_stream_feed(s, input + 4, strlen(input) - 4), 0);
+    MACRO_ASSERT_TRUE(ajson_sax_stream_done(s));
+    size_t end = ajson_sax_stream_offset(s);
+    MACRO_ASSERT_EQ_SZ(end, 8);
+
+    /* The caller restarts with whatever followed the first document */
+    ajson_sax_stream_reset(s);
+    MACRO_ASSERT_EQ_INT(ajson_sax_stream_feed(s, input + end, strlen(input) - end), 0);
+    MACRO_ASSERT_TRUE(ajson_sax_stream_done(s));
+    MACRO_ASSERT_STREQ(aml_buffer_data(log), "{ k:a #1 } { k:b [ #2 ] } ");
+
+    ajson_sax_stream_destroy(s);
+    aml_buffer_destroy(log);
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(stream_large_string_across_pieces) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    aml_buffer_t *log = aml_buffer_init(1 << 16);
+    aml_buffer_t *doc = aml_buffer_init(1 << 16);
+    log_ctx_t ctx = { log };
+
+    aml_buffer_appends(doc, "[\"");
+    for (int i = 0; i < 50000; i++) aml_buffer_appendc(doc, (char)('a' + i % 26));
+    aml_buffer_appends(doc, "\", 7]");
+
+    ajson_sax_stream_t *s = ajson_sax_stream_init(&log_handlers, pool, &ctx, 0);
+    const char *d = aml_buffer_data(doc);
+    size_t len = aml_buffer_length(doc);
+    for (size_t i = 0; i < len; i += 1000)
+        MACRO_ASSERT_EQ_INT(ajson_sax_stream_feed(s, d + i, len - i < 1000 ? len - i : 1000), 0);
+    MACRO_ASSERT_TRUE(ajson_sax_stream_done(s));
+    MACRO_ASSERT_EQ_SZ(ajson_sax_stream_offset(s), len);
+    MACRO_ASSERT_EQ_SZ(aml_buffer_length(log), 50000 + strlen("[ s: #7 ] "));
+
+    ajson_sax_stream_destroy(s);
+    aml_buffer_destroy(doc);
+    aml_buffer_destroy(log);
+    aml_pool_destroy(pool);
+}
+
+/* A long key, string and number, with escapes and UTF-8 cut at piece
+   boundaries, fed in small pieces.  Scanning resumes where it stopped, so
+   this takes linear time; rescanning each token from its start on every
+   piece would take minutes. */
+static void make_long_tokens(aml_buffer_t *doc, size_t n) {
+    aml_buffer_appends(doc, "{\"");
+    for (size_t i = 0; i < n / 64; i++) aml_buffer_appendc(doc, (char)('a' + i % 26));
+    aml_buffer_appends(doc, "\": [\"");
+    for (size_t i = 0; i < n; i += 16) aml_buffer_appends(doc, "text \\\"q\\\" \xC3\xA9\xE2\x82\xAC");
+    aml_buffer_appends(doc, "\", ");
+    for (size_t i = 0; i < n / 64; i++) aml_buffer_appendc(doc, (char)('1' + i % 9));
+    aml_buffer_appends(doc, ".5e3]}");
+}
+
+MACRO_TEST(stream_long_tokens_in_small_pieces) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    aml_buffer_t *doc = aml_buffer_init(1 << 16);
+    aml_buffer_t *want = aml_buffer_init(1 << 16);
+    aml_buffer_t *got = aml_buffer_init(1 << 16);
+    size_t err_off, offset;
+    make_long_tokens(doc, 4 << 20);
+
+    unsigned variants[] = { 0, AJSON_SAX_VALIDATE_UTF8,
+                            AJSON_SAX_DESTRUCTIVE | AJSON_SAX_DECODE_STRINGS |
+                            AJSON_SAX_VALIDATE_UTF8 };
+    for (size_t v = 0; v < 3; v++) {
+        MACRO_ASSERT_EQ_INT(parse_once(aml_buffer_data(doc), &log_handlers, variants[v],
+                                       pool, want, &err_off), 0);
+        clock_t t0 = clock();
+        MACRO_ASSERT_EQ_INT(parse_chunked(aml_buffer_data(doc), 253, &log_handlers,
+                                          variants[v], pool, got, &offset), 0);
+        double secs = (double)(clock() - t0) / CLOCKS_PER_SEC;
+        MACRO_ASSERT_TRUE(secs < 5.0);
+        MACRO_ASSERT_EQ_SZ(offset, aml_buffer_length(doc));
+        MACRO_ASSERT_EQ_SZ(aml_buffer_length(got), aml_buffer_length(want));
+        MACRO_ASSERT_TRUE(!memcmp(aml_buffer_data(got), aml_buffer_data(want),
+                                  aml_buffer_length(want)));
+        aml_pool_clear(pool);
+    }
+
+    aml_buffer_destroy(got);
+    aml_buffer_destroy(want);
+    aml_buffer_destroy(doc);
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(stream_reserve_commit) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    aml_buffer_t *log = aml_buffer_init(64);
+    log_ctx_t ctx = { log };
+    const char *pieces[] = { "{\"a\": [12", "34, \"x", "y\"]}", " ignored" };
+
+    ajson_sax_stream_t *s = ajson_sax_stream_init(&log_handlers, pool, &ctx, 0);
+    for (size_t i = 0; i < 4; i++) {
+        /* Offer more room than is used */
+        char *room = ajson_sax_stream_reserve(s, 64);
+        size_t len = strlen(pieces[i]);
+        memcpy(room, pieces[i], len);
+        MACRO_ASSERT_EQ_INT(ajson_sax_stream_commit(s, len), 0);
+    }
+    MACRO_ASSERT_TRUE(ajson_sax_stream_done(s));
+    MACRO_ASSERT_EQ_SZ(ajson_sax_stream_offset(s), 19);
+    MACRO_ASSERT_EQ_INT(ajson_sax_stream_finish(s), 0);
+    MACRO_ASSERT_STREQ(aml_buffer_data(log), "{ k:a [ #1234 s:xy ] } ");
+
+    ajson_sax_stream_destroy(s);
+    aml_buffer_destroy(log);
+    aml_pool_destroy(pool);
+}
+
+/* ---------- ajson_sax_parse_fd ---------- */
+
+/* A document of about 44 KB (less than a pipe holds) that wraps around a
+   4 KiB ring many times */
+static void make_fd_doc(aml_buffer_t *doc) {
+    aml_buffer_appends(doc, "{\"items\": [");
+    for (int i = 0; i < 800; i++)
+        aml_buffer_appendf(doc, "%s{\"id\": %d, \"name\": \"item \\u00e9 %d\", \"ok\": %s}",
+                           i ? ", " : "", i, i, i % 3 ? "true" : "null");
+    aml_buffer_appends(doc, "], \"long\": \"");
+    for (int i = 0; i < 3000; i++) aml_buffer_appendc(doc, (char)('a' + i % 26));
+    aml_buffer_appends(doc, "\"}");
+}
+
+MACRO_TEST(stream_parse_fd) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    aml_buffer_t *doc = aml_buffer_init(1 << 16);
+    aml_buffer_t *want = aml_buffer_init(1 << 16);
+    aml_buffer_t *got = aml_buffer_init(1 << 16);
+    log_ctx_t ctx = { got };
+    size_t err_off;
+    make_fd_doc(doc);
+
+    unsigned variants[] = { 0, AJSON_SAX_DECODE_STRINGS,
+                            AJSON_SAX_DESTRUCTIVE | AJSON_SAX_DECODE_STRINGS |
+                            AJSON_SAX_VALIDATE_UTF8 };
+    for (size_t v = 0; v < 3; v++) {
+        MACRO_ASSERT_EQ_INT(parse_once(aml_buffer_data(doc), &log_handlers, variants[v],
+                                       pool, want, &err_off), 0);
+
+        /* The whole document fits in the pipe, so no writer thread is needed */
+        int fds[2];
+        MACRO_ASSERT_EQ_INT(pipe(fds), 0);
+        MACRO_ASSERT_TRUE(write(fds[1], aml_buffer_data(doc), aml_buffer_length(doc)) ==
+                          (ssize_t)aml_buffer_length(doc));
+        close(fds[1]);
+        aml_buffer_clear(got);
+        MACRO_ASSERT_EQ_INT(ajson_sax_parse_fd(fds[0], 4096, &log_handlers, pool, &ctx,
+                                               variants[v]), 0);
+        close(fds[0]);
+        MACRO_ASSERT_STREQ(aml_buffer_data(got), aml_buffer_data(want));
+    }
+
+    /* A token longer than the ring */
+    int fds[2];
+    MACRO_ASSERT_EQ_INT(pipe(fds), 0);
+    aml_buffer_clear(doc);
+    aml_buffer_appends(doc, "[\"");
+    aml_buffer_appendn(doc, 'x', 5000);
+    aml_buffer_appends(doc, "\"]");
+    MACRO_ASSERT_TRUE(write(fds[1], aml_buffer_data(doc), aml_buffer_length(doc)) ==
+                      (ssize_t)aml_buffer_length(doc));
+    close(fds[1]);
+    MACRO_ASSERT_EQ_INT(ajson_sax_parse_fd(fds[0], 4096, &log_handlers, pool, &ctx, 0),
+                        AJSON_SAX_FD_TOO_LONG);
+    close(fds[0]);
+
+    aml_buffer_destroy(got);
+    aml_buffer_destroy(want);
+    aml_buffer_destroy(doc);
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(stream_fd_reader_nonblocking) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    aml_buffer_t *log = aml_buffer_init(64);
+    log_ctx_t ctx = { log };
+    int fds[2];
+    MACRO_ASSERT_EQ_INT(pipe(fds), 0);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+
+    ajson_sax_fd_reader_t *r = ajson_sax_fd_reader_init(fds[0], 0, &log_handlers,
+                                                        pool, &ctx, 0);
+    MACRO_ASSERT_EQ_INT(ajson_sax_fd_reader_pump(r), AJSON_SAX_FD_AGAIN);
+    MACRO_ASSERT_TRUE(write(fds[1], "[1, \"a", 6) == 6);
+    MACRO_ASSERT_EQ_INT(ajson_sax_fd_reader_pump(r), AJSON_SAX_FD_AGAIN);
+    MACRO_ASSERT_STREQ(aml_buffer_data(log), "[ #1 ");
+    MACRO_ASSERT_TRUE(write(fds[1], "b\"] 12", 6) == 6);
+    MACRO_ASSERT_EQ_INT(ajson_sax_fd_reader_pump(r), 0);
+    MACRO_ASSERT_STREQ(aml_buffer_data(log), "[ #1 s:ab ] ");
+    ajson_sax_fd_reader_destroy(r);
+
+    /* A root number ends at end of file */
+    aml_buffer_clear(log);
+    r = ajson_sax_fd_reader_init(fds[0], 0, &log_handlers, pool, &ctx, 0);
+    MACRO_ASSERT_EQ_INT(ajson_sax_fd_reader_pump(r), AJSON_SAX_FD_AGAIN);
+    MACRO_ASSERT_TRUE(write(fds[1], "34", 2) == 2);
+    MACRO_ASSERT_EQ_INT(ajson_sax_fd_reader_pump(r), AJSON_SAX_FD_AGAIN);
+    close(fds[1]);
+    MACRO_ASSERT_EQ_INT(ajson_sax_fd_reader_pump(r), 0);
+    MACRO_ASSERT_STREQ(aml_buffer_data(log), "#34 ");
+    ajson_sax_fd_reader_destroy(r);
+
+    close(fds[0]);
+    aml_buffer_destroy(log);
+    aml_pool_destroy(pool);
+}
+
+/* Long tokens arriving a few hundred bytes per read, in a ring barely
+   larger than the document */
+MACRO_TEST(stream_fd_reader_small_reads) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    aml_buffer_t *doc = aml_buffer_init(1 << 16);
+    aml_buffer_t *want = aml_buffer_init(1 << 16);
+    aml_buffer_t *got = aml_buffer_init(1 << 16);
+    log_ctx_t ctx = { got };
+    size_t err_off;
+    make_long_tokens(doc, 1 << 20);
+    MACRO_ASSERT_EQ_INT(parse_once(aml_buffer_data(doc), &log_handlers, AJSON_SAX_VALIDATE_UTF8,
+                                   pool, want, &err_off), 0);
+
+    int fds[2];
+    MACRO_ASSERT_EQ_INT(pipe(fds), 0);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    ajson_sax_fd_reader_t *r = ajson_sax_fd_reader_init(fds[0], aml_buffer_length(doc) + 4096,
+                                                        &log_handlers, pool, &ctx,
+                                                        AJSON_SAX_VALIDATE_UTF8);
+    const char *d = aml_buffer_data(doc);
+    size_t len = aml_buffer_length(doc);
+    clock_t t0 = clock();
+    int rc = AJSON_SAX_FD_AGAIN;
+    for (size_t i = 0; i < len; i += 509) {
+        size_t n = len - i < 509 ? len - i : 509;
+        MACRO_ASSERT_TRUE(write(fds[1], d + i, n) == (ssize_t)n);
+        rc = ajson_sax_fd_reader_pump(r);
+        if (rc != AJSON_SAX_FD_AGAIN) break;
+    }
+    MACRO_ASSERT_EQ_INT(rc, 0);
+    MACRO_ASSERT_TRUE((double)(clock() - t0) / CLOCKS_PER_SEC < 5.0);
+    MACRO_ASSERT_EQ_SZ(aml_buffer_length(got), aml_buffer_length(want));
+    MACRO_ASSERT_TRUE(!memcmp(aml_buffer_data(got), aml_buffer_data(want),
+                              aml_buffer_length(want)));
+
+    ajson_sax_fd_reader_destroy(r);
+    close(fds[0]);
+    close(fds[1]);
+    aml_buffer_destroy(got);
+    aml_buffer_destroy(want);
+    aml_buffer_destroy(doc);
+    aml_pool_destroy(pool);
+}
+
+/* ---------- ajson_sax_parse_many ---------- */
+
+static int log_begin_document(void *ctx, size_t index, size_t offset) {
+    aml_buffer_appendf(((log_ctx_t *)ctx)->log, "<%zu@%zu ", index, offset);
+    return 0;
+}
+static int log_end_document(void *ctx, size_t index, size_t offset) {
+    aml_buffer_appendf(((log_ctx_t *)ctx)->log, "%zu@%zu> ", index, offset);
+    return index == 1 ? 7 : 0;
+}
+
+static const ajson_sax_doc_cb_t log_documents = { log_begin_document, NULL };
+static const ajson_sax_doc_cb_t log_both = { log_begin_document, log_end_document };
+
+static int many_bytes(const char *json, size_t len, const ajson_sax_doc_cb_t *doc_cb,
+                      log_ctx_t *ctx, aml_pool_t *pool, size_t *end, unsigned flags) {
+    char *p = (char *)aml_pool_dup(pool, json, len + 1);
+    char *end_at = NULL;
+    aml_buffer_clear(ctx->log);
+    int rc = ajson_sax_parse_many(p, p + len, &log_handlers, doc_cb,
+                                  pool, ctx, &end_at, flags);
+    *end = (size_t)(end_at - p);
+    return rc;
+}
+
+static int many_text(const char *json, const ajson_sax_doc_cb_t *doc_cb,
+                     log_ctx_t *ctx, aml_pool_t *pool, size_t *end, unsigned flags) {
+    return many_bytes(json, strlen(json), doc_cb, ctx, pool, end, flags);
+}
+
+MACRO_TEST(stream_parse_many) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    aml_buffer_t *log = aml_buffer_init(64);
+    log_ctx_t ctx = { log };
+    const char *input = "{\"a\": 1}\n[2, \"x\"] 3\n-4.5e1\t\"s\\n\"true null{}[] \n";
+    size_t end;
+
+    for (unsigned flags = 0; flags < 8; flags++) {
+        MACRO_ASSERT_EQ_INT(many_text(input, &log_documents, &ctx, pool, &end, flags), 0);
+        MACRO_ASSERT_EQ_SZ(end, strlen(input));
+        MACRO_ASSERT_STREQ(aml_buffer_data(log),
+            (flags & AJSON_SAX_DECODE_STRINGS)
+            ? "<0@0 { k:a #1 } <1@9 [ #2 s:x ] <2@18 #3 <3@20 #-4.5e1 <4@27 e:s\n "
+              "<5@32 true <6@37 null <7@41 { } <8@43 [ ] "
+            : "<0@0 { k:a #1 } <1@9 [ #2 s:x ] <2@18 #3 <3@20 #-4.5e1 <4@27 e:s\\n "
+              "<5@32 true <6@37 null <7@41 { } <8@43 [ ] ");
+    }
+
+    /* Empty or blank input is zero documents */
+    MACRO_ASSERT_EQ_INT(many_text(" \n", &log_documents, &ctx, pool, &end, 0), 0);
+    MACRO_ASSERT_EQ_SZ(end, 2);
+    MACRO_ASSERT_EQ_SZ(aml_buffer_length(log), 0);
+
+    aml_buffer_destroy(log);
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(stream_parse_many_errors) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    aml_buffer_t *log = aml_buffer_init(64);
+    log_ctx_t ctx = { log };
+    size_t end;
+
+    for (unsigned flags = 0; flags < 2; flags++) {
+        /* A number must be followed by whitespace */
+        MACRO_ASSERT_EQ_INT(many_text("1 2,3", NULL, &ctx, pool, &end, flags), -1);
+        MACRO_ASSERT_EQ_SZ(end, 3);
+        MACRO_ASSERT_EQ_INT(many_text("[1] 2true", NULL, &ctx, pool, &end, flags), -1);
+        MACRO_ASSERT_EQ_SZ(end, 5);
+
+        /* A stray closing bracket is not a document */
+        MACRO_ASSERT_EQ_INT(many_text("[1] ]", NULL, &ctx, pool, &end, flags), -1);
+        MACRO_ASSERT_EQ_SZ(end, 5);
+
+        /* A NUL between documents is not whitespace, even where a
+           destructive parse wrote one after a number */
+        MACRO_ASSERT_EQ_INT(many_bytes("{\"a\":1}\0{\"b\":2}", 15, NULL, &ctx, pool, &end, flags), -1);
+        MACRO_ASSERT_EQ_SZ(end, 8);
+        MACRO_ASSERT_EQ_INT(many_bytes("1 \0 2", 5, NULL, &ctx, pool, &end, flags), -1);
+        MACRO_ASSERT_EQ_SZ(end, 3);
+        MACRO_ASSERT_EQ_INT(many_bytes("\"a\"\0[]", 6, NULL, &ctx, pool, &end, flags), -1);
+        MACRO_ASSERT_EQ_SZ(end, 4);
+        MACRO_ASSERT_EQ_INT(many_bytes("1\n-2 3", 6, NULL, &ctx, pool, &end, flags), 0);
+        MACRO_ASSERT_STREQ(aml_buffer_data(log), "#1 #-2 #3 ");
+
+        /* Truncated last document */
+        MACRO_ASSERT_EQ_INT(many_text("{} {\"a\"", NULL, &ctx, pool, &end, flags), -1);
+        MACRO_ASSERT_STREQ(aml_buffer_data(log), "{ } { k:a ");
+    }
+
+    /* A document callback stops the parse after that document */
+    MACRO_ASSERT_EQ_INT(many_text("[1] [2] [3]", &log_both, &ctx, pool, &end, 0), 7);
+    MACRO_ASSERT_EQ_SZ(end, 7);
+    MACRO_ASSERT_STREQ(aml_buffer_data(log), "<0@0 [ #1 ] 0@3> <1@4 [ #2 ] 1@7> ");
+
+    aml_buffer_destroy(log);
+    aml_pool_destroy(pool);
+}
+
+/* ---------- Register ---------- */
+
+int main(void) {
+    macro_test_case tests[16];
+    size_t test_count = 0;
+
+    MACRO_ADD(tests, stream_matches_one_shot);
+    MACRO_ADD(tests, stream_errors_match_one_shot);
+    MACRO_ADD(tests, stream_trailing_bytes);
+    MACRO_ADD(tests, stream_pushed_handlers);
+    MACRO_ADD(tests, stream_end_of_input);
+    MACRO_ADD(tests, stream_back_to_back_documents);
+    MACRO_ADD(tests, stream_large_string_across_pieces);
+    MACRO_ADD(tests, stream_long_tokens_in_small_pieces);
+    MACRO_ADD(tests, stream_reserve_commit);
+    MACRO_ADD(tests, stream_parse_fd);
+    MACRO_ADD(tests, stream_fd_reader_nonblocking);
+    MACRO_ADD(tests, stream_fd_reader_small_reads);
+    MACRO_ADD(tests, stream_parse_many);
+    MACRO_ADD(tests, stream_parse_many_errors);
+
+    macro_run_all("ajson_sax_stream", tests, test_count);
+    return 0;
+}
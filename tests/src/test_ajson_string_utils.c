@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
 // SPDX-License-Identifier: Apache-2.0
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -118,6 +120,111 @@ MACRO_TEST(decode_invalid_unicode_escape_copied) {
     aml_pool_destroy(pool);
 }
 
+MACRO_TEST(decode_inplace_matches_pool_decode) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    const char *cases[] = {
+        "no escapes at all",
+        "a\\nb",
+        "\\\"quoted\\\" and \\\\ slash \\/ done",
+        "long clean prefix that spans several scan blocks \\t then more clean text",
+        "\\u00e9t\\u00E9 \\uD834\\uDD1E \\u12G4 \\uD800x",
+        "trailing \\u12",
+        "\\n\\t\\r\\b\\f",
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        char *src = strdup(cases[i]);
+        size_t len = strlen(src);
+
+        /* Copy the expectation since ajson_decode2 may alias 'src' */
+        size_t expect_len = 0;
+        char *dec = ajson_decode2(&expect_len, pool, src, len);
+        char *expect = (char *)malloc(expect_len + 1);
+        memcpy(expect, dec, expect_len);
+
+        size_t n = ajson_decode_inplace(src, len);
+        MACRO_ASSERT_EQ_SZ(n, expect_len);
+        MACRO_ASSERT_TRUE(memcmp(src, expect, n) == 0);
+        if (n < len) MACRO_ASSERT_EQ_INT(src[n], 0);
+
+        free(expect);
+        free(src);
+    }
+
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(decode_inplace_utf8) {
+    char buf[] = "caf\\u00E9 \\uD834\\uDD1E!";
+    size_t n = ajson_decode_inplace(buf, strlen(buf));
+
+    MACRO_ASSERT_EQ_SZ(n, 11);
+    MACRO_ASSERT_STREQ(buf, "caf\xC3\xA9 \xF0\x9D\x84\x9E!");
+}
+
+/* Byte-at-a-time reference for the escaping rules */
+static size_t reference_encode(char *out, const char *s, size_t len) {
+    char *wp = out;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        switch (c) {
+        case '\"': *wp++ = '\\'; *wp++ = '\"'; break;
+        case '\\': *wp++ = '\\'; *wp++ = '\\'; break;
+        case '/':  *wp++ = '\\'; *wp++ = '/'; break;
+        case '\b': *wp++ = '\\'; *wp++ = 'b'; break;
+        case '\f': *wp++ = '\\'; *wp++ = 'f'; break;
+        case '\n': *wp++ = '\\'; *wp++ = 'n'; break;
+        case '\r': *wp++ = '\\'; *wp++ = 'r'; break;
+        case '\t': *wp++ = '\\'; *wp++ = 't'; break;
+        default:
+            if (c < 0x20) wp += sprintf(wp, "\\u%04X", c);
+            else *wp++ = (char)c;
+        }
+    }
+    return wp - out;
+}
+
+MACRO_TEST(encode_matches_reference_across_blocks) {
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    char src[300];
+    char expect[300 * 6];
+
+    /* Escapes land at every offset relative to the 16/8-byte scan blocks */
+    for (size_t gap = 1; gap < 40; gap++) {
+        for (size_t i = 0; i < sizeof(src); i++) {
+            unsigned char c = (unsigned char)(0x20 + (i * 7) % 0x60);
+            if (c == '\"' || c == '\\' || c == '/') c = 'x';
+            if (i % gap == gap - 1) c = (unsigned char)("\n\"\\/\x01\x1F"[i % 6]);
+            src[i] = (char)c;
+        }
+        size_t n = reference_encode(expect, src, sizeof(src));
+
+        char *enc = ajson_encode(pool, src, sizeof(src));
+        MACRO_ASSERT_EQ_SZ(strlen(enc), n);
+        MACRO_ASSERT_TRUE(memcmp(enc, expect, n) == 0);
+    }
+
+    aml_pool_destroy(pool);
+}
+
+MACRO_TEST(encode_buffer_append) {
+    aml_buffer_t *bh = aml_buffer_init(16);
+    aml_buffer_appends(bh, "[");
+
+    char clean[] = "plain text that needs no escaping at all";
+    ajson_buffer_append_encoded(bh, clean, strlen(clean));
+    aml_buffer_appendc(bh, ',');
+
+    char raw[] = { 'a', '\n', 'b', 0x02, '"' };
+    ajson_buffer_append_encoded(bh, raw, sizeof(raw));
+    aml_buffer_appendc(bh, ']');
+
+    MACRO_ASSERT_STREQ(aml_buffer_data(bh),
+                       "[plain text that needs no escaping at all,a\\nb\\u0002\\\"]");
+
+    aml_buffer_destroy(bh);
+}
+
 /* ---------- UTF-8 Filtering / Stripping ---------- */
 
 MACRO_TEST(utf8_strip_invalid_inplace) {
@@ -144,6 +251,163 @@ MACRO_TEST(utf8_buffer_append_valid) {
     aml_buffer_destroy(bh);
 }
 
+/* Read back everything written to 'f' */
+static char *slurp(FILE *f, size_t *len) {
+    fflush(f);
+    long n = ftell(f);
+    char *r = (char *)malloc(n + 1);
+    rewind(f);
+    *len = fread(r, 1, n, f);
+    return r;
+}
+
+MACRO_TEST(utf8_file_and_fd_write_valid) {
+    /* Large enough to cross the fd staging block several times */
+    size_t len = 3 * 1024 * 1024 + 123;
+    char *src = (char *)malloc(len);
+    for (size_t i = 0; i < len; i++) src[i] = (char)('a' + i % 26);
+    for (size_t i = 1000; i + 2 < len; i += 70001) {
+        src[i] = '\xC3'; src[i + 1] = '\xA9';         /* valid */
+        if (i % 3 == 0) src[i + 1] = '(';             /* invalid lead byte */
+    }
+    src[len - 1] = '\xE2';                            /* truncated at the end */
+
+    char *expect = (char *)malloc(len);
+    size_t expect_len = ajson_copy_valid_utf8(expect, src, len) - expect;
+    MACRO_ASSERT_TRUE(expect_len < len);
+
+    FILE *f = tmpfile();
+    ajson_file_write_valid_utf8(f, src, len);
+    size_t got_len;
+    char *got = slurp(f, &got_len);
+    MACRO_ASSERT_EQ_SZ(got_len, expect_len);
+    MACRO_ASSERT_TRUE(memcmp(got, expect, expect_len) == 0);
+    free(got);
+    fclose(f);
+
+    /* fd variant: repaired input, then already-valid input (direct path) */
+    f = tmpfile();
+    MACRO_ASSERT_EQ_INT(ajson_fd_write_valid_utf8(fileno(f), src, len), 0);
+    MACRO_ASSERT_EQ_INT(ajson_fd_write_valid_utf8(fileno(f), "ok\xC3\xA9", 4), 0);
+    fseek(f, 0, SEEK_END);
+    got = slurp(f, &got_len);
+    MACRO_ASSERT_EQ_SZ(got_len, expect_len + 4);
+    MACRO_ASSERT_TRUE(memcmp(got, expect, expect_len) == 0);
+    MACRO_ASSERT_TRUE(memcmp(got + expect_len, "ok\xC3\xA9", 4) == 0);
+    free(got);
+    fclose(f);
+
+    MACRO_ASSERT_EQ_INT(ajson_fd_write_valid_utf8(-1, "x\xFF", 2), -1);
+
+    free(expect);
+    free(src);
+}
+
+/* Strict reference decoder: length of the valid sequence at s, or 0 */
+static size_t reference_utf8_seq(const unsigned char *s, size_t avail) {
+    unsigned c = s[0], cp, n;
+    if (c < 0x80) return 1;
+    else if (c >= 0xC2 && c <= 0xDF) { n = 2; cp = c & 0x1F; }
+    else if (c >= 0xE0 && c <= 0xEF) { n = 3; cp = c & 0x0F; }
+    else if (c >= 0xF0 && c <= 0xF4) { n = 4; cp = c & 0x07; }
+    else return 0;
+    if (avail < n) return 0;
+    for (unsigned i = 1; i < n; i++) {
+        if ((s[i] & 0xC0) != 0x80) return 0;
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    if ((n == 3 && cp < 0x800) || (n == 4 && cp < 0x10000)) return 0; /* overlong */
+    if (cp >= 0xD800 && cp <= 0xDFFF) return 0;                      /* surrogate */
+    if (cp > 0x10FFFF) return 0;
+    return n;
+}
+
+static size_t reference_valid_prefix(const unsigned char *s, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        size_t n = reference_utf8_seq(s + i, len - i);
+        if (!n) return i;
+        i += n;
+    }
+    return len;
+}
+
+MACRO_TEST(utf8_strict_rejections) {
+    const char *bad[] = {
+        "\xC0\x80",             /* overlong NUL */
+        "\xC1\xBF",             /* overlong 2-byte */
+        "\xE0\x80\x80",         /* overlong 3-byte */
+        "\xED\xA0\x80",         /* surrogate U+D800 */
+        "\xF0\x80\x80\x80",     /* overlong 4-byte */
+        "\xF4\x90\x80\x80",     /* U+110000 */
+        "\xF5\x80\x80\x80",     /* invalid lead */
+        "\x80",                 /* stray continuation */
+        "\xE2\x82",             /* truncated */
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        MACRO_ASSERT_FALSE(ajson_utf8_is_valid(bad[i], strlen(bad[i])));
+        MACRO_ASSERT_EQ_SZ(ajson_utf8_valid_prefix(bad[i], strlen(bad[i])), 0);
+    }
+
+    const char *good = "a\xC2\xA9\xE2\x82\xAC\xED\x9F\xBF\xEE\x80\x80\xF0\x9F\x98\x80\xF4\x8F\xBF\xBF";
+    MACRO_ASSERT_TRUE(ajson_utf8_is_valid(good, strlen(good)));
+}
+
+MACRO_TEST(utf8_vector_matches_reference) {
+    /* Mostly-valid text with occasional corruption, long enough to cross
+       many 16-byte blocks at every alignment */
+    static const char *pieces[] = {
+        "plain ascii ", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xED\x9F\xBF",
+        "\xC0\x80", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\x80", "\xE2\x82", "\xFF"
+    };
+    unsigned char buf[512];
+    unsigned char out[512];
+    unsigned seed = 12345;
+    aml_buffer_t *bh = aml_buffer_init(16);
+
+    for (int iter = 0; iter < 3000; iter++) {
+        size_t len = 0;
+        while (len < sizeof(buf) - 8) {
+            seed = seed * 1103515245u + 12345u;
+            unsigned r = (seed >> 16) % 100;
+            size_t k = r < 80 ? (r % 5) : 5 + (r % 6);
+            if (iter % 3 == 0 && k >= 5) k = r % 5; /* some fully valid inputs */
+            size_t pl = strlen(pieces[k]);
+            memcpy(buf + len, pieces[k], pl);
+            len += pl;
+            if ((seed >> 8) % 7 == 0) break;
+        }
+
+        MACRO_ASSERT_EQ_SZ(ajson_utf8_valid_prefix((const char *)buf, len),
+                           reference_valid_prefix(buf, len));
+
+        /* Repair: drop the first byte of every invalid sequence */
+        size_t expect = 0;
+        unsigned char expect_buf[512];
+        for (size_t i = 0; i < len;) {
+            size_t n = reference_utf8_seq(buf + i, len - i);
+            if (!n) { i++; continue; }
+            memcpy(expect_buf + expect, buf + i, n);
+            expect += n;
+            i += n;
+        }
+        char *end = ajson_copy_valid_utf8((char *)out, (const char *)buf, len);
+        MACRO_ASSERT_EQ_SZ((size_t)(end - (char *)out), expect);
+        MACRO_ASSERT_TRUE(memcmp(out, expect_buf, expect) == 0);
+
+        aml_buffer_clear(bh);
+        aml_buffer_appendc(bh, '>');
+        ajson_buffer_append_valid_utf8(bh, (const char *)buf, len);
+        MACRO_ASSERT_EQ_SZ(aml_buffer_length(bh), expect + 1);
+        MACRO_ASSERT_TRUE(memcmp(aml_buffer_data(bh) + 1, expect_buf, expect) == 0);
+
+        size_t n = ajson_strip_invalid_utf8_inplace((char *)buf, len);
+        MACRO_ASSERT_EQ_SZ(n, expect);
+        MACRO_ASSERT_TRUE(memcmp(buf, expect_buf, expect) == 0);
+    }
+    aml_buffer_destroy(bh);
+}
+
 /* -------- register & run -------- */
 
 int main(void) {
@@ -157,9 +421,16 @@ int main(void) {
     MACRO_ADD(tests, encode_embedded_nul_and_controls);
     MACRO_ADD(tests, decode_unicode_surrogate_pair_and_invalid);
     MACRO_ADD(tests, decode_invalid_unicode_escape_copied);
+    MACRO_ADD(tests, decode_inplace_matches_pool_decode);
+    MACRO_ADD(tests, decode_inplace_utf8);
+    MACRO_ADD(tests, encode_matches_reference_across_blocks);
+    MACRO_ADD(tests, encode_buffer_append);
 
     MACRO_ADD(tests, utf8_strip_invalid_inplace);
     MACRO_ADD(tests, utf8_buffer_append_valid);
+    MACRO_ADD(tests, utf8_file_and_fd_write_valid);
+    MACRO_ADD(tests, utf8_strict_rejections);
+    MACRO_ADD(tests, utf8_vector_matches_reference);
 
     macro_run_all("ajson_string_utils", tests, test_count);
     return 0;
@@ -0,0 +1,345 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "a-json-sax-library/ajson_sax.h"
+#include "a-json-sax-library/ajson_validate.h"
+#include "a-memory-library/aml_buffer.h"
+#include "a-memory-library/aml_pool.h"
+
+#include "the-macro-library/macro_test.h"
+
+static bool valid(const char *s) {
+    return ajson_validate(s, strlen(s), NULL);
+}
+
+/* Offset of the error in 's', or -1 if it is valid */
+static long error_offset(const char *s, size_t len) {
+    size_t off = 12345;
+    if (ajson_validate(s, len, &off)) return -1;
+    return (long)off;
+}
+
+#define ERR(s) error_offset((s), sizeof(s) - 1)
+
+MACRO_TEST(validate_documents) {
+    MACRO_ASSERT_TRUE(valid("{}"));
+    MACRO_ASSERT_TRUE(valid(" [ ] "));
+    MACRO_ASSERT_TRUE(valid("\n\t{\"a\": [1, -2.5e+3, 0, -0, 0.25E-2, true, false, null],\r\n"
+                            " \"b\": {\"c\": \"\\u00e9\\n\\\"\", \"\": {}}}\n"));
+    MACRO_ASSERT_TRUE(valid("\"caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80\""));
+    MACRO_ASSERT_TRUE(valid("123"));
+    MACRO_ASSERT_TRUE(valid("  null  "));
+    MACRO_ASSERT_TRUE(valid("\"\""));
+
+    /* The offset is the first byte that cannot belong to a document */
+    MACRO_ASSERT_EQ_INT(ERR(""), 0);
+    MACRO_ASSERT_EQ_INT(ERR("   "), 3);
+    MACRO_ASSERT_EQ_INT(ERR("[1, 2"), 5);
+    MACRO_ASSERT_EQ_INT(ERR("[1, 2,]"), 6);
+    MACRO_ASSERT_EQ_INT(ERR("[1 2]"), 3);
+    MACRO_ASSERT_EQ_INT(ERR("{\"a\" 1}"), 5);
+    MACRO_ASSERT_EQ_INT(ERR("{\"a\": 1,}"), 8);
+    MACRO_ASSERT_EQ_INT(ERR("{1: 2}"), 1);
+    MACRO_ASSERT_EQ_INT(ERR("[1}"), 2);
+    MACRO_ASSERT_EQ_INT(ERR("{\"a\": 1]"), 7);
+    MACRO_ASSERT_EQ_INT(ERR("[01]"), 2);
+    MACRO_ASSERT_EQ_INT(ERR("[1.]"), 3);
+    MACRO_ASSERT_EQ_INT(ERR("[1e+]"), 4);
+    MACRO_ASSERT_EQ_INT(ERR("[-]"), 2);
+    MACRO_ASSERT_EQ_INT(ERR("[+1]"), 1);
+    MACRO_ASSERT_EQ_INT(ERR("[tru]"), 4);
+    MACRO_ASSERT_EQ_INT(ERR("[nul"), 4);
+    MACRO_ASSERT_EQ_INT(ERR("fals"), 4);
+    MACRO_ASSERT_EQ_INT(ERR("{} {}"), 3);
+    MACRO_ASSERT_EQ_INT(ERR("1x"), 1);
+    MACRO_ASSERT_EQ_INT(ERR("\"abc"), 4);
+    MACRO_ASSERT_EQ_INT(ERR("\"a\\x\""), 3);
+    MACRO_ASSERT_EQ_INT(ERR("\"a\\u12G4\""), 6);
+    MACRO_ASSERT_EQ_INT(ERR("\"tab\there\""), 4);
+    MACRO_ASSERT_EQ_INT(ERR("\"ab\xC3\""), 3);              /* Truncated sequence */
+    MACRO_ASSERT_EQ_INT(ERR("\"ab\xC0\xAF\""), 3);          /* Overlong */
+    MACRO_ASSERT_EQ_INT(ERR("\"ab\xED\xA0\x80\""), 3);      /* Surrogate */
+    MACRO_ASSERT_EQ_INT(ERR("[\xC3\xA9]"), 1);              /* Outside a string */
+
+    /* A NUL is just another byte */
+    MACRO_ASSERT_EQ_INT(error_offset("[1]\0", 4), 3);
+    MACRO_ASSERT_EQ_INT(error_offset("\"a\0\"", 4), 2);
+
+    /* Errors well past the first vector block */
+    char big[256];
+    memset(big, ' ', sizeof(big));
+    big[0] = '\"';
+    memcpy(big + 1, "\xC3\xA9", 2);
+    for (int i = 3; i < 200; i++) big[i] = (char)('a' + i % 26);
+    big[150] = (char)0xFF;
+    big[200] = '\"';
+    MACRO_ASSERT_EQ_INT(error_offset(big, sizeof(big)), 150);
+    big[150] = 'x';
+    MACRO_ASSERT_EQ_INT(error_offset(big, sizeof(big)), -1);
+    big[240] = 'x';
+    MACRO_ASSERT_EQ_INT(error_offset(big, sizeof(big)), 240);
+}
+
+/* Non-ASCII text longer than the chunks UTF-8 is checked in */
+MACRO_TEST(validate_long_strings) {
+    aml_buffer_t *bh = aml_buffer_init(1 << 16);
+    aml_buffer_appends(bh, "{\"text\": \"");
+    for (int i = 0; i < 20000; i++)
+        aml_buffer_appends(bh, i % 7 ? "\xE6\x97\xA5" : "a\\n");
+    aml_buffer_appends(bh, "xy\"}");
+    char *s = aml_buffer_data(bh);
+    size_t len = aml_buffer_length(bh);
+    MACRO_ASSERT_TRUE(ajson_validate(s, len, NULL));
+
+    size_t bad = len - 100;
+    while ((unsigned char)s[bad] != 0xE6) bad--;
+    s[bad + 1] = 'x';
+    size_t off = 0;
+    MACRO_ASSERT_FALSE(ajson_validate(s, len, &off));
+    MACRO_ASSERT_EQ_SZ(off, bad);
+
+    s[bad + 1] = (char)0x97;
+    s[len - 3] = 0x7F;
+    MACRO_ASSERT_TRUE(ajson_validate(s, len, NULL));
+    s[len - 3] = 0x1F;
+    MACRO_ASSERT_FALSE(ajson_validate(s, len, &off));
+    MACRO_ASSERT_EQ_SZ(off, len - 3);
+    aml_buffer_destroy(bh);
+}
+
+/* ajson_sax_parse_ex with VALIDATE_UTF8 on a NUL-terminated copy */
+static bool parser_accepts(aml_buffer_t *bh, aml_pool_t *pool, const char *s, size_t len) {
+    static const ajson_sax_cb_t no_handlers = {0};
+    aml_buffer_set(bh, s, len);
+    char *err = NULL;
+    int rc = ajson_sax_parse_ex(aml_buffer_data(bh), aml_buffer_data(bh) + len,
+                                &no_handlers, pool, NULL, &err, AJSON_SAX_VALIDATE_UTF8);
+    aml_pool_clear(pool);
+    return rc == 0;
+}
+
+/* The document with each byte replaced by one of a set of troublemakers,
+   and each of its prefixes, is judged the same way by both. */
+MACRO_TEST(validate_matches_parser) {
+    static const char doc[] =
+        "{\"id\": 12345, \"name\": \"caf\xC3\xA9 \\u00e9\\\"x\\\\\", \"tags\": [\"a\", \"b\"],\n"
+        "  \"ratio\": -0.5e-3, \"ok\": true, \"none\": null, \"no\": false,\n"
+        "  \"nested\": [[1, 2], {\"k\": [0, {}]}, [], \"\xE2\x82\xAC\xF0\x9F\x98\x80\"]}";
+    static const char swaps[] = { 'x', '\"', '\\', ',', ':', '0', '-', '.', 'e', ' ',
+                                  '\x01', '\xC3', '\xFF', '{', '[', ']', '}', 'n', 'u' };
+    static const char *roots[] = { "{}garbage", "[[]", "\"abc\"zz", "1zz", "[1]]",
+                                   "{\"a\":1", "[1, 2]  ", "\"abc\"\t" };
+    size_t len = sizeof(doc) - 1;
+    aml_buffer_t *bh = aml_buffer_init(256);
+    aml_pool_t *pool = aml_pool_init(1 << 12);
+    char work[sizeof(doc)];
+
+    MACRO_ASSERT_TRUE(ajson_validate(doc, len, NULL));
+    MACRO_ASSERT_TRUE(parser_accepts(bh, pool, doc, len));
+
+    /* Every prefix runs out of input, even inside an escape or a UTF-8
+       sequence */
+    for (size_t n = 0; n < len; n++) {
+        size_t off = 0;
+        MACRO_ASSERT_FALSE(ajson_validate(doc, n, &off));
+        MACRO_ASSERT_EQ_SZ(off, n);
+        MACRO_ASSERT_FALSE(parser_accepts(bh, pool, doc, n));
+    }
+    /* Only whitespace may follow the root value, and it must be closed */
+    for (size_t i = 0; i < sizeof(roots) / sizeof(roots[0]); i++) {
+        size_t n = strlen(roots[i]);
+        bool v = ajson_validate(roots[i], n, NULL);
+        MACRO_ASSERT_TRUE(v == parser_accepts(bh, pool, roots[i], n));
+    }
+    for (size_t i = 0; i < len; i++) {
+        for (size_t k = 0; k < sizeof(swaps); k++) {
+            memcpy(work, doc, len);
+            work[i] = swaps[k];
+            bool v = ajson_validate(work, len, NULL);
+            if (v != parser_accepts(bh, pool, work, len)) {
+                fprintf(stderr, "byte %zu -> 0x%02x: validate %d\n", i,
+                        (unsigned char)swaps[k], v);
+                MACRO_ASSERT_TRUE(false);
+            }
+        }
+    }
+
+    aml_pool_destroy(pool);
+    aml_buffer_destroy(bh);
+}
+
+MACRO_TEST(validate_depth) {
+    static char deep[1024];
+    for (int i = 0; i < 512; i++) {
+        deep[i] = '[';
+        deep[1023 - i] = ']';
+    }
+    /* The parser's limit: 511 levels */
+    MACRO_ASSERT_EQ_INT(error_offset(deep + 1, 1022), -1);
+    MACRO_ASSERT_EQ_INT(error_offset(deep, 1024), 511);
+}
+
+/* The input ends right at a page that cannot be read, in a page that
+   cannot be written: any write or read past the end would fault. */
+MACRO_TEST(validate_read_only) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    char *map = (char *)mmap(NULL, 2 * page, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    MACRO_ASSERT_TRUE(map != MAP_FAILED);
+    static const char *docs[] = {
+        "[1, 2, 3]", "  {\"k\": \"value that is longer than sixteen\"}   ",
+        "12", "-", "tru", "\"unterminated \xC3\xA9 string", "\"a\\u00", "{\"a\":",
+    };
+    MACRO_ASSERT_EQ_INT(mprotect(map + page, page, PROT_NONE), 0);
+    for (size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+        size_t len = strlen(docs[i]);
+        MACRO_ASSERT_EQ_INT(mprotect(map, page, PROT_READ | PROT_WRITE), 0);
+        char *p = map + page - len;
+        memcpy(p, docs[i], len);
+        MACRO_ASSERT_EQ_INT(mprotect(map, page, PROT_READ), 0);
+        bool v = ajson_validate(p, len, NULL);
+        MACRO_ASSERT_TRUE(v == (i < 3));
+    }
+    munmap(map, 2 * page);
+}
+
+/* ---------- Minify ---------- */
+
+/* Whitespace outside strings removed, one byte at a time */
+static size_t reference_minify(char *dst, const char *s, size_t len) {
+    size_t n = 0;
+    bool in_string = false;
+    for (size_t i = 0; i < len; i++) {
+        char c = s[i];
+        if (in_string) {
+            dst[n++] = c;
+            if (c == '\\' && i + 1 < len) dst[n++] = s[++i];
+            else if (c == '\"') in_string = false;
+        } else if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+            dst[n++] = c;
+            if (c == '\"') in_string = true;
+        }
+    }
+    return n;
+}
+
+/* Both minifiers agree with ajson_validate and, on valid input, with
+   reference_minify */
+static bool minify_agrees(const char *s, size_t len) {
+    char *out = (char *)malloc(len + 1);
+    char *in_place = (char *)malloc(len + 1);
+    char *expect = (char *)malloc(len + 1);
+    memcpy(in_place, s, len);
+    size_t voff = 0, moff = 0, ioff = 0, mlen = 0, ilen = 0;
+    bool v = ajson_validate(s, len, &voff);
+    bool m = ajson_minify(out, s, len, &mlen, &moff);
+    bool i = ajson_minify_in_place(in_place, len, &ilen, &ioff);
+    bool ok = v == m && v == i;
+    if (ok && v) {
+        size_t n = reference_minify(expect, s, len);
+        ok = mlen == n && ilen == n && !memcmp(out, expect, n) && !memcmp(in_place, expect, n);
+    } else if (ok) {
+        ok = moff == voff && ioff == voff;
+    }
+    free(out);
+    free(in_place);
+    free(expect);
+    return ok;
+}
+
+#define MIN_OK(s) minify_agrees((s), sizeof(s) - 1)
+
+MACRO_TEST(minify_documents) {
+    static const char pretty[] =
+        "{\n  \"a b\" : [ 1 , -2.5e+3 ,\ttrue ] ,\r\n  \"s\": \" \\\" x \\\\\" ,\n"
+        "  \"o\": { }, \"e\": [ ], \"u\": \"caf\xC3\xA9 \\u00e9\" }\n";
+    char out[sizeof(pretty)];
+    size_t n = 0;
+    MACRO_ASSERT_TRUE(ajson_minify(out, pretty, sizeof(pretty) - 1, &n, NULL));
+    static const char compact[] =
+        "{\"a b\":[1,-2.5e+3,true],\"s\":\" \\\" x \\\\\",\"o\":{},\"e\":[],"
+        "\"u\":\"caf\xC3\xA9 \\u00e9\"}";
+    MACRO_ASSERT_EQ_SZ(n, sizeof(compact) - 1);
+    MACRO_ASSERT_TRUE(!memcmp(out, compact, n));
+
+    char buf[sizeof(pretty)];
+    memcpy(buf, pretty, sizeof(pretty));
+    MACRO_ASSERT_TRUE(ajson_minify_in_place(buf, sizeof(pretty) - 1, &n, NULL));
+    MACRO_ASSERT_EQ_SZ(n, sizeof(compact) - 1);
+    MACRO_ASSERT_TRUE(!memcmp(buf, compact, n));
+
+    /* Already minified input is left as it is */
+    memcpy(buf, compact, sizeof(compact));
+    MACRO_ASSERT_TRUE(ajson_minify_in_place(buf, sizeof(compact) - 1, &n, NULL));
+    MACRO_ASSERT_EQ_SZ(n, sizeof(compact) - 1);
+    MACRO_ASSERT_STREQ(buf, compact);
+
+    MACRO_ASSERT_TRUE(MIN_OK("  12  "));
+    MACRO_ASSERT_TRUE(MIN_OK("\"\""));
+    MACRO_ASSERT_TRUE(MIN_OK("[ \"\\\\\" , \"\\\"\" ]"));
+    MACRO_ASSERT_TRUE(MIN_OK("[1, 2"));
+    MACRO_ASSERT_TRUE(MIN_OK("[1 2]"));
+    MACRO_ASSERT_TRUE(MIN_OK("{} {}"));
+    MACRO_ASSERT_TRUE(MIN_OK("[ \"a\\x\" ]"));
+    MACRO_ASSERT_TRUE(MIN_OK("[ \"ab\xC0\xAF\" ]"));
+    MACRO_ASSERT_TRUE(MIN_OK("   "));
+    MACRO_ASSERT_TRUE(MIN_OK(""));
+}
+
+/* A pretty-printed document longer than the chunks UTF-8 is checked in,
+   with bytes replaced in turn near the start, the chunk boundaries and
+   the end */
+MACRO_TEST(minify_long_documents) {
+    aml_buffer_t *bh = aml_buffer_init(1 << 16);
+    aml_buffer_appends(bh, "[\n");
+    for (int i = 0; i < 1200; i++)
+        aml_buffer_appends(bh, i % 3 ? "  {\"k\": \"\xE6\x97\xA5 \xE6\x97\xA5\", \"n\": [1, 2.5]},\n"
+                                     : "  \"text with \\\"quotes\\\" and  spaces\",\n");
+    aml_buffer_appends(bh, "  null\n]\n");
+    char *s = aml_buffer_data(bh);
+    size_t len = aml_buffer_length(bh);
+    MACRO_ASSERT_TRUE(minify_agrees(s, len));
+
+    static const char swaps[] = { ' ', '\"', '\\', ',', '\x01', '\xE6', '\xFF', 'x' };
+    size_t at[] = { 1, 16 * 1024 - 12, 32 * 1024 - 12, len - 30 };
+    for (size_t a = 0; a < sizeof(at) / sizeof(at[0]); a++) {
+        for (size_t i = at[a]; i < at[a] + 24; i++) {
+            for (size_t k = 0; k < sizeof(swaps); k++) {
+                char keep = s[i];
+                s[i] = swaps[k];
+                if (!minify_agrees(s, len)) {
+                    fprintf(stderr, "byte %zu -> 0x%02x\n", i, (unsigned char)swaps[k]);
+                    MACRO_ASSERT_TRUE(false);
+                }
+                s[i] = keep;
+            }
+        }
+    }
+    aml_buffer_destroy(bh);
+}
+
+/* ---------- Register ---------- */
+
+int main(void) {
+    macro_test_case tests[8];
+    size_t test_count = 0;
+
+    MACRO_ADD(tests, validate_documents);
+    MACRO_ADD(tests, validate_long_strings);
+    MACRO_ADD(tests, validate_matches_parser);
+    MACRO_ADD(tests, validate_depth);
+    MACRO_ADD(tests, validate_read_only);
+    MACRO_ADD(tests, minify_documents);
+    MACRO_ADD(tests, minify_long_documents);
+
+    macro_run_all("ajson_validate", tests, test_count);
+    return 0;
+}
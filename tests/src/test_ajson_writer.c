@@ -0,0 +1,214 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "a-json-sax-library/ajson_writer.h"
+#include "a-memory-library/aml_buffer.h"
+
+#include "the-macro-library/macro_test.h"
+
+/* Collects callback output so tests can inspect block boundaries */
+typedef struct {
+    aml_buffer_t *out;
+    int calls;
+    size_t max_block;
+    int fail_after;
+} sink_ctx_t;
+
+static int sink_flush(void *arg, const char *data, size_t len) {
+    sink_ctx_t *s = (sink_ctx_t *)arg;
+    s->calls++;
+    if (len > s->max_block) s->max_block = len;
+    if (s->fail_after && s->calls > s->fail_after) return 5;
+    aml_buffer_append(s->out, data, len);
+    return 0;
+}
+
+/* ---------- Structure and Comma State ---------- */
+
+MACRO_TEST(writer_nested_structure) {
+    aml_buffer_t *bh = aml_buffer_init(64);
+    ajson_writer_t *w = ajson_writer_init(bh);
+
+    ajson_writer_start_object(w);
+    ajson_writer_key(w, "a", 1);
+    ajson_writer_int(w, 1);
+    ajson_writer_key(w, "b", 1);
+    ajson_writer_start_array(w);
+    ajson_writer_bool(w, true);
+    ajson_writer_null(w);
+    ajson_writer_start_object(w);
+    ajson_writer_end_object(w);
+    ajson_writer_start_array(w);
+    ajson_writer_end_array(w);
+    ajson_writer_string(w, "x", 1);
+    ajson_writer_end_array(w);
+    ajson_writer_key(w, "c", 1);
+    ajson_writer_bool(w, false);
+    ajson_writer_end_object(w);
+
+    MACRO_ASSERT_EQ_INT(ajson_writer_destroy(w), 0);
+    MACRO_ASSERT_STREQ(aml_buffer_data(bh),
+                       "{\"a\":1,\"b\":[true,null,{},[],\"x\"],\"c\":false}");
+
+    aml_buffer_destroy(bh);
+}
+
+MACRO_TEST(writer_appends_after_existing_content) {
+    aml_buffer_t *bh = aml_buffer_init(16);
+    aml_buffer_appends(bh, "prefix:");
+
+    ajson_writer_t *w = ajson_writer_init(bh);
+    ajson_writer_start_array(w);
+    ajson_writer_int(w, 7);
+    ajson_writer_end_array(w);
+    ajson_writer_flush(w);
+
+    MACRO_ASSERT_STREQ(aml_buffer_data(bh), "prefix:[7]");
+    MACRO_ASSERT_EQ_SZ(aml_buffer_length(bh), strlen("prefix:[7]"));
+
+    ajson_writer_destroy(w);
+    aml_buffer_destroy(bh);
+}
+
+/* ---------- Values ---------- */
+
+MACRO_TEST(writer_integers) {
+    aml_buffer_t *bh = aml_buffer_init(64);
+    ajson_writer_t *w = ajson_writer_init(bh);
+
+    ajson_writer_start_array(w);
+    ajson_writer_int(w, 0);
+    ajson_writer_int(w, -5);
+    ajson_writer_int(w, 1234567);
+    ajson_writer_int(w, INT64_MIN);
+    ajson_writer_uint(w, UINT64_MAX);
+    ajson_writer_end_array(w);
+    ajson_writer_destroy(w);
+
+    MACRO_ASSERT_STREQ(aml_buffer_data(bh),
+                       "[0,-5,1234567,-9223372036854775808,18446744073709551615]");
+    aml_buffer_destroy(bh);
+}
+
+MACRO_TEST(writer_doubles) {
+    aml_buffer_t *bh = aml_buffer_init(64);
+    ajson_writer_t *w = ajson_writer_init(bh);
+
+    ajson_writer_start_array(w);
+    ajson_writer_double(w, 0.1);
+    ajson_writer_double(w, -2.5);
+    ajson_writer_double(w, 1e300);
+    ajson_writer_double(w, 1.0 / 0.0);
+    ajson_writer_end_array(w);
+    ajson_writer_destroy(w);
+
+    MACRO_ASSERT_STREQ(aml_buffer_data(bh), "[0.1,-2.5,1e+300,null]");
+    aml_buffer_destroy(bh);
+}
+
+MACRO_TEST(writer_string_escapes) {
+    aml_buffer_t *bh = aml_buffer_init(64);
+    ajson_writer_t *w = ajson_writer_init(bh);
+
+    char raw[] = { 'a', '"', 'b', '\\', '/', '\n', '\t', 0x01, 'z' };
+    ajson_writer_start_object(w);
+    ajson_writer_key(w, "k\"", 2);
+    ajson_writer_string(w, raw, sizeof(raw));
+    ajson_writer_end_object(w);
+    ajson_writer_destroy(w);
+
+    MACRO_ASSERT_STREQ(aml_buffer_data(bh),
+                       "{\"k\\\"\":\"a\\\"b\\\\\\/\\n\\t\\u0001z\"}");
+    aml_buffer_destroy(bh);
+}
+
+MACRO_TEST(writer_raw_splice) {
+    aml_buffer_t *bh = aml_buffer_init(64);
+    ajson_writer_t *w = ajson_writer_init(bh);
+
+    ajson_writer_start_array(w);
+    ajson_writer_int(w, 1);
+    ajson_writer_raw(w, "{\"pre\":\"encoded\"}", 17);
+    ajson_writer_int(w, 2);
+    ajson_writer_end_array(w);
+    ajson_writer_destroy(w);
+
+    MACRO_ASSERT_STREQ(aml_buffer_data(bh), "[1,{\"pre\":\"encoded\"},2]");
+    aml_buffer_destroy(bh);
+}
+
+/* ---------- Callback Sink ---------- */
+
+MACRO_TEST(writer_callback_blocks) {
+    sink_ctx_t s = { aml_buffer_init(64), 0, 0, 0 };
+    ajson_writer_t *w = ajson_writer_init_cb(sink_flush, &s, 64);
+
+    /* Long string with sparse escapes crosses many block boundaries */
+    size_t n = 10000;
+    char *big = (char *)malloc(n);
+    for (size_t i = 0; i < n; i++) big[i] = (i % 97 == 0) ? '\n' : (char)('a' + i % 26);
+
+    ajson_writer_start_array(w);
+    for (int i = 0; i < 100; i++) ajson_writer_int(w, i);
+    ajson_writer_string(w, big, n);
+    ajson_writer_end_array(w);
+    MACRO_ASSERT_EQ_INT(ajson_writer_destroy(w), 0);
+
+    MACRO_ASSERT_TRUE(s.calls > 1);
+    aml_buffer_appendc(s.out, 0);
+
+    /* Compare against a single-buffer rendering */
+    aml_buffer_t *ref = aml_buffer_init(64);
+    w = ajson_writer_init(ref);
+    ajson_writer_start_array(w);
+    for (int i = 0; i < 100; i++) ajson_writer_int(w, i);
+    ajson_writer_string(w, big, n);
+    ajson_writer_end_array(w);
+    ajson_writer_destroy(w);
+
+    MACRO_ASSERT_STREQ(aml_buffer_data(s.out), aml_buffer_data(ref));
+
+    free(big);
+    aml_buffer_destroy(ref);
+    aml_buffer_destroy(s.out);
+}
+
+MACRO_TEST(writer_callback_error_is_sticky) {
+    sink_ctx_t s = { aml_buffer_init(64), 0, 0, 1 };
+    ajson_writer_t *w = ajson_writer_init_cb(sink_flush, &s, 64);
+
+    ajson_writer_start_array(w);
+    for (int i = 0; i < 200; i++) ajson_writer_int(w, i);
+    ajson_writer_end_array(w);
+
+    MACRO_ASSERT_EQ_INT(ajson_writer_error(w), 5);
+    int calls = s.calls;
+    MACRO_ASSERT_EQ_INT(ajson_writer_destroy(w), 5);
+    MACRO_ASSERT_EQ_INT(s.calls, calls); /* No flushes after the failure */
+
+    aml_buffer_destroy(s.out);
+}
+
+/* -------- register & run -------- */
+
+int main(void) {
+    macro_test_case tests[64];
+    size_t test_count = 0;
+
+    MACRO_ADD(tests, writer_nested_structure);
+    MACRO_ADD(tests, writer_appends_after_existing_content);
+    MACRO_ADD(tests, writer_integers);
+    MACRO_ADD(tests, writer_doubles);
+    MACRO_ADD(tests, writer_string_escapes);
+    MACRO_ADD(tests, writer_raw_splice);
+    MACRO_ADD(tests, writer_callback_blocks);
+    MACRO_ADD(tests, writer_callback_error_is_sticky);
+
+    macro_run_all("ajson_writer", tests, test_count);
+    return 0;
+}
@@ -0,0 +1,665 @@
+// SPDX-FileCopyrightText: 2025-2026 Andy Curtis <contactandyc@gmail.com>
+// SPDX-License-Identifier: Apache-2.0
+
+/* ajson_gen: generate C structs and dedicated parsers from a schema.
+ *
+ *   ajson_gen [-o <out>] <schema.json>
+ *
+ * writes <out>.h and <out>.c (by default <out> is the schema path without
+ * its extension).  The schema is an object of types, each an object of
+ * fields mapping a JSON key to a type:
+ *
+ *   {
+ *     "point": { "x": "double", "y": "double" },
+ *     "order": { "id": "int64", "symbol": "string", "qty": "int",
+ *                "open": "bool", "at": "point", "fills": "point[]" }
+ *   }
+ *
+ * Field types are int, int64, uint64, double, bool, string, another type
+ * of the schema, or any of those followed by "[]" for an array (stored as
+ * a pointer plus a size_t num_<member>).  Keys that are not C identifiers
+ * get a member name with the other characters replaced by '_', C and C++
+ * keywords get a trailing '_', and a name already taken in the struct
+ * gets the first free suffix of _2, _3, ...
+ *
+ * For every type 'T' the header declares T_t and
+ *
+ *   int T_parse(T_t *out, char *p, char *ep, aml_pool_t *pool,
+ *               char **error_at, unsigned flags);
+ *
+ * which behaves like ajson_bind_parse, except that only whitespace may
+ * follow the object.  The generated parser switches on
+ * the key length and then on a distinguishing byte, and converts numbers
+ * inline, so there is no callback dispatch and no key table at run time.
+ */
+
+#include "a-json-sax-library/ajson_sax.h"
+#include "a-memory-library/aml_alloc.h"
+#include "a-memory-library/aml_buffer.h"
+#include "a-memory-library/aml_pool.h"
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+    GEN_INT,
+    GEN_INT64,
+    GEN_UINT64,
+    GEN_DOUBLE,
+    GEN_BOOL,
+    GEN_STRING,
+    GEN_STRUCT,
+    GEN_UNRESOLVED           /* Not yet matched against the schema */
+} gen_kind_t;
+
+typedef struct {
+    char *key;               /* JSON key (decoded) */
+    size_t key_len;
+    char *member;            /* C member name */
+    char *spec;              /* Type as written in the schema */
+    gen_kind_t kind;
+    int type;                /* GEN_STRUCT: index into the schema's types */
+    bool array;
+} gen_field_t;
+
+typedef struct {
+    char *name;
+    gen_field_t *fields;
+    size_t num_fields;
+    int state;               /* Emission: 0 new, 1 in progress, 2 done */
+} gen_type_t;
+
+typedef struct {
+    aml_pool_t *pool;
+    gen_type_t *types;
+    size_t num_types;
+    int depth;
+    const char *error;
+} gen_schema_t;
+
+static void *gen_grow(aml_pool_t *pool, void *items, size_t count, size_t size) {
+    /* Power-of-two capacities: grow when count hits one */
+    if (count && (count & (count - 1))) return items;
+    char *r = (char *)aml_pool_zalloc(pool, (count ? count * 2 : 1) * size);
+    if (count) memcpy(r, items, count * size);
+    return r;
+}
+
+/* ---------- Schema Reading ---------- */
+
+static int schema_error(gen_schema_t *s, const char *msg) {
+    s->error = msg;
+    return -1;
+}
+
+static int schema_start_object(void *ctx, ajson_sax_t *sax) {
+    (void)sax;
+    gen_schema_t *s = (gen_schema_t *)ctx;
+    if (++s->depth > 2) return schema_error(s, "types and fields must be objects of strings");
+    return 0;
+}
+
+static int schema_end_object(void *ctx, ajson_sax_t *sax) {
+    (void)sax;
+    ((gen_schema_t *)ctx)->depth--;
+    return 0;
+}
+
+static int schema_key(void *ctx, ajson_sax_t *sax, const char *key, size_t len) {
+    (void)sax;
+    gen_schema_t *s = (gen_schema_t *)ctx;
+    if (s->depth == 1) {
+        s->types = (gen_type_t *)gen_grow(s->pool, s->types, s->num_types, sizeof(gen_type_t));
+        gen_type_t *t = s->types + s->num_types++;
+        t->name = aml_pool_strndup(s->pool, key, len);
+        return 0;
+    }
+    gen_type_t *t = s->types + s->num_types - 1;
+    t->fields = (gen_field_t *)gen_grow(s->pool, t->fields, t->num_fields, sizeof(gen_field_t));
+    gen_field_t *f = t->fields + t->num_fields++;
+    f->key = aml_pool_strndup(s->pool, key, len);
+    f->key_len = len;
+    return 0;
+}
+
+static int schema_string(void *ctx, ajson_sax_t *sax, const char *v, size_t len) {
+    (void)sax;
+    gen_schema_t *s = (gen_schema_t *)ctx;
+    if (s->depth != 2) return schema_error(s, "a type must be an object of fields");
+    gen_type_t *t = s->types + s->num_types - 1;
+    t->fields[t->num_fields - 1].spec = aml_pool_strndup(s->pool, v, len);
+    return 0;
+}
+
+static int schema_other(void *ctx, ajson_sax_t *sax) {
+    (void)sax;
+    return schema_error((gen_schema_t *)ctx, "field types must be strings");
+}
+
+static int schema_bool(void *ctx, ajson_sax_t *sax, bool v) {
+    (void)v;
+    return schema_other(ctx, sax);
+}
+
+static int schema_number(void *ctx, ajson_sax_t *sax, const char *v, size_t len) {
+    (void)v;
+    (void)len;
+    return schema_other(ctx, sax);
+}
+
+static const ajson_sax_cb_t schema_handlers = {
+    .on_null = schema_other,
+    .on_bool = schema_bool,
+    .on_number = schema_number,
+    .on_string = schema_string,
+    .on_key = schema_key,
+    .on_start_object = schema_start_object,
+    .on_end_object = schema_end_object,
+    .on_start_array = schema_other,
+    .on_end_array = schema_other
+};
+
+static bool is_identifier(const char *s) {
+    if (!*s || isdigit((unsigned char)*s)) return false;
+    for (; *s; s++)
+        if (!isalnum((unsigned char)*s) && *s != '_') return false;
+    return true;
+}
+
+/* C23 and C++ keywords, which cannot be member names */
+static const char *keywords[] = {
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool",
+    "break", "case", "catch", "char", "char8_t", "char16_t", "char32_t", "class",
+    "co_await", "co_return", "co_yield", "compl", "concept", "const", "const_cast",
+    "consteval", "constexpr", "constinit", "continue", "decltype", "default",
+    "delete", "do", "double", "dynamic_cast", "else", "enum", "explicit", "export",
+    "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int",
+    "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq", "nullptr",
+    "operator", "or", "or_eq", "private", "protected", "public", "register",
+    "reinterpret_cast", "requires", "restrict", "return", "short", "signed",
+    "sizeof", "static", "static_assert", "static_cast", "struct", "switch",
+    "template", "this", "thread_local", "throw", "true", "try", "typedef",
+    "typeid", "typename", "typeof", "typeof_unqual", "union", "unsigned", "using",
+    "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq"
+};
+
+static bool is_keyword(const char *s) {
+    for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++)
+        if (!strcmp(s, keywords[i])) return true;
+    return false;
+}
+
+/* Whether 'name' is already a member among the first 'n' fields of 't',
+   counting the num_<member> of arrays */
+static bool member_taken(const gen_type_t *t, size_t n, const char *name) {
+    for (size_t i = 0; i < n; i++) {
+        const gen_field_t *f = t->fields + i;
+        if (!strcmp(f->member, name)) return true;
+        if (f->array && !strncmp(name, "num_", 4) && !strcmp(f->member, name + 4)) return true;
+    }
+    return false;
+}
+
+/* Whether num_<name> is already a member among the first 'n' fields */
+static bool count_taken(const gen_type_t *t, size_t n, const char *name) {
+    for (size_t i = 0; i < n; i++)
+        if (!strncmp(t->fields[i].member, "num_", 4) && !strcmp(t->fields[i].member + 4, name))
+            return true;
+    return member_taken(t, n, name);
+}
+
+/* The member for field 'j' of 't', unique among the fields before it
+   (f->array must be set) */
+static char *member_name(aml_pool_t *pool, const gen_type_t *t, size_t j) {
+    const gen_field_t *f = t->fields + j;
+    size_t len = f->key_len;
+    char *m = (char *)aml_pool_alloc(pool, len + 16);
+    char *w = m;
+    if (!len || isdigit((unsigned char)f->key[0])) *w++ = '_';
+    for (size_t i = 0; i < len; i++)
+        *w++ = isalnum((unsigned char)f->key[i]) ? f->key[i] : '_';
+    *w = 0;
+    if (is_keyword(m)) {
+        *w++ = '_';
+        *w = 0;
+    }
+    for (int suffix = 2; f->array ? count_taken(t, j, m) : member_taken(t, j, m); suffix++)
+        snprintf(w, 16, "_%d", suffix);
+    return m;
+}
+
+static const char *resolve_types(gen_schema_t *s) {
+    static const char *scalars[] = { "int", "int64", "uint64", "double", "bool", "string" };
+    static char msg[256];
+
+    for (size_t i = 0; i < s->num_types; i++) {
+        gen_type_t *t = s->types + i;
+        if (!is_identifier(t->name)) {
+            snprintf(msg, sizeof(msg), "'%s' is not a valid type name", t->name);
+            return msg;
+        }
+        for (size_t j = 0; j < i; j++)
+            if (!strcmp(s->types[j].name, t->name)) {
+                snprintf(msg, sizeof(msg), "type '%s' is defined twice", t->name);
+                return msg;
+            }
+        for (size_t j = 0; j < t->num_fields; j++) {
+            gen_field_t *f = t->fields + j;
+            for (size_t k = 0; k < j; k++)
+                if (f->key_len == t->fields[k].key_len && !memcmp(f->key, t->fields[k].key, f->key_len)) {
+                    snprintf(msg, sizeof(msg), "%s: key '%s' appears twice", t->name, f->key);
+                    return msg;
+                }
+            size_t n = strlen(f->spec);
+            if (n > 2 && !strcmp(f->spec + n - 2, "[]")) {
+                f->array = true;
+                f->spec[n - 2] = 0;
+            }
+            f->member = member_name(s->pool, t, j);
+            f->kind = GEN_UNRESOLVED;
+            f->type = -1;
+            for (size_t k = 0; k < sizeof(scalars) / sizeof(scalars[0]); k++)
+                if (!strcmp(f->spec, scalars[k])) f->kind = (gen_kind_t)k;
+            if (f->kind != GEN_UNRESOLVED) continue;
+
+            for (size_t k = 0; k < s->num_types; k++)
+                if (!strcmp(f->spec, s->types[k].name)) f->type = (int)k;
+            if (f->type < 0) {
+                snprintf(msg, sizeof(msg), "%s.%s: unknown type '%s%s'", t->name, f->key,
+                         f->spec, f->array ? "[]" : "");
+                return msg;
+            }
+            f->kind = GEN_STRUCT;
+        }
+    }
+    return NULL;
+}
+
+/* ---------- Emitting ---------- */
+
+static const char *c_type(const gen_schema_t *s, const gen_field_t *f, char *buf, size_t n) {
+    switch (f->kind) {
+    case GEN_INT:    return "int";
+    case GEN_INT64:  return "int64_t";
+    case GEN_UINT64: return "uint64_t";
+    case GEN_DOUBLE: return "double";
+    case GEN_BOOL:   return "bool";
+    case GEN_STRING: return "char *";
+    case GEN_STRUCT:
+        snprintf(buf, n, "%s_t", s->types[f->type].name);
+        return buf;
+    case GEN_UNRESOLVED:
+        break;
+    }
+    return "";
+}
+
+/* Struct definitions, members held by value first */
+static const char *emit_struct(aml_buffer_t *o, gen_schema_t *s, size_t i) {
+    static char msg[256];
+    gen_type_t *t = s->types + i;
+    if (t->state == 2) return NULL;
+    if (t->state == 1) {
+        snprintf(msg, sizeof(msg), "type '%s' contains itself (use an array)", t->name);
+        return msg;
+    }
+    t->state = 1;
+    for (size_t j = 0; j < t->num_fields; j++) {
+        gen_field_t *f = t->fields + j;
+        if (f->kind == GEN_STRUCT && !f->array) {
+            const char *err = emit_struct(o, s, (size_t)f->type);
+            if (err) return err;
+        }
+    }
+    t->state = 2;
+
+    char buf[256];
+    aml_buffer_appendf(o, "struct %s_s {\n", t->name);
+    for (size_t j = 0; j < t->num_fields; j++) {
+        gen_field_t *f = t->fields + j;
+        const char *ct = c_type(s, f, buf, sizeof(buf));
+        const char *sep = ct[strlen(ct) - 1] == '*' ? "" : " ";
+        if (f->array) {
+            aml_buffer_appendf(o, "    %s%s*%s;\n", ct, sep, f->member);
+            aml_buffer_appendf(o, "    size_t num_%s;\n", f->member);
+        } else {
+            aml_buffer_appendf(o, "    %s%s%s;\n", ct, sep, f->member);
+        }
+    }
+    if (!t->num_fields) aml_buffer_appends(o, "    char unused;\n");
+    aml_buffer_appends(o, "};\n\n");
+    return NULL;
+}
+
+/* A C string literal for a key; octal escapes cannot run into the next byte */
+static void emit_literal(aml_buffer_t *o, const char *s, size_t len) {
+    aml_buffer_appendc(o, '\"');
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c >= 0x20 && c < 0x7f && c != '\"' && c != '\\' && c != '?')
+            aml_buffer_appendc(o, (char)c);
+        else
+            aml_buffer_appendf(o, "\\%03o", c);
+    }
+    aml_buffer_appendc(o, '\"');
+}
+
+static void emit_char(aml_buffer_t *o, char ch) {
+    unsigned char c = (unsigned char)ch;
+    if (isalnum(c) || c == '_' || c == '-' || c == ' ' || c == '.')
+        aml_buffer_appendf(o, "'%c'", c);
+    else
+        aml_buffer_appendf(o, "'\\%03o'", c);
+}
+
+/* The call parsing one value of 'f' into 'dst' */
+static void emit_value(aml_buffer_t *o, const gen_schema_t *s, const gen_field_t *f,
+                       const char *dst) {
+    static const char *helpers[] = { "int", "int64", "uint64", "double", "bool", "string" };
+    if (f->kind == GEN_STRUCT)
+        aml_buffer_appendf(o, "%s_parse_at(%s, p, g)", s->types[f->type].name, dst);
+    else
+        aml_buffer_appendf(o, "ajson_gen_%s(g, p, %s)", helpers[f->kind], dst);
+}
+
+static void emit_array(aml_buffer_t *o, const gen_schema_t *s, const gen_type_t *t,
+                       const gen_field_t *f) {
+    char buf[256];
+    const char *ct = c_type(s, f, buf, sizeof(buf));
+    const char *sep = ct[strlen(ct) - 1] == '*' ? "" : " ";
+
+    aml_buffer_appendf(o, "static char *%s_%s_at(%s_t *out, char *p, ajson_gen_t *g) {\n",
+                       t->name, f->member, t->name);
+    aml_buffer_appends(o,
+        "    ajson_gen_vec_t v = { NULL, 0, 0 };\n"
+        "    if (*p != '[') {\n"
+        "        if (ajson_gen_is_null(p)) return p + 4;\n"
+        "        return ajson_gen_mismatch(g, p);\n"
+        "    }\n"
+        "    p = ajson_gen_ws(p + 1);\n"
+        "    if (*p != ']') {\n"
+        "        for (;;) {\n");
+    aml_buffer_appendf(o, "            %s%s*e = (%s%s*)ajson_gen_push(g, &v, sizeof(%s));\n",
+                       ct, sep, ct, sep, ct);
+    aml_buffer_appends(o, "            if (!(p = ");
+    emit_value(o, s, f, "e");
+    aml_buffer_appends(o, ")) return NULL;\n"
+        "            p = ajson_gen_ws(p);\n"
+        "            if (*p == ']') break;\n"
+        "            if (*p != ',') return ajson_gen_fail(g, p);\n"
+        "            p = ajson_gen_ws(p + 1);\n"
+        "        }\n"
+        "    }\n");
+    aml_buffer_appendf(o, "    out->%s = (%s%s*)v.items;\n", f->member, ct, sep);
+    aml_buffer_appendf(o, "    out->num_%s = v.count;\n", f->member);
+    aml_buffer_appends(o, "    return p + 1;\n}\n\n");
+}
+
+static void emit_match(aml_buffer_t *o, const gen_schema_t *s, const gen_type_t *t,
+                       const gen_field_t *f, const char *indent) {
+    aml_buffer_appendf(o, "%sif (!memcmp(k, ", indent);
+    emit_literal(o, f->key, f->key_len);
+    aml_buffer_appendf(o, ", %zu)) {\n%s    p = ", f->key_len, indent);
+    if (f->array) {
+        aml_buffer_appendf(o, "%s_%s_at(out, p, g)", t->name, f->member);
+    } else {
+        char dst[300];
+        snprintf(dst, sizeof(dst), "&out->%s", f->member);
+        emit_value(o, s, f, dst);
+    }
+    aml_buffer_appendf(o, ";\n%s    goto next;\n%s}\n", indent, indent);
+}
+
+/* Keys of one length: switch on the byte that tells most of them apart */
+static void emit_length_case(aml_buffer_t *o, const gen_schema_t *s, const gen_type_t *t,
+                             const gen_field_t **group, size_t n) {
+    size_t len = group[0]->key_len;
+    aml_buffer_appendf(o, "        case %zu:\n", len);
+    if (n == 1) {
+        emit_match(o, s, t, group[0], "            ");
+        aml_buffer_appends(o, "            break;\n");
+        return;
+    }
+
+    size_t best = 0, best_distinct = 0;
+    for (size_t pos = 0; pos < len; pos++) {
+        size_t distinct = 0;
+        for (size_t i = 0; i < n; i++) {
+            size_t j = 0;
+            while (j < i && group[j]->key[pos] != group[i]->key[pos]) j++;
+            if (j == i) distinct++;
+        }
+        if (distinct > best_distinct) {
+            best = pos;
+            best_distinct = distinct;
+        }
+    }
+
+    aml_buffer_appendf(o, "            switch (k[%zu]) {\n", best);
+    for (size_t i = 0; i < n; i++) {
+        size_t j = 0;
+        while (j < i && group[j]->key[best] != group[i]->key[best]) j++;
+        if (j < i) continue;   /* Byte already has its case */
+        aml_buffer_appends(o, "            case ");
+        emit_char(o, group[i]->key[best]);
+        aml_buffer_appends(o, ":\n");
+        for (j = i; j < n; j++)
+            if (group[j]->key[best] == group[i]->key[best])
+                emit_match(o, s, t, group[j], "                ");
+        aml_buffer_appends(o, "                break;\n");
+    }
+    aml_buffer_appends(o, "            }\n            break;\n");
+}
+
+static void emit_parser(aml_buffer_t *o, gen_schema_t *s, const gen_type_t *t) {
+    for (size_t j = 0; j < t->num_fields; j++)
+        if (t->fields[j].array) emit_array(o, s, t, t->fields + j);
+
+    aml_buffer_appendf(o, "static char *%s_parse_at(%s_t *out, char *p, ajson_gen_t *g) {\n",
+                       t->name, t->name);
+    aml_buffer_appends(o,
+        "    char *k;\n"
+        "    size_t klen;\n"
+        "    if (*p != '{') {\n"
+        "        if (ajson_gen_is_null(p)) return p + 4;\n"
+        "        return ajson_gen_mismatch(g, p);\n"
+        "    }\n"
+        "    p = ajson_gen_ws(p + 1);\n"
+        "    if (*p == '}') return p + 1;\n"
+        "    for (;;) {\n"
+        "        if (!(p = ajson_gen_key(g, p, &k, &klen))) return NULL;\n");
+
+    if (t->num_fields) {
+        const gen_field_t **group = (const gen_field_t **)aml_pool_alloc(
+            s->pool, t->num_fields * sizeof(gen_field_t *));
+        size_t prev = 0;
+        aml_buffer_appends(o, "        switch (klen) {\n");
+        for (;;) {
+            /* Next key length, ascending */
+            size_t len = (size_t)-1, n = 0;
+            for (size_t j = 0; j < t->num_fields; j++)
+                if (t->fields[j].key_len >= prev && t->fields[j].key_len < len)
+                    len = t->fields[j].key_len;
+            if (len == (size_t)-1) break;
+            for (size_t j = 0; j < t->num_fields; j++)
+                if (t->fields[j].key_len == len) group[n++] = t->fields + j;
+            emit_length_case(o, s, t, group, n);
+            prev = len + 1;
+        }
+        aml_buffer_appends(o, "        }\n");
+    } else {
+        aml_buffer_appends(o, "        (void)out;\n        (void)klen;\n");
+    }
+
+    aml_buffer_appends(o,
+        "        p = ajson_gen_skip(g, p);\n");
+    if (t->num_fields) aml_buffer_appends(o, "    next:\n");
+    aml_buffer_appends(o,
+        "        if (!p) return NULL;\n"
+        "        p = ajson_gen_ws(p);\n"
+        "        if (*p == '}') return p + 1;\n"
+        "        if (*p != ',') return ajson_gen_fail(g, p);\n"
+        "        p = ajson_gen_ws(p + 1);\n"
+        "    }\n"
+        "}\n\n");
+
+    aml_buffer_appendf(o,
+        "int %s_parse(%s_t *out, char *p, char *ep, aml_pool_t *pool,\n"
+        "        char **error_at, unsigned flags) {\n", t->name, t->name);
+    aml_buffer_appends(o,
+        "    ajson_gen_t g;\n"
+        "    ajson_gen_init(&g, ep, pool, flags);\n"
+        "    p = ajson_gen_ws(p);\n"
+        "    if (p >= ep) ajson_gen_fail(&g, p);\n"
+        "    else if (*p != '{') ajson_gen_mismatch(&g, p);\n");
+    aml_buffer_appendf(o,
+        "    else if ((p = %s_parse_at(out, p, &g)) && (p = ajson_gen_ws(p)) != ep)\n",
+        t->name);
+    aml_buffer_appends(o,
+        "        ajson_gen_fail(&g, p);\n"
+        "    if (g.rc && error_at) *error_at = g.error_at;\n"
+        "    return g.rc;\n"
+        "}\n\n");
+}
+
+static const char *base_name(const char *path) {
+    const char *s = strrchr(path, '/');
+    return s ? s + 1 : path;
+}
+
+static const char *generate(gen_schema_t *s, const char *schema_path, const char *out,
+                            aml_buffer_t *h, aml_buffer_t *c) {
+    const char *err = resolve_types(s);
+    if (err) return err;
+
+    /* Header */
+    char guard[256];
+    size_t n = 0;
+    for (const char *q = base_name(out); *q && n < sizeof(guard) - 3; q++)
+        guard[n++] = isalnum((unsigned char)*q) ? *q : '_';
+    guard[n] = 0;
+
+    aml_buffer_appendf(h, "/* Generated by ajson_gen from %s.  Do not edit. */\n\n",
+                       base_name(schema_path));
+    aml_buffer_appendf(h, "#ifndef _%s_H\n#define _%s_H\n\n", guard, guard);
+    aml_buffer_appends(h,
+        "#include \"a-memory-library/aml_pool.h\"\n\n"
+        "#include <stdbool.h>\n"
+        "#include <stddef.h>\n"
+        "#include <stdint.h>\n\n"
+        "#ifdef __cplusplus\n"
+        "extern \"C\" {\n"
+        "#endif\n\n");
+    for (size_t i = 0; i < s->num_types; i++)
+        aml_buffer_appendf(h, "typedef struct %s_s %s_t;\n", s->types[i].name, s->types[i].name);
+    aml_buffer_appendc(h, '\n');
+    for (size_t i = 0; i < s->num_types; i++)
+        if ((err = emit_struct(h, s, i))) return err;
+    aml_buffer_appends(h,
+        "/* Parse the object in [p, ep) into 'out' (see ajson_bind_parse: members\n"
+        "   absent or null are left alone, unknown keys are skipped, strings and\n"
+        "   arrays go in 'pool').  'flags' may be AJSON_SAX_DESTRUCTIVE.  Returns\n"
+        "   0, -1 on a syntax error or -2 on a type mismatch. */\n");
+    for (size_t i = 0; i < s->num_types; i++)
+        aml_buffer_appendf(h,
+            "int %s_parse(%s_t *out, char *p, char *ep, aml_pool_t *pool,\n"
+            "        char **error_at, unsigned flags);\n", s->types[i].name, s->types[i].name);
+    aml_buffer_appendf(h, "\n#ifdef __cplusplus\n}\n#endif\n\n#endif /* _%s_H */\n", guard);
+
+    /* Source */
+    aml_buffer_appendf(c, "/* Generated by ajson_gen from %s.  Do not edit. */\n\n",
+                       base_name(schema_path));
+    aml_buffer_appendf(c, "#include \"%s.h\"\n", base_name(out));
+    aml_buffer_appends(c, "#include \"a-json-sax-library/ajson_gen_rt.h\"\n\n");
+    for (size_t i = 0; i < s->num_types; i++)
+        aml_buffer_appendf(c, "static char *%s_parse_at(%s_t *out, char *p, ajson_gen_t *g);\n",
+                           s->types[i].name, s->types[i].name);
+    aml_buffer_appendc(c, '\n');
+    for (size_t i = 0; i < s->num_types; i++) emit_parser(c, s, s->types + i);
+    aml_buffer_shrink_by(c, 1);   /* One newline at the end */
+    return NULL;
+}
+
+/* ---------- Main ---------- */
+
+static bool write_file(const char *path, aml_buffer_t *bh) {
+    FILE *out = fopen(path, "wb");
+    if (!out) return false;
+    bool ok = fwrite(aml_buffer_data(bh), 1, aml_buffer_length(bh), out) == aml_buffer_length(bh);
+    return fclose(out) == 0 && ok;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: ajson_gen [-o <out>] <schema.json>\n"
+                    "  writes <out>.h and <out>.c (default: the schema path less its extension)\n");
+}
+
+int main(int argc, char **argv) {
+    const char *out = NULL, *schema_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc) out = argv[++i];
+        else if (argv[i][0] == '-') { usage(); return 2; }
+        else if (!schema_path) schema_path = argv[i];
+        else { usage(); return 2; }
+    }
+    if (!schema_path) { usage(); return 2; }
+
+    aml_buffer_t *in = aml_buffer_init(4096);
+    FILE *f = fopen(schema_path, "rb");
+    if (!f) {
+        fprintf(stderr, "ajson_gen: cannot open %s\n", schema_path);
+        return 1;
+    }
+    char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) aml_buffer_append(in, chunk, n);
+    fclose(f);
+    aml_buffer_appendc(in, 0);   /* The parser wants a NUL at 'ep' */
+
+    aml_pool_t *pool = aml_pool_init(4096);
+    char *base = aml_pool_strdup(pool, out ? out : schema_path);
+    if (!out) {
+        char *dot = strrchr(base, '.');
+        if (dot && dot > base_name(base)) *dot = 0;
+    }
+
+    gen_schema_t s;
+    memset(&s, 0, sizeof(s));
+    s.pool = pool;
+    char *p = aml_buffer_data(in), *error_at = NULL;
+    int rc = ajson_sax_parse_ex(p, p + aml_buffer_length(in) - 1, &schema_handlers, pool, &s,
+                                &error_at, AJSON_SAX_DECODE_STRINGS | AJSON_SAX_VALIDATE_UTF8);
+    if (!rc && !s.num_types) s.error = "the schema has no types";
+    if (rc || s.error) {
+        fprintf(stderr, "ajson_gen: %s: %s", schema_path, s.error ? s.error : "invalid JSON");
+        if (rc) fprintf(stderr, " at offset %zu", (size_t)(error_at - p));
+        fprintf(stderr, "\n");
+        return 1;
+    }
+
+    aml_buffer_t *h = aml_buffer_init(4096), *c = aml_buffer_init(16384);
+    const char *err = generate(&s, schema_path, base, h, c);
+    if (err) {
+        fprintf(stderr, "ajson_gen: %s: %s\n", schema_path, err);
+        return 1;
+    }
+
+    char *path = (char *)aml_pool_alloc(pool, strlen(base) + 3);
+    sprintf(path, "%s.h", base);
+    bool ok = write_file(path, h);
+    sprintf(path, "%s.c", base);
+    ok = ok && write_file(path, c);
+    if (!ok) {
+        fprintf(stderr, "ajson_gen: cannot write %s\n", path);
+        return 1;
+    }
+
+    aml_buffer_destroy(c);
+    aml_buffer_destroy(h);
+    aml_buffer_destroy(in);
+    aml_pool_destroy(pool);
+    return 0;
+}